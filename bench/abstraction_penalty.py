@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2018 Steven Watanabe
+#
+# Distributed under the Boost Software License Version 1.0. (See
+# accompanying file LICENSE_1_0.txt or copy at
+# http://www.boost.org/LICENSE_1_0.txt)
+
+"""Run-time abstraction penalty of quantity.
+
+Builds bench_abstraction.cpp once for each optimization level in
+--levels.  For every pair of kernels raw_<op>_<type> and
+unit_<op>_<type> (the same loop on raw values and on quantities),
+the script
+
+  - runs the benchmark and reports ns/op for both,
+  - reports whether each loop was vectorized,
+  - compares their assembly.  Labels are normalized; anything else
+    that differs is shown with --diff.
+
+A pair is flagged if the unit kernel has more instructions than the
+raw kernel, calls a function that the raw kernel does not, or is not
+vectorized while the raw kernel is.  Instructions are counted
+separately inside and outside of loops (found from backward branches).
+The script exits with status 1 if, at one of the --check-levels, a
+unit kernel does more work per element than the raw kernel, or with
+--strict, has any extra instructions at all.  -Og is only reported by
+default, since it does not inline the operators.  Timings of identical
+code can still differ somewhat with its alignment, so the assembly is
+the check, and the timings are for information.
+
+Vectorization is recognized from packed SSE/AVX instructions on x86
+and from vector registers on AArch64.
+
+Usage:
+  abstraction_penalty.py [--cxx g++] [--include DIR]... [--levels O2,O3,Og]
+                         [--check-levels O2,O3] [--flags FLAGS] [--no-run]
+                         [--diff] [--strict] [--output FILE]
+"""
+
+import argparse
+import difflib
+import json
+import os
+import re
+import shlex
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+SOURCE = os.path.join(HERE, "bench_abstraction.cpp")
+
+LABEL = re.compile(r"^([A-Za-z_.$][\w.$]*):")
+LOCAL_LABEL = re.compile(r"\.L\w+")
+FUNCTION_END = re.compile(r"^\s*(\.cfi_endproc|\.size\s|\.Lfunc_end)")
+PACKED = re.compile(r"^v?(add|sub|mul|div|max|min|sqrt|fn?m(add|sub)\d*|cvt\w*|mov[au]|movdq[au]\w*)p[sd]$|"
+                    r"^v?movdq[au]\d*$|^v?p(add|sub|mul|max|min|s[lr][la])\w*$")
+NEON = re.compile(r"\bv\d+\.(2d|4s|8h|16b)\b")
+
+def run(cmd, **kwargs):
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True, **kwargs)
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout)
+        raise RuntimeError("command failed: " + " ".join(cmd))
+    return result.stdout
+
+class Function:
+    """The instructions of a function, with local labels normalized,
+    and the number of them that are inside loops."""
+    def __init__(self, lines):
+        self.instructions = []
+        labels = {}
+        jumps = []
+        for kind, text in lines:
+            if kind == "label":
+                labels[text] = len(self.instructions)
+            else:
+                target = text.split()[-1]
+                if text.split()[0].startswith(("j", "b")) and target.startswith(".L"):
+                    jumps.append((target, len(self.instructions)))
+                self.instructions.append(LOCAL_LABEL.sub(".L", text))
+        # A backward branch closes a loop.
+        in_loop = [False] * len(self.instructions)
+        for target, index in jumps:
+            if target in labels and labels[target] <= index:
+                for i in range(labels[target], index + 1):
+                    in_loop[i] = True
+        self.loop_size = sum(in_loop)
+
+    def __len__(self):
+        return len(self.instructions)
+
+def parse_functions(asm):
+    """Maps the name of each function to a Function."""
+    functions = {}
+    current = None
+    for line in asm.splitlines():
+        line = line.split("#")[0].split("//")[0].rstrip()
+        m = LABEL.match(line.strip())
+        if m and not m.group(1).startswith(".") and not line[:1].isspace():
+            current = functions.setdefault(m.group(1), [])
+            continue
+        if current is None:
+            continue
+        if FUNCTION_END.match(line):
+            current = None
+            continue
+        text = line.strip()
+        if m:
+            current.append(("label", m.group(1)))
+        elif text and not text.startswith("."):
+            current.append(("instruction", " ".join(text.split())))
+    return {name: Function(lines) for name, lines in functions.items()}
+
+def is_vectorized(f):
+    for i in f.instructions:
+        mnemonic = i.split()[0]
+        if PACKED.match(mnemonic) or NEON.search(i):
+            return True
+    return False
+
+def calls(f):
+    return sorted(set(i.split()[-1] for i in f.instructions if i.split()[0] in ("call", "callq", "bl", "jmp") and
+                      not i.split()[-1].startswith(".L")))
+
+def compare(raw, unit, strict):
+    """Returns the ways in which unit is worse than raw, as a list of
+    (problem, is_error).  Only costs per element are errors, unless
+    strict is set."""
+    problems = []
+    if unit.loop_size > raw.loop_size:
+        problems.append(("+%d instructions per iteration" % (unit.loop_size - raw.loop_size), True))
+    setup = len(unit) - unit.loop_size - (len(raw) - raw.loop_size)
+    if setup > 0:
+        problems.append(("+%d instructions outside loops" % setup, strict))
+    extra_calls = [c for c in calls(unit) if c not in calls(raw)]
+    if extra_calls:
+        problems.append(("%d extra calls" % len(extra_calls), True))
+    if is_vectorized(raw) and not is_vectorized(unit):
+        problems.append(("not vectorized", True))
+    return problems
+
+def parse_timings(output):
+    timings = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 3:
+            timings.setdefault(fields[0], {})[int(fields[1])] = float(fields[2])
+    return timings
+
+def measure_level(args, level, workdir):
+    flags = [args.cxx, "-std=" + args.std, "-" + level] + shlex.split(args.flags) + \
+        ["-I" + d for d in args.include] + ["-I" + os.path.join(ROOT, "include")]
+    asm = run(flags + ["-S", SOURCE, "-o", "-"])
+    functions = parse_functions(asm)
+    timings = {}
+    if not args.no_run:
+        exe = os.path.join(workdir, "bench_abstraction_" + level)
+        run(flags + [SOURCE, "-o", exe])
+        timings = parse_timings(run([exe]))
+
+    results = {}
+    for name in sorted(functions):
+        if not name.startswith("raw_") or "unit_" + name[4:] not in functions:
+            continue
+        kernel = name[4:]
+        raw, unit = functions[name], functions["unit_" + kernel]
+        problems = compare(raw, unit, args.strict)
+        results[kernel] = {
+            "raw_instructions": len(raw),
+            "unit_instructions": len(unit),
+            "raw_loop_instructions": raw.loop_size,
+            "unit_loop_instructions": unit.loop_size,
+            "identical": raw.instructions == unit.instructions,
+            "raw_vectorized": is_vectorized(raw),
+            "unit_vectorized": is_vectorized(unit),
+            "problems": [p for p, _ in problems],
+            "errors": [p for p, error in problems if error],
+            "calls": [c for c in calls(unit) if c not in calls(raw)],
+            "raw_ns": timings.get("raw_" + kernel, {}),
+            "unit_ns": timings.get("unit_" + kernel, {}),
+            "diff": list(difflib.unified_diff(raw.instructions, unit.instructions,
+                                              "raw_" + kernel, "unit_" + kernel, lineterm="")),
+        }
+    return results
+
+def report(level, results, show_diff):
+    print("-%s" % level)
+    print("  %-24s %9s %10s %10s %7s  %-11s %s" % ("kernel", "n", "raw ns/op", "unit ns/op", "ratio", "vectorized", "assembly"))
+    for kernel, r in sorted(results.items()):
+        vectorized = "%s/%s" % ("yes" if r["raw_vectorized"] else "no", "yes" if r["unit_vectorized"] else "no")
+        if r["identical"]:
+            assembly = "identical"
+        elif r["problems"]:
+            assembly = "FLAGGED: " + "; ".join(r["problems"])
+        else:
+            assembly = "differs, %d vs %d instructions" % (r["unit_instructions"], r["raw_instructions"])
+        sizes = sorted(r["raw_ns"]) or [None]
+        for n in sizes:
+            raw_ns = r["raw_ns"].get(n)
+            unit_ns = r["unit_ns"].get(n)
+            ratio = "%7.2f" % (unit_ns / raw_ns) if raw_ns and unit_ns else "%7s" % "-"
+            print("  %-24s %9s %10s %10s %s  %-11s %s" % (
+                kernel, n if n is not None else "-",
+                "%.4f" % raw_ns if raw_ns is not None else "-",
+                "%.4f" % unit_ns if unit_ns is not None else "-",
+                ratio, vectorized, assembly))
+            kernel, vectorized, assembly = "", "", ""
+        if show_diff and not r["identical"]:
+            for c in r["calls"]:
+                print("      calls " + c)
+            for line in r["diff"]:
+                print("      " + line)
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--std", default="c++20")
+    parser.add_argument("--include", "-I", action="append", default=[])
+    parser.add_argument("--levels", default="O2,O3,Og")
+    parser.add_argument("--check-levels", default="O2,O3",
+                        help="levels at which a flagged kernel is an error")
+    parser.add_argument("--flags", default="", help="extra compiler flags, e.g. -march=native")
+    parser.add_argument("--no-run", action="store_true", help="only compare the assembly")
+    parser.add_argument("--diff", action="store_true", help="show the assembly of kernels that differ")
+    parser.add_argument("--strict", action="store_true",
+                        help="also fail on extra instructions outside of loops")
+    parser.add_argument("--output", help="write the results to this file")
+    args = parser.parse_args()
+
+    levels = [l for l in args.levels.split(",") if l]
+    check_levels = set(l for l in args.check_levels.split(",") if l)
+    all_results = {}
+    with tempfile.TemporaryDirectory() as workdir:
+        for level in levels:
+            all_results[level] = measure_level(args, level, workdir)
+            report(level, all_results[level], args.diff)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(all_results, f, indent=2, sort_keys=True)
+
+    failures = ["-%s %s: %s" % (level, kernel, "; ".join(r["errors"]))
+                for level in levels if level in check_levels
+                for kernel, r in sorted(all_results[level].items()) if r["errors"]]
+    for f in failures:
+        print("PENALTY " + f)
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
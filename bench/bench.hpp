@@ -0,0 +1,62 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_BENCH_BENCH_HPP_INCLUDED
+#define BOOST_UNITS2_BENCH_BENCH_HPP_INCLUDED
+
+// Minimal timing support shared by the run-time benchmarks.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace bench {
+
+// Prevents the compiler from discarding a computed value.
+template<class T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+inline void clobber_memory()
+{
+#if defined(__GNUC__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+// Runs f repeatedly and returns the best time per call in nanoseconds.
+template<class F>
+double time_ns(F f, int repeat = 10)
+{
+    using clock = std::chrono::steady_clock;
+    double best = 0;
+    for(int i = 0; i < repeat; ++i)
+    {
+        auto start = clock::now();
+        f();
+        clobber_memory();
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        best = (i == 0)? elapsed.count() : (std::min)(best, elapsed.count());
+    }
+    return best;
+}
+
+inline void report(const char* name, double ns, std::size_t items)
+{
+    std::printf("%-32s %10.3f ns/item %10.1f Mitems/s\n", name, ns / items, items / ns * 1e3);
+}
+
+}
+
+#endif
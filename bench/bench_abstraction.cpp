@@ -0,0 +1,132 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// The abstraction penalty of quantity: each kernel is written once on
+// quantities and once on the raw values, and both are timed.  The
+// kernels have C linkage, so that abstraction_penalty.py can find them
+// in the assembly and compare their instructions.  Every unit_* kernel
+// should compile to the same code as the raw_* kernel with the same
+// suffix.
+//
+// Output lines are "<kernel> <n> <ns/op>", one per kernel and size.
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ratio>
+#include <vector>
+#include "bench.hpp"
+
+using namespace boost::units2;
+
+inline constexpr auto millimeter = std::milli() * si::meter;
+inline constexpr auto square_meter = si::meter * si::meter;
+inline constexpr auto meter_per_second = si::meter / si::second;
+
+template<class T> using meters = quantity<si::meter, T>;
+template<class T> using millimeters = quantity<millimeter, T>;
+template<class T> using seconds = quantity<si::second, T>;
+template<class T> using square_meters = quantity<square_meter, T>;
+template<class T> using meters_per_second = quantity<meter_per_second, T>;
+
+#define BOOST_UNITS2_BENCH_KERNEL(name, In1, In2, Out, expr)    \
+extern "C" __attribute__((noinline))                            \
+void name(const In1* a, const In2* b, Out* out, std::size_t n)  \
+{                                                               \
+    (void)b;                                                    \
+    for(std::size_t i = 0; i < n; ++i) out[i] = expr;           \
+}
+
+// The raw kernel and the unit kernel for each operation on T.
+#define BOOST_UNITS2_BENCH_KERNELS(T, suffix)                                                               \
+BOOST_UNITS2_BENCH_KERNEL(raw_mul_##suffix, T, T, T, a[i] * b[i])                                           \
+BOOST_UNITS2_BENCH_KERNEL(unit_mul_##suffix, meters<T>, meters<T>, square_meters<T>, a[i] * b[i])           \
+BOOST_UNITS2_BENCH_KERNEL(raw_div_##suffix, T, T, T, a[i] / b[i])                                           \
+BOOST_UNITS2_BENCH_KERNEL(unit_div_##suffix, meters<T>, seconds<T>, meters_per_second<T>, a[i] / b[i])      \
+BOOST_UNITS2_BENCH_KERNEL(raw_add_##suffix, T, T, T, a[i] + b[i])                                           \
+BOOST_UNITS2_BENCH_KERNEL(unit_add_##suffix, meters<T>, meters<T>, meters<T>, a[i] + b[i])                  \
+BOOST_UNITS2_BENCH_KERNEL(raw_scale_##suffix, T, T, T, a[i] * T(3))                                         \
+BOOST_UNITS2_BENCH_KERNEL(unit_scale_##suffix, meters<T>, meters<T>, meters<T>, a[i] * T(3))                \
+BOOST_UNITS2_BENCH_KERNEL(raw_from_value_##suffix, T, T, T, a[i])                                           \
+BOOST_UNITS2_BENCH_KERNEL(unit_from_value_##suffix, T, T, meters<T>, meters<T>::from_value(a[i]))           \
+BOOST_UNITS2_BENCH_KERNEL(raw_detail_from_value_##suffix, T, T, T, a[i] + b[i])                             \
+BOOST_UNITS2_BENCH_KERNEL(unit_detail_from_value_##suffix, T, T, meters<T>, (detail::from_value{ a[i] + b[i] }))
+
+// mm -> m, which is a multiplication for floating point
+// and an exact division for integers.
+#define BOOST_UNITS2_BENCH_CONVERT(T, suffix, expr)                                         \
+BOOST_UNITS2_BENCH_KERNEL(raw_convert_##suffix, T, T, T, expr)                              \
+BOOST_UNITS2_BENCH_KERNEL(unit_convert_##suffix, millimeters<T>, T, meters<T>, meters<T>(a[i]))
+
+BOOST_UNITS2_BENCH_KERNELS(double, double)
+BOOST_UNITS2_BENCH_KERNELS(float, float)
+BOOST_UNITS2_BENCH_KERNELS(std::int64_t, int64)
+BOOST_UNITS2_BENCH_CONVERT(double, double, a[i] * 0.001)
+BOOST_UNITS2_BENCH_CONVERT(float, float, a[i] * 0.001f)
+BOOST_UNITS2_BENCH_CONVERT(std::int64_t, int64, a[i] / 1000)
+
+// Times a kernel on the values in a and b.  The kernels view the
+// buffers as quantities, as as_quantities does, so that the raw and
+// unit kernels see exactly the same addresses.
+template<class T, class In1, class In2, class Out>
+void run(const char* name, void (*kernel)(const In1*, const In2*, Out*, std::size_t),
+    const std::vector<T>& a, const std::vector<T>& b, std::vector<T>& out)
+{
+    static_assert(sizeof(In1) == sizeof(T) && sizeof(In2) == sizeof(T) && sizeof(Out) == sizeof(T));
+    const In1* pa = reinterpret_cast<const In1*>(a.data());
+    const In2* pb = reinterpret_cast<const In2*>(b.data());
+    Out* pout = reinterpret_cast<Out*>(out.data());
+    const std::size_t n = a.size();
+    kernel(pa, pb, pout, n);
+    // Small sizes are noisy, so they are repeated more often.
+    const int repeat = static_cast<int>(std::clamp<std::size_t>((std::size_t(1) << 24) / n, 10, 1000));
+    double ns = bench::time_ns([&] { kernel(pa, pb, pout, n); }, repeat);
+    bench::do_not_optimize(out.back());
+    std::printf("%-32s %9zu %10.4f\n", name, n, ns / n);
+}
+
+template<class T>
+void make_inputs(std::size_t n, std::vector<T>& a, std::vector<T>& b, std::vector<T>& out)
+{
+    a.resize(n);
+    b.resize(n);
+    out.assign(n, T());
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        a[i] = static_cast<T>(i % 1000 + 1);
+        b[i] = static_cast<T>(i % 7 + 1);
+    }
+}
+
+#define BOOST_UNITS2_RUN(op, suffix, a, b, out)                         \
+    run("raw_" #op "_" #suffix, raw_##op##_##suffix, a, b, out);         \
+    run("unit_" #op "_" #suffix, unit_##op##_##suffix, a, b, out)
+
+#define BOOST_UNITS2_RUN_ALL(T, suffix, n)                      \
+    {                                                           \
+        std::vector<T> a, b, out;                               \
+        make_inputs(n, a, b, out);                              \
+        BOOST_UNITS2_RUN(mul, suffix, a, b, out);               \
+        BOOST_UNITS2_RUN(div, suffix, a, b, out);               \
+        BOOST_UNITS2_RUN(add, suffix, a, b, out);               \
+        BOOST_UNITS2_RUN(scale, suffix, a, b, out);             \
+        BOOST_UNITS2_RUN(convert, suffix, a, b, out);           \
+        BOOST_UNITS2_RUN(from_value, suffix, a, b, out);        \
+        BOOST_UNITS2_RUN(detail_from_value, suffix, a, b, out); \
+    }
+
+int main()
+{
+    for(std::size_t n : { std::size_t(1) << 12, std::size_t(1) << 20 })
+    {
+        BOOST_UNITS2_RUN_ALL(double, double, n);
+        BOOST_UNITS2_RUN_ALL(float, float, n);
+        BOOST_UNITS2_RUN_ALL(std::int64_t, int64, n);
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Throughput of the reductions in algorithms.hpp against the standard
+// algorithms on bare doubles, under each execution policy.  The
+// standard algorithms are not compensated, so the difference at one
+// thread is the cost of compensation; the par rows show how far the
+// reductions scale with the number of cores.  The parallel policies
+// need a backend, e.g. -ltbb with libstdc++.
+
+#include <boost/units2/algorithms.hpp>
+#include <boost/units2/si.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <execution>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+
+using namespace boost::units2;
+
+int main()
+{
+    std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    for(std::size_t n : { std::size_t(1) << 16, std::size_t(1) << 22, std::size_t(1) << 25 })
+    {
+        std::vector<double> raw_f(n), raw_d(n);
+        std::vector<quantity<si::newton>> f(n);
+        std::vector<quantity<si::meter>> d(n);
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            raw_f[i] = static_cast<double>(i % 1000) * 0.001;
+            raw_d[i] = static_cast<double>(i % 7 + 1);
+            f[i] = raw_f[i] * si::newton;
+            d[i] = raw_d[i] * si::meter;
+        }
+        double result = 0;
+        std::printf("%zu elements\n", n);
+        bench::report("  std::accumulate", bench::time_ns([&] { result = std::accumulate(raw_f.begin(), raw_f.end(), 0.0); }), n);
+        bench::do_not_optimize(result);
+        bench::report("  std::reduce, par", bench::time_ns([&] { result = std::reduce(std::execution::par, raw_f.begin(), raw_f.end()); }), n);
+        bench::do_not_optimize(result);
+        bench::report("  sum, seq", bench::time_ns([&] { result = sum(f).value(); }), n);
+        bench::do_not_optimize(result);
+        bench::report("  sum, par", bench::time_ns([&] { result = sum(std::execution::par, f).value(); }), n);
+        bench::do_not_optimize(result);
+        bench::report("  sum, par_unseq", bench::time_ns([&] { result = sum(std::execution::par_unseq, f).value(); }), n);
+        bench::do_not_optimize(result);
+        bench::report("  std::inner_product", bench::time_ns([&] { result = std::inner_product(raw_f.begin(), raw_f.end(), raw_d.begin(), 0.0); }), n);
+        bench::do_not_optimize(result);
+        bench::report("  std::transform_reduce, par", bench::time_ns([&] {
+            result = std::transform_reduce(std::execution::par, raw_f.begin(), raw_f.end(), raw_d.begin(), 0.0);
+        }), n);
+        bench::do_not_optimize(result);
+        bench::report("  dot, seq", bench::time_ns([&] { result = dot(f, d).value(); }), n);
+        bench::do_not_optimize(result);
+        bench::report("  dot, par", bench::time_ns([&] { result = dot(std::execution::par, f, d).value(); }), n);
+        bench::do_not_optimize(result);
+        bench::report("  variance, par", bench::time_ns([&] { result = variance(std::execution::par, f).value(); }), n);
+        bench::do_not_optimize(result);
+    }
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Throughput of batch conversion compared to converting one
+// quantity at a time.  The temperature cases measure the affine
+// conversion, which should be one multiply-add per element.
+
+#include <boost/units2/batch.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <boost/units2/temperature.hpp>
+#include <vector>
+#include "bench.hpp"
+
+using namespace boost::units2;
+
+inline constexpr auto millimeter = std::milli() * si::meter;
+
+// The conversion loop that users write without the batch API.
+template<auto From, auto To, class T>
+__attribute__((noinline))
+void convert_each(const std::vector<quantity<From, T>>& in, std::vector<quantity<To, T>>& out)
+{
+    for(std::size_t i = 0; i < in.size(); ++i)
+        out[i] = quantity<To, T>(in[i]);
+}
+
+template<auto From, auto To, class T>
+__attribute__((noinline))
+void convert_batch(const std::vector<quantity<From, T>>& in, std::vector<quantity<To, T>>& out)
+{
+    convert(std::span(in), std::span(out));
+}
+
+template<auto From, auto To, class T>
+void run(const char* name, std::size_t n)
+{
+    std::vector<quantity<From, T>> in;
+    for(std::size_t i = 0; i < n; ++i)
+        in.push_back(quantity<From, T>::from_value(static_cast<T>(i)));
+    std::vector<quantity<To, T>> out(n);
+    std::printf("%s, %zu elements\n", name, n);
+    bench::report("  scalar loop", bench::time_ns([&] { convert_each(in, out); }), n);
+    bench::report("  batch", bench::time_ns([&] { convert_batch(in, out); }), n);
+    bench::do_not_optimize(out.back());
+}
+
+int main()
+{
+    for(std::size_t n : { std::size_t(1) << 12, std::size_t(1) << 20, std::size_t(1) << 24 })
+    {
+        run<millimeter, si::meter, double>("mm -> m (double)", n);
+        run<millimeter, si::meter, float>("mm -> m (float)", n);
+        run<si::meter, si::meter, double>("m -> m (identity)", n);
+        run<temperatures::celsius, temperatures::fahrenheit, double>("C -> F (double)", n);
+        run<temperatures::celsius, temperatures::fahrenheit, float>("C -> F (float)", n);
+    }
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Throughput of formatting quantities as text: to_chars into a
+// buffer, std::format_to when available, and operator<< into a
+// reused std::ostringstream.  Note that to_chars writes the shortest
+// representation that round trips, while the stream rounds to its
+// precision, so it writes fewer digits.
+
+#include <boost/units2/format.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <cstddef>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+
+using namespace boost::units2;
+
+inline constexpr auto acceleration_unit = si::meter / pow<2>(si::second);
+
+template<auto Unit, class T>
+__attribute__((noinline))
+std::size_t format_to_chars(const std::vector<quantity<Unit, T>>& in, std::vector<char>& out)
+{
+    char* p = out.data();
+    char* end = p + out.size();
+    for(const auto& q : in)
+    {
+        p = to_chars(p, end, q).ptr;
+        *p++ = '\n';
+    }
+    return static_cast<std::size_t>(p - out.data());
+}
+
+#ifdef __cpp_lib_format
+template<auto Unit, class T>
+__attribute__((noinline))
+std::size_t format_std(const std::vector<quantity<Unit, T>>& in, std::vector<char>& out)
+{
+    char* p = out.data();
+    for(const auto& q : in)
+        p = std::format_to(p, "{}\n", q);
+    return static_cast<std::size_t>(p - out.data());
+}
+#endif
+
+template<auto Unit, class T>
+__attribute__((noinline))
+std::size_t format_ostream(const std::vector<quantity<Unit, T>>& in, std::ostringstream& os)
+{
+    os.str(std::string());
+    for(const auto& q : in)
+        os << q << '\n';
+    return static_cast<std::size_t>(os.tellp());
+}
+
+template<auto Unit, class T>
+void run(const char* name, std::size_t n)
+{
+    std::vector<quantity<Unit, T>> in;
+    for(std::size_t i = 0; i < n; ++i)
+        in.push_back(quantity<Unit, T>::from_value(static_cast<T>(i * 7919 % 100003) / static_cast<T>(7)));
+    std::vector<char> out(n * 64);
+    std::ostringstream os;
+    std::size_t size = 0;
+    std::printf("%s, %zu elements\n", name, n);
+    bench::report("  to_chars", bench::time_ns([&] { size = format_to_chars(in, out); }), n);
+    bench::do_not_optimize(size);
+#ifdef __cpp_lib_format
+    bench::report("  std::format_to", bench::time_ns([&] { size = format_std(in, out); }), n);
+    bench::do_not_optimize(size);
+#endif
+    bench::report("  ostream", bench::time_ns([&] { size = format_ostream(in, os); }), n);
+    bench::do_not_optimize(size);
+}
+
+int main()
+{
+    for(std::size_t n : { std::size_t(1) << 12, std::size_t(1) << 20 })
+    {
+        run<acceleration_unit, double>("m/s^2 (double)", n);
+        run<si::newton, int>("N (int)", n);
+    }
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Throughput of the exact integer conversion (rounding.hpp) compared
+// to applying the conversion factor as a double, for int64 values.
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "bench.hpp"
+
+using namespace boost::units2;
+
+inline constexpr auto nanosecond = std::nano() * si::second;
+inline constexpr auto microsecond = std::micro() * si::second;
+inline constexpr auto millisecond = std::milli() * si::second;
+inline constexpr auto micrometer = std::micro() * si::meter;
+inline constexpr auto thou = std::ratio<254, 10000000>() * si::meter;
+
+template<auto From, auto To, class S, class T>
+__attribute__((noinline))
+void convert_each(const std::vector<quantity<From, T>>& in, std::vector<quantity<To, T>>& out)
+{
+    for(std::size_t i = 0; i < in.size(); ++i)
+        out[i] = quantity_cast<To, S>(in[i]);
+}
+
+// Counts the values that the double path gets wrong.
+template<auto From, auto To, class T>
+std::size_t count_inexact(const std::vector<quantity<From, T>>& in)
+{
+    std::size_t result = 0;
+    for(const auto& q : in)
+        result += quantity_cast<To, double>(q).value() != quantity_cast<To>(q).value();
+    return result;
+}
+
+template<auto From, auto To, class T = std::int64_t>
+void run(const char* name, std::size_t n, std::type_identity_t<T> start, std::type_identity_t<T> step)
+{
+    std::vector<quantity<From, T>> in;
+    for(std::size_t i = 0; i < n; ++i)
+        in.push_back(quantity<From, T>::from_value(static_cast<T>(start + static_cast<T>(i) * step)));
+    std::vector<quantity<To, T>> out(n);
+    std::printf("%s, %zu elements, %zu inexact as double\n", name, n, count_inexact<From, To>(in));
+    bench::report("  double", bench::time_ns([&] { convert_each<From, To, double>(in, out); }), n);
+    bench::report("  exact, toward zero", bench::time_ns([&] { convert_each<From, To, rounding::toward_zero>(in, out); }), n);
+    bench::report("  exact, to nearest", bench::time_ns([&] { convert_each<From, To, rounding::to_nearest>(in, out); }), n);
+    bench::report("  exact, down", bench::time_ns([&] { convert_each<From, To, rounding::down>(in, out); }), n);
+    bench::do_not_optimize(out.back());
+}
+
+int main()
+{
+    constexpr std::int64_t epoch_ns = 1700000000000000000;
+    for(std::size_t n : { std::size_t(1) << 12, std::size_t(1) << 20 })
+    {
+        // Division only: timestamps in ns to coarser ticks.
+        run<nanosecond, microsecond>("ns -> us", n, epoch_ns, 999983);
+        run<nanosecond, millisecond>("ns -> ms", n, -epoch_ns, 999983);
+        // Multiplication only.
+        run<millisecond, nanosecond>("ms -> ns", n, epoch_ns / 1000000, 7);
+        // Both: 127/5000.
+        run<micrometer, thou>("um -> thou", n, std::int64_t(1) << 60, 1000003);
+    }
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Throughput of parsing unit-suffixed numbers, one per line.  The
+// baseline parses only the number with std::from_chars.  from_chars
+// into a quantity looks the symbol up in a compile-time perfect hash,
+// either the full si_symbol_table or a small custom table, or, for
+// compound units that are not in the table, parses the product of
+// symbols.  The runtime path parses the symbol with parse_unit and
+// computes the conversion factor for every line.
+
+#include <boost/units2/parse.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/runtime_unit.hpp>
+#include <boost/units2/si.hpp>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "bench.hpp"
+
+using namespace boost::units2;
+
+inline constexpr auto speed_unit = si::meter / si::second;
+inline constexpr auto kilometer = std::kilo() * si::meter;
+inline constexpr auto hour = std::ratio<3600>() * si::second;
+
+using speed_symbols = symbol_table<
+    prefixed<si::meter / si::second>,
+    spelled<"km/h", kilometer / hour>,
+    spelled<"kph", kilometer / hour>>;
+
+std::string make_input(std::size_t n, const std::vector<const char*>& symbols)
+{
+    std::string result;
+    char buf[32];
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        double value = static_cast<double>(i * 7919 % 100003) / 8;
+        result.append(buf, std::to_chars(buf, buf + sizeof(buf), value).ptr);
+        result += ' ';
+        result += symbols[i % symbols.size()];
+        result += '\n';
+    }
+    return result;
+}
+
+__attribute__((noinline))
+double parse_numbers(std::string_view text)
+{
+    double sum = 0;
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while(p != end)
+    {
+        double value;
+        p = std::from_chars(p, end, value).ptr;
+        while(*p != '\n')
+            ++p;
+        ++p;
+        sum += value;
+    }
+    return sum;
+}
+
+template<auto Unit, class... Table>
+__attribute__((noinline))
+double parse_quantities(std::string_view text, Table... table)
+{
+    double sum = 0;
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while(p != end)
+    {
+        quantity<Unit> q;
+        auto result = from_chars(p, end, q, table...);
+        if(result.ec != std::errc())
+            return -1;
+        p = result.ptr + 1;
+        sum += q.value();
+    }
+    return sum;
+}
+
+template<auto Unit>
+__attribute__((noinline))
+double parse_runtime(std::string_view text)
+{
+    const runtime_unit target(Unit);
+    const unit_symbol_table& table = unit_symbol_table::si();
+    double sum = 0;
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while(p != end)
+    {
+        double value;
+        p = std::from_chars(p, end, value).ptr + 1;
+        const char* q = p;
+        while(*p != '\n')
+            ++p;
+        runtime_unit u = parse_unit(std::string_view(q, static_cast<std::size_t>(p - q)), table);
+        ++p;
+        sum += value * conversion_factor(u, target);
+    }
+    return sum;
+}
+
+template<auto Unit, class Table>
+void run(const char* name, const char* table_name, std::size_t n, const std::vector<const char*>& symbols, Table table)
+{
+    std::string text = make_input(n, symbols);
+    double sum = 0;
+    std::printf("%s, %zu lines\n", name, n);
+    bench::report("  number only", bench::time_ns([&] { sum = parse_numbers(text); }), n);
+    bench::do_not_optimize(sum);
+    bench::report(table_name, bench::time_ns([&] { sum = parse_quantities<Unit>(text, table); }), n);
+    bench::do_not_optimize(sum);
+    bench::report("  runtime parse_unit", bench::time_ns([&] { sum = parse_runtime<Unit>(text); }), n);
+    bench::do_not_optimize(sum);
+}
+
+int main()
+{
+    for(std::size_t n : { std::size_t(1) << 12, std::size_t(1) << 22 })
+    {
+        run<si::meter>("length", "  from_chars (si_symbol_table)", n, { "m", "km", "mm", "\xC2\xB5m", "nm" }, si_symbol_table());
+        run<si::pascal>("pressure", "  from_chars (si_symbol_table)", n, { "Pa", "kPa", "MPa", "hPa" }, si_symbol_table());
+    }
+    // parse_unit does not know km/h, so only m/s spellings.
+    for(std::size_t n : { std::size_t(1) << 12, std::size_t(1) << 22 })
+    {
+        run<speed_unit>("speed", "  from_chars (custom table)", n, { "m/s", "km/s", "mm/s" }, speed_symbols());
+        run<speed_unit>("speed", "  from_chars (si_symbol_table, compound)", n, { "m/s", "km/s", "mm/s" }, si_symbol_table());
+        run<si::newton>("force", "  from_chars (si_symbol_table, compound)", n, { "kg*m/s^2", "g*km/s^2", "N" }, si_symbol_table());
+    }
+}
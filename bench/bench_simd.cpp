@@ -0,0 +1,82 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// A physics kernel (x += v * dt, with v in km/h and x in m) written
+// on raw doubles, on quantities of double and on quantities of SIMD
+// packs.  The unit-safe versions should run as fast as the raw one.
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <boost/units2/simd.hpp>
+#include <cstddef>
+#include <vector>
+#include "bench.hpp"
+
+using namespace boost::units2;
+
+inline constexpr auto kilometer = std::kilo() * si::meter;
+inline constexpr auto hour = std::ratio<3600>() * si::second;
+
+__attribute__((noinline))
+void step_raw(std::vector<double>& x, const std::vector<double>& v_kmh, double dt)
+{
+    for(std::size_t i = 0; i < x.size(); ++i)
+        x[i] += v_kmh[i] * (1000.0 / 3600.0) * dt;
+}
+
+__attribute__((noinline))
+void step_quantity(std::vector<quantity<si::meter>>& x, const std::vector<quantity<kilometer / hour>>& v, quantity<si::second> dt)
+{
+    for(std::size_t i = 0; i < x.size(); ++i)
+        x[i] = quantity<si::meter>(x[i] + v[i] * dt);
+}
+
+#ifdef __cpp_lib_experimental_parallel_simd
+
+using pack = std::experimental::native_simd<double>;
+
+__attribute__((noinline))
+void step_simd(std::vector<quantity<si::meter, pack>>& x, const std::vector<quantity<kilometer / hour, pack>>& v, quantity<si::second> dt)
+{
+    for(std::size_t i = 0; i < x.size(); ++i)
+        x[i] = quantity<si::meter, pack>(x[i] + v[i] * dt);
+}
+
+#endif
+
+void run(std::size_t n)
+{
+    std::printf("x += v * dt, %zu elements\n", n);
+    const double dt = 0.01;
+    std::vector<double> x(n), v(n);
+    for(std::size_t i = 0; i < n; ++i)
+        v[i] = static_cast<double>(i % 100);
+    bench::report("  double", bench::time_ns([&] { step_raw(x, v, dt); }), n);
+    bench::do_not_optimize(x.back());
+
+    std::vector<quantity<si::meter>> qx(n, 0.0 * si::meter);
+    std::vector<quantity<kilometer / hour>> qv;
+    for(std::size_t i = 0; i < n; ++i)
+        qv.push_back(v[i] * (kilometer / hour));
+    bench::report("  quantity<double>", bench::time_ns([&] { step_quantity(qx, qv, dt * si::second); }), n);
+    bench::do_not_optimize(qx.back());
+
+#ifdef __cpp_lib_experimental_parallel_simd
+    const std::size_t lanes = pack::size();
+    std::vector<quantity<si::meter, pack>> px(n / lanes, pack(0.0) * si::meter);
+    std::vector<quantity<kilometer / hour, pack>> pv;
+    for(std::size_t i = 0; i + lanes <= n; i += lanes)
+        pv.push_back(pack(&v[i], std::experimental::element_aligned) * (kilometer / hour));
+    bench::report("  quantity<simd>", bench::time_ns([&] { step_simd(px, pv, dt * si::second); }), n);
+    bench::do_not_optimize(px.back());
+#endif
+}
+
+int main()
+{
+    for(std::size_t n : { std::size_t(1) << 12, std::size_t(1) << 20 })
+        run(n);
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Throughput of decoding a stream of quantity messages.  The baseline
+// copies bare doubles out of the stream.  read_wire checks the tag of
+// each message, and converts through a conversion_table or a
+// unit_registry when the sender used a different unit.
+
+#include <boost/units2/wire.hpp>
+#include <boost/units2/conversion_table.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ratio>
+#include <span>
+#include <vector>
+#include "bench.hpp"
+
+using namespace boost::units2;
+
+inline constexpr auto kilometer = std::kilo() * si::meter;
+
+using length_table = conversion_table<si::meter, kilometer, std::milli() * si::meter>;
+
+__attribute__((noinline))
+double read_raw(const std::vector<std::byte>& in, std::size_t n)
+{
+    double sum = 0;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        double value;
+        std::memcpy(&value, in.data() + i * wire_size<double> + sizeof(std::uint64_t), sizeof(value));
+        sum += value;
+    }
+    return sum;
+}
+
+template<class... Conversions>
+__attribute__((noinline))
+double read_messages(const std::vector<std::byte>& in, std::size_t n, const Conversions&... conversions)
+{
+    double sum = 0;
+    for(std::size_t i = 0; i < n; ++i)
+        sum += read_wire<si::meter>(std::span(in).subspan(i * wire_size<double>), conversions...).value();
+    return sum;
+}
+
+template<auto Unit>
+std::vector<std::byte> make_messages(std::size_t n)
+{
+    std::vector<std::byte> result(n * wire_size<double>);
+    for(std::size_t i = 0; i < n; ++i)
+        write_wire(std::span(result).subspan(i * wire_size<double>), static_cast<double>(i % 1000) * Unit);
+    return result;
+}
+
+int main()
+{
+    unit_registry registry;
+    registry.add(si_conversion_table());
+    registry.add(length_table());
+    for(std::size_t n : { std::size_t(1) << 12, std::size_t(1) << 22 })
+    {
+        std::vector<std::byte> meters = make_messages<si::meter>(n);
+        std::vector<std::byte> kilometers = make_messages<kilometer>(n);
+        double sum = 0;
+        std::printf("%zu messages\n", n);
+        bench::report("  bare double", bench::time_ns([&] { sum = read_raw(meters, n); }), n);
+        bench::do_not_optimize(sum);
+        bench::report("  read_wire, same unit", bench::time_ns([&] { sum = read_messages(meters, n); }), n);
+        bench::do_not_optimize(sum);
+        bench::report("  read_wire, conversion_table", bench::time_ns([&] { sum = read_messages(kilometers, n, length_table()); }), n);
+        bench::do_not_optimize(sum);
+        bench::report("  read_wire, unit_registry", bench::time_ns([&] { sum = read_messages(kilometers, n, registry); }), n);
+        bench::do_not_optimize(sum);
+    }
+}
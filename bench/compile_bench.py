@@ -0,0 +1,276 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2018 Steven Watanabe
+#
+# Distributed under the Boost Software License Version 1.0. (See
+# accompanying file LICENSE_1_0.txt or copy at
+# http://www.boost.org/LICENSE_1_0.txt)
+
+"""Compile-time benchmarks for the unit algebra.
+
+Generates stress translation units that hammer detail::merge,
+detail::unit_multiply, detail::fold_conversion, the equivalence
+solver in conversion.hpp and dense_unit, compiles each one
+with -fsyntax-only, and records
+
+  - wall clock time (best of --repeat runs),
+  - peak resident memory of the compiler,
+  - template instantiation counts (only for compilers that
+    support -ftime-trace, i.e. clang; null otherwise).
+
+The results are compared against a baseline file.  Entries are keyed by
+the compiler's version string, so a baseline recorded with one compiler
+never judges another.  Any case that exceeds the baseline by more than
+the allowed tolerance is reported and the script exits with status 1.
+
+Usage:
+  compile_bench.py [--cxx g++] [--include DIR]... [--baseline FILE]
+                   [--update-baseline] [--output FILE] [--only PATTERN]
+"""
+
+import argparse
+import fnmatch
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+
+PRELUDE = """\
+#include <boost/units2/unit.hpp>
+#include <boost/units2/def.hpp>
+#include <ratio>
+#include <type_traits>
+
+using namespace boost::units2;
+"""
+
+# A fixed permutation keeps the generated sources stable between runs
+# while still forcing merges into the middle of the lists.
+def shuffled(n):
+    step = 7 if n % 7 else 5
+    return [(i * step) % n for i in range(n)]
+
+def gen_compound(n):
+    """A compound unit with n distinct bases, its inverse and a scaled copy."""
+    out = [PRELUDE]
+    for i in range(n):
+        out.append("BOOST_UNITS2_DEF(d%d);\n" % i)
+        out.append("BOOST_UNITS2_DEF(u%d, d%d);\n" % (i, i))
+    order = shuffled(n)
+    out.append("constexpr auto product = %s;\n" % " * ".join("u%d" % i for i in order))
+    out.append("constexpr auto inverse = %s;\n" % " / ".join(["compound_unit<>()"] + ["u%d" % i for i in reversed(order)]))
+    out.append("static_assert(std::is_same<std::remove_cv_t<decltype(product * inverse)>, compound_unit<> >::value, \"\");\n")
+    scales = ["std::kilo()", "std::milli()", "std::ratio<3,2>()", "std::ratio<2,3>()"]
+    out.append("constexpr auto scaled = %s;\n" % " * ".join(
+        "(%s * u%d)" % (scales[k % len(scales)], i) for k, i in enumerate(order)))
+    out.append("const double factor = conversion_factor(scaled, product);\n")
+    return "".join(out)
+
+def gen_chain(depth):
+    """A chain of BOOST_UNITS2_DEFs, each defined in terms of the previous."""
+    out = [PRELUDE, "BOOST_UNITS2_DEF(length);\n", "BOOST_UNITS2_DEF(c0, length);\n"]
+    for i in range(1, depth + 1):
+        out.append("BOOST_UNITS2_DEF(c%d, c%d * std::ratio<%d,%d>());\n" % (i, i - 1, i + 1, i + 2))
+    out.append("const double factor = conversion_factor(c%d, c0);\n" % depth)
+    out.append("const double area = conversion_factor(c%d * c%d, c0 * c%d);\n" % (depth, depth // 2, depth // 3))
+    return "".join(out)
+
+def gen_fold(n):
+    """A large fold tree: n scaled bases, mixing ratio and non-ratio scales."""
+    out = [PRELUDE]
+    for i in range(n):
+        out.append("BOOST_UNITS2_DEF(d%d);\n" % i)
+        out.append("BOOST_UNITS2_DEF(u%d, d%d);\n" % (i, i))
+        if i % 3 == 2:
+            out.append("struct s%d : scale_base { static constexpr double value() { return %d.25; } };\n" % (i, i))
+    def scale(i):
+        return "s%d()" % i if i % 3 == 2 else "std::ratio<%d,%d>()" % (i + 2, i + 1)
+    order = shuffled(n)
+    out.append("constexpr auto scaled = %s;\n" % " * ".join("(%s * pow<%d>(u%d))" % (scale(i), 1 + i % 3, i) for i in order))
+    out.append("constexpr auto plain = %s;\n" % " * ".join("pow<%d>(u%d)" % (1 + i % 3, i) for i in order))
+    out.append("const double factor = conversion_factor(scaled, plain);\n")
+    out.append("const double inverse = conversion_factor(plain, scaled);\n")
+    return "".join(out)
+
+def gen_solve(n):
+    """A conversion that needs all of n equivalences, given in a scrambled order.
+
+    Equivalence k is u_k * u_{k+1} == a ratio, so the system is
+    bidiagonal and every step of the elimination has work to do.
+    """
+    out = [PRELUDE, "#include <boost/units2/conversion.hpp>\n"]
+    for i in range(n + 1):
+        out.append("BOOST_UNITS2_DEF(d%d);\n" % i)
+        out.append("BOOST_UNITS2_DEF(u%d, d%d);\n" % (i, i))
+    eqs = ["equivalent(u%d * u%d, std::ratio<%d,%d>() * compound_unit<>())" % (k, k + 1, k + 2, k + 1)
+           for k in shuffled(n)]
+    target = "pow<-1>(u%d)" % n if n % 2 else "u%d" % n
+    out.append("const double factor = conversion_factor(u0, %s, %s);\n" % (target, ", ".join(eqs)))
+    return "".join(out)
+
+def gen_algebra(n, dense=False):
+    """n products of powers of all the SI base units, each with its own scale.
+
+    With dense, the same products are computed with dense_unit
+    (dense_unit.hpp) instead of compound_unit.
+    """
+    out = [PRELUDE, "#include <boost/units2/si.hpp>\n"]
+    bases = ["meter", "gram", "second", "kelvin", "mole", "ampere", "candela", "radian", "steradian"]
+    if dense:
+        out.append("#include <boost/units2/dense_unit.hpp>\n")
+        for b in bases:
+            out.append("constexpr auto %s = to_dense(si::%s);\n" % (b, b))
+    else:
+        out.append("using namespace boost::units2::si;\n")
+    for i in range(n):
+        factors = ["pow<%d>(%s)" % ((i // 2 + k) % 5 - 2 or 1, b) for k, b in enumerate(bases)]
+        out.append("constexpr auto p%d = std::ratio<%d,%d>() * %s;\n" % (i, i + 2, i + 1, " * ".join(factors)))
+    out.append("const double factor = conversion_factor(%s, %s);\n" % (
+        " * ".join("p%d" % i for i in range(0, n, 2)), " * ".join("p%d" % i for i in range(1, n, 2))))
+    return "".join(out)
+
+def gen_dense_algebra(n):
+    return gen_algebra(n, dense=True)
+
+CASES = {}
+for n in (2, 4, 8, 16, 32):
+    CASES["compound_%d" % n] = (gen_compound, n)
+for n in (4, 16, 64):
+    CASES["chain_%d" % n] = (gen_chain, n)
+for n in (4, 8, 16, 32):
+    CASES["fold_%d" % n] = (gen_fold, n)
+for n in (5, 8, 10):
+    CASES["solve_%d" % n] = (gen_solve, n)
+for n in (16, 64):
+    CASES["algebra_%d" % n] = (gen_algebra, n)
+    CASES["dense_algebra_%d" % n] = (gen_dense_algebra, n)
+
+def compiler_id(cxx):
+    out = subprocess.run([cxx, "--version"], stdout=subprocess.PIPE, universal_newlines=True, check=True).stdout
+    return out.splitlines()[0].strip()
+
+def supports_time_trace(cxx):
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, "probe.cpp")
+        with open(src, "w") as f:
+            f.write("int main() {}\n")
+        result = subprocess.run([cxx, "-ftime-trace", "-c", src, "-o", os.path.join(tmp, "probe.o")],
+                                stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        return result.returncode == 0
+
+def run_compiler(cmd):
+    """Runs cmd and returns (seconds, peak rss in KiB)."""
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    output = proc.stdout.read()
+    _, status, usage = os.wait4(proc.pid, 0)
+    elapsed = time.perf_counter() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    if proc.returncode != 0:
+        sys.stderr.write(output.decode(errors="replace"))
+        raise RuntimeError("compilation failed: " + " ".join(cmd))
+    return elapsed, usage.ru_maxrss
+
+def count_instantiations(trace_file):
+    with open(trace_file) as f:
+        events = json.load(f).get("traceEvents", [])
+    return sum(1 for e in events if e.get("name") in ("InstantiateClass", "InstantiateFunction"))
+
+def measure(cxx, flags, name, source, repeat, time_trace, workdir):
+    src = os.path.join(workdir, name + ".cpp")
+    with open(src, "w") as f:
+        f.write(source)
+    best_time = None
+    peak = 0
+    for _ in range(repeat):
+        elapsed, rss = run_compiler([cxx] + flags + ["-fsyntax-only", src])
+        best_time = elapsed if best_time is None else min(best_time, elapsed)
+        peak = max(peak, rss)
+    instantiations = None
+    if time_trace:
+        obj = os.path.join(workdir, name + ".o")
+        run_compiler([cxx] + flags + ["-ftime-trace", "-c", src, "-o", obj])
+        instantiations = count_instantiations(os.path.join(workdir, name + ".json"))
+    return {"time": round(best_time, 4), "memory_kib": peak, "instantiations": instantiations}
+
+def compare(name, result, base, tolerance):
+    failures = []
+    if result["time"] > base["time"] * (1 + tolerance["time"]) + tolerance["slack"]:
+        failures.append("time %.3fs > %.3fs" % (result["time"], base["time"]))
+    if result["memory_kib"] > base["memory_kib"] * (1 + tolerance["memory"]):
+        failures.append("memory %dKiB > %dKiB" % (result["memory_kib"], base["memory_kib"]))
+    if result["instantiations"] is not None and base.get("instantiations") is not None and \
+            result["instantiations"] > base["instantiations"] * (1 + tolerance["instantiations"]):
+        failures.append("instantiations %d > %d" % (result["instantiations"], base["instantiations"]))
+    return ["%s: %s" % (name, f) for f in failures]
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--std", default="c++20")
+    parser.add_argument("--include", "-I", action="append", default=[])
+    parser.add_argument("--baseline", default=os.path.join(HERE, "compile_baseline.json"))
+    parser.add_argument("--update-baseline", action="store_true")
+    parser.add_argument("--output", help="write the measurements to this file")
+    parser.add_argument("--only", default="*", help="glob selecting the cases to run")
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--time-tolerance", type=float, default=0.15)
+    parser.add_argument("--time-slack", type=float, default=0.05,
+                        help="absolute slack in seconds, so tiny cases don't trip on scheduler noise")
+    parser.add_argument("--memory-tolerance", type=float, default=0.10)
+    parser.add_argument("--instantiation-tolerance", type=float, default=0.0)
+    args = parser.parse_args()
+
+    flags = ["-std=" + args.std] + ["-I" + d for d in args.include] + ["-I" + os.path.join(ROOT, "include")]
+    compiler = compiler_id(args.cxx)
+    time_trace = supports_time_trace(args.cxx)
+    tolerance = {"time": args.time_tolerance, "slack": args.time_slack, "memory": args.memory_tolerance,
+                 "instantiations": args.instantiation_tolerance}
+
+    results = {}
+    with tempfile.TemporaryDirectory() as workdir:
+        for name in sorted(CASES):
+            if not fnmatch.fnmatch(name, args.only):
+                continue
+            gen, n = CASES[name]
+            results[name] = measure(args.cxx, flags, name, gen(n), args.repeat, time_trace, workdir)
+            r = results[name]
+            print("%-14s %8.3fs %9d KiB  %s" % (name, r["time"], r["memory_kib"],
+                  "-" if r["instantiations"] is None else "%d instantiations" % r["instantiations"]))
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump({compiler: results}, f, indent=2, sort_keys=True)
+
+    baselines = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baselines = json.load(f)
+
+    if args.update_baseline:
+        baselines.setdefault(compiler, {}).update(results)
+        with open(args.baseline, "w") as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("baseline updated for " + compiler)
+        return 0
+
+    base = baselines.get(compiler)
+    if base is None:
+        print("no baseline for " + compiler + "; run with --update-baseline to record one")
+        return 0
+    failures = []
+    for name, result in sorted(results.items()):
+        if name in base:
+            failures += compare(name, result, base[name], tolerance)
+    for f in failures:
+        print("REGRESSION " + f)
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
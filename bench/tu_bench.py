@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2018 Steven Watanabe
+#
+# Distributed under the Boost Software License Version 1.0. (See
+# accompanying file LICENSE_1_0.txt or copy at
+# http://www.boost.org/LICENSE_1_0.txt)
+
+"""Build-time benchmark for projects with many translation units.
+
+Generates --tus small translation units that use the SI units the way
+application code does (a few quantities, products and conversions per
+function) and compiles all of them to object files, --jobs at a time,
+once for each mode:
+
+  headers  #include <boost/units2/si.hpp> and quantity.hpp
+  module   import boost.units2 (module/boost_units2.cppm), which is
+           built once first; its build time is included in the total
+
+and reports the wall clock time of the whole build, the compiler CPU
+time summed over all processes and the largest peak resident memory
+of a single compiler process.  The module mode is skipped if the
+compiler cannot build the module.
+
+To compare two versions of the headers, point --root at another
+checkout, e.g. one made with git worktree.
+
+Usage:
+  tu_bench.py [--cxx g++] [--include DIR]... [--root DIR] [--tus N]
+              [--jobs N] [--modes headers,module] [--module-flags FLAGS]
+              [--output FILE]
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+
+HEADERS_PRELUDE = """\
+#include <ratio>
+#include <boost/units2/si.hpp>
+#include <boost/units2/quantity.hpp>
+"""
+
+# gcc 12 requires other headers to come before the import.
+MODULE_PRELUDE = """\
+#include <ratio>
+import boost.units2;
+"""
+
+PREFIXES = ["std::kilo()", "std::milli()", "std::micro()", "std::mega()"]
+DERIVED = ["newton", "joule", "watt", "pascal", "volt", "ohm", "tesla", "henry"]
+
+def gen_tu(prelude, i):
+    """One translation unit.  The units vary with i, so that the TUs are not identical."""
+    prefix = PREFIXES[i % len(PREFIXES)]
+    derived = DERIVED[i % len(DERIVED)]
+    other = DERIVED[(i + 3) % len(DERIVED)]
+    return prelude + """\
+
+using namespace boost::units2;
+
+namespace {{
+constexpr auto scaled_length = {prefix} * si::meter;
+constexpr auto speed = scaled_length / si::second;
+}}
+
+double tu{i}_speed(double distance, double seconds)
+{{
+    auto d = quantity<scaled_length>::from_value(distance);
+    auto t = quantity<si::second>::from_value(seconds);
+    auto rate = (1.0 / t.value()) * pow<-1>(si::second);
+    quantity<si::meter / si::second> v(d * rate);
+    return v.value();
+}}
+
+double tu{i}_derived(double x)
+{{
+    auto q = quantity<si::{derived}>::from_value(x);
+    quantity<si::{derived} * si::{other}> p = q * (2.0 * si::{other});
+    return p.value() * conversion_factor(speed, si::meter / si::second);
+}}
+
+double tu{i}_energy(double force, double distance)
+{{
+    auto e = quantity<si::newton>::from_value(force) * quantity<scaled_length>::from_value(distance);
+    return quantity<si::joule>(e).value();
+}}
+""".format(i=i, prefix=prefix, derived=derived, other=other)
+
+def compiler_id(cxx):
+    out = subprocess.run([cxx, "--version"], stdout=subprocess.PIPE, universal_newlines=True, check=True).stdout
+    return out.splitlines()[0].strip()
+
+def start_compiler(cmd, cwd):
+    return subprocess.Popen(cmd, cwd=cwd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+
+def wait_compiler(proc):
+    """Waits for proc and returns (cpu seconds, peak rss in KiB)."""
+    output = proc.stdout.read()
+    _, status, usage = os.wait4(proc.pid, 0)
+    if os.waitstatus_to_exitcode(status) != 0:
+        sys.stderr.write(output.decode(errors="replace"))
+        raise RuntimeError("compilation failed: " + " ".join(proc.args))
+    return usage.ru_utime + usage.ru_stime, usage.ru_maxrss
+
+def build(cmds, jobs, cwd):
+    """Runs the compiler commands, jobs at a time, and returns the totals."""
+    start = time.perf_counter()
+    cpu = 0.0
+    peak = 0
+    running = []
+    pending = list(cmds)
+    while pending or running:
+        while pending and len(running) < jobs:
+            running.append(start_compiler(pending.pop(0), cwd))
+        c, rss = wait_compiler(running.pop(0))
+        cpu += c
+        peak = max(peak, rss)
+    return {"wall": time.perf_counter() - start, "cpu": cpu, "memory_kib": peak}
+
+def run_mode(mode, args, flags, workdir):
+    tus = []
+    prelude = HEADERS_PRELUDE if mode == "headers" else MODULE_PRELUDE
+    for i in range(args.tus):
+        src = os.path.join(workdir, "tu%d.cpp" % i)
+        with open(src, "w") as f:
+            f.write(gen_tu(prelude, i))
+        tus.append(src)
+    result = {"wall": 0.0, "cpu": 0.0, "memory_kib": 0}
+    if mode == "module":
+        flags = flags + args.module_flags.split()
+        interface = os.path.join(args.root, "module", "boost_units2.cppm")
+        try:
+            result = build([[args.cxx] + flags + ["-c", "-x", "c++", interface, "-o", "boost_units2.o"]], 1, workdir)
+        except RuntimeError as e:
+            print("module: skipped (%s)" % e)
+            return None
+        result["module_wall"] = result["wall"]
+    tu_result = build([[args.cxx] + flags + ["-c", src, "-o", src[:-4] + ".o"] for src in tus], args.jobs, workdir)
+    result["wall"] += tu_result["wall"]
+    result["cpu"] += tu_result["cpu"]
+    result["memory_kib"] = max(result["memory_kib"], tu_result["memory_kib"])
+    return result
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--std", default="c++20")
+    parser.add_argument("--include", "-I", action="append", default=[])
+    parser.add_argument("--root", default=ROOT, help="the checkout whose headers and module are measured")
+    parser.add_argument("--tus", type=int, default=200)
+    parser.add_argument("--jobs", "-j", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--modes", default="headers,module")
+    parser.add_argument("--module-flags", default="-fmodules-ts", help="extra flags for the module mode")
+    parser.add_argument("--output", help="write the measurements to this file")
+    args = parser.parse_args()
+
+    args.root = os.path.abspath(args.root)
+    flags = ["-std=" + args.std, "-O0"] + ["-I" + os.path.join(args.root, "include")] + ["-I" + d for d in args.include]
+    results = {}
+    for mode in args.modes.split(","):
+        with tempfile.TemporaryDirectory() as workdir:
+            r = run_mode(mode, args, flags, workdir)
+        if r is None:
+            continue
+        results[mode] = {k: round(v, 3) if isinstance(v, float) else v for k, v in r.items()}
+        print("%-8s %4d TUs  wall %7.2fs  cpu %8.2fs  %9d KiB%s" % (
+            mode, args.tus, r["wall"], r["cpu"], r["memory_kib"],
+            "  (module %.2fs)" % r["module_wall"] if "module_wall" in r else ""))
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump({compiler_id(args.cxx): results}, f, indent=2, sort_keys=True)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
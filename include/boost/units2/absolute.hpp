@@ -5,116 +5,237 @@
 // http://www.boost.org/LICENSE_1_0.txt)
 
 #ifndef BOOST_UNITS2_ABSOLUTE_HPP_INCLUDED
-#define BOOST_UNITS2_ABSOlUTE_HPP_INCLUDED
+#define BOOST_UNITS2_ABSOLUTE_HPP_INCLUDED
 
-#include <boost/units2/unit.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/detail/rational.hpp>
+#include <cmath>
+#include <ratio>
 #include <type_traits>
 
 namespace boost {
 namespace units2 {
 
-// celsius - celsius = kelvin
-// celsius + kelvin = celsius
-// fahrenheit
-template<class Unit, class Offset=std::ratio<0>>
-struct absolute_unit {
-    absolute_unit() = default;
-    constexpr absolute_unit(Unit, Offset) {}
+/**
+ * A unit of an absolute scale, such as degrees Celsius.  A value x in
+ * absolute_unit<Unit, Offset> is the point x + Offset in Unit, counted
+ * from the zero of Unit.
+ *
+ *   absolute_unit(u)          the scale whose zero is the zero of u
+ *   absolute_unit(a, offset)  the scale whose zero is at offset in a
+ *   a * scale                 the scale with the same zero as a, and
+ *                             steps of scale in a
+ *
+ * The type is always reduced to absolute_unit<Unit, Offset>, where Unit
+ * is a relative unit and Offset is either a std::ratio or a scale.
+ *
+ * Absolute quantities convert to each other with a single multiply-add,
+ * and compare with each other.  The difference of two absolute
+ * quantities is a relative quantity in Unit, which can be added to
+ * or subtracted from an absolute quantity.
+ */
+template<class Unit, class Offset = std::ratio<0>>
+struct absolute_unit : unit_base<absolute_unit<Unit, Offset>> {
+    constexpr absolute_unit() = default;
+    template<class U>
+    explicit constexpr absolute_unit(U) {}
+    template<class U, class O>
+    constexpr absolute_unit(U, O) {}
     /// INTERNAL ONLY
     template<class F, class T>
     using _boost_units2_apply = typename F::template apply_absolute<Unit, Offset>;
+    /// INTERNAL ONLY
+    using _boost_units2_own_arithmetic = void;
+    /// INTERNAL ONLY
+    using _boost_units2_is_absolute = void;
+    /// INTERNAL ONLY
+    auto operator<=>(const absolute_unit&) const = default;
 };
 
-template<class Unit, class Offset, class Offset2>
-operator+(absolute_unit<U, Offset>, Offset2) -> absolute_unit<U, Offset + Offset2>;
-
-template<class Unit, class Offset, class Scale, class=requires_scale<Scale>>
-auto operator*(absolute_unit<U, Offset>, Scale) -> absolute_unit<scaled_unit<absolute_unit<U, Offset>, Factor> >
-{ return {}; }
-template<class Unit, std::intmax_t N1, std::intmax_t D1, std::intmax_t N2, std::intmax_t D2>
-auto operator*(absolute_unit<Unit, std::ratio<N1,D1>>, std::ratio<N2,D2>) -> absolute_unit<decltype(Unit{} * std::ratio<N2, D2>), std::ratio_divides<std::ratio<N1,D1>, std::ratio<N2,D2>>>
-{ return {}; }
-
 namespace detail {
 
-struct requires_absolute_impl
-{
-    template<class Unit, class Offset>
-    using apply_absolute = void;
-};
 template<class T>
-using requires_absolute = visit<requires_absolute_impl, T>;
-
-struct unitdiff_visitor;
+using requires_absolute = mp11::mp_if<is_absolute_unit<std::remove_cv_t<T>>, void>;
+template<class T>
+using requires_relative = std::enable_if_t<!is_absolute_unit<std::remove_cv_t<T>>::value, requires_unit<T>>;
 
-template<class Unit>
-using unitdiff_visit = visit<unitdiff_visitor, T>;
+template<class T, class U>
+struct offset_sum {
+    template<class R = double>
+    static constexpr R value() { return ::boost::units2::detail::get_value<R>(T()) + ::boost::units2::detail::get_value<R>(U()); }
+};
+template<class T, class U>
+struct offset_quotient {
+    template<class R = double>
+    static constexpr R value() { return ::boost::units2::detail::get_value<R>(T()) / ::boost::units2::detail::get_value<R>(U()); }
+};
 
+template<class T, class U>
+struct offset_add_impl { using type = offset_sum<T, U>; };
+template<std::intmax_t N1, std::intmax_t D1, std::intmax_t N2, std::intmax_t D2>
+struct offset_add_impl<std::ratio<N1, D1>, std::ratio<N2, D2>> { using type = std::ratio_add<std::ratio<N1, D1>, std::ratio<N2, D2>>; };
+template<class T, class U>
+struct offset_divide_impl { using type = offset_quotient<T, U>; };
+template<std::intmax_t N1, std::intmax_t D1, std::intmax_t N2, std::intmax_t D2>
+struct offset_divide_impl<std::ratio<N1, D1>, std::ratio<N2, D2>> { using type = std::ratio_divide<std::ratio<N1, D1>, std::ratio<N2, D2>>; };
+
+template<class T, class U>
+using offset_add = typename offset_add_impl<T, U>::type;
+template<class T, class U>
+using offset_divide = typename offset_divide_impl<T, U>::type;
+
+// The relative unit and offset of any unit.
 template<class T>
-using unitdiff_t = detected_or<T, unitdiff_visit, T>;
+struct absolute_parts { using unit = T; using offset = std::ratio<0>; };
+template<class U, class O>
+struct absolute_parts<absolute_unit<U, O>> { using unit = U; using offset = O; };
 
-struct unitdiff_visitor
-{
-    template<class Unit, class Scale>
-    using apply_scaled = scaled_unit<unitdiff_visit<Unit>, Scale>;
-    template<class Unit, class Offset>
-    using apply_absolute = unitdiff_t<Unit>;
-};
+template<class T>
+using relative_unit_t = typename absolute_parts<std::remove_cv_t<T>>::unit;
 
 }
 
-template<class Unit, class Offset>
-constexpr auto operator-(absolute_unit<Unit, Offset>, abosolute_unit<Unit, Offset>) -> detail::unitdiff_t<Unit>
+template<class U, class = detail::requires_relative<U>>
+absolute_unit(U) -> absolute_unit<U>;
+template<class U, class O, class = detail::requires_relative<U>>
+absolute_unit(U, O) -> absolute_unit<U, O>;
+template<class U, class O1, class O2>
+absolute_unit(absolute_unit<U, O1>, O2) -> absolute_unit<U, detail::offset_add<O1, O2>>;
+
+// x in a * s is x * s in a, which is x + O / s in U * s.
+template<class U, class O, std::intmax_t N, std::intmax_t D>
+constexpr auto operator*(absolute_unit<U, O>, std::ratio<N, D>)
+    -> absolute_unit<decltype(U() * std::ratio<N, D>()), detail::offset_divide<O, typename std::ratio<N, D>::type>>
 { return {}; }
-
-template<class Unit, class Offset>
-constexpr auto operator+(absolute_unit<Unit, Offset>, detail::unitdiff_t<Unit>) -> absolute_unit<Unit, Offset>
+template<class U, class O, std::intmax_t N, std::intmax_t D>
+constexpr auto operator*(std::ratio<N, D> s, absolute_unit<U, O> a) -> decltype(a * s)
 { return {}; }
-
-template<class Unit, class Offset>
-constexpr auto operator+(detail::unitdiff_t<Unit>, absolute_unit<Unit, Offset>) -> absolute_unit<Unit, Offset>
+template<class U, class O, class S, class = detail::requires_scale<S>>
+constexpr auto operator*(absolute_unit<U, O>, S) -> absolute_unit<decltype(U() * S()), detail::offset_divide<O, S>>
 { return {}; }
-
-template<class Unit, class Offset>
-constexpr auto operator-(absolute_unit<Unit, Offset>, detail::unitdiff_t<Unit>) -> absolute_unit<Unit, Offset>
+template<class U, class O, class S, class = detail::requires_scale<S>>
+constexpr auto operator*(S s, absolute_unit<U, O> a) -> decltype(a * s)
 { return {}; }
 
-template<class Unit, class Offset>
-constexpr auto operator+(absolute_unit<Unit, Offset>) -> absolute_unit<Unit, Offset>
-{ return {}; }
+/**
+ * The coefficients of a conversion between absolute units.  A value x
+ * in one unit is scale * x + offset in the other.
+ */
+template<class R>
+struct affine_factors {
+    R scale;
+    R offset;
+};
 
 namespace detail {
 
-struct offset_base_case
+// O1 * F - O2, exactly whenever the terms are rational and do not overflow.
+template<class R, class F, class O1, class O2>
+constexpr R affine_offset()
 {
-    template<class Unit>
-    using apply_base = void;
-    template<class... T>
-    using apply_composite = void;
-};
+    using C = scale_compute_t<R>;
+    if constexpr(is_std_ratio<F>::value && is_std_ratio<O1>::value && is_std_ratio<O2>::value)
+    {
+        rational result = rational(O1()) * rational(F()) - rational(O2());
+        if(result.valid()) return static_cast<R>(result.template value<C>());
+    }
+    return static_cast<R>(get_value<C>(O1()) * get_value<C>(F()) - get_value<C>(O2()));
+}
 
-template<class Unit, class=visit<offset_base_case, Unit>>
-constexpr auto base_offset(Unit) -> double { return 0; }
-template<class Unit, class Offset>
-constexpr auto base_offset(absolute_unit<Unit, Offset>) -> double
-{ return detail::base_offset(Unit{}) + detail::get_value(Offset{}); }
-template<class Unit, class Scale>
-constexpr auto base_offset(scaled_unit<Unit, Scale>) -> double
-{ return detail::base_offset(Unit{}) * detail::get_value(Scale{}); }
+}
 
+/**
+ * Returns the coefficients of the conversion from From to To, in R.
+ * The scale is the conversion_factor of the relative units.  Both are
+ * computed at compile time, and the offset is rounded only once when
+ * the offsets are rational.
+ */
+template<class R, class From, class To, class = detail::requires_absolute<From>, class = detail::requires_absolute<To>>
+constexpr affine_factors<R> affine_conversion(From, To)
+{
+    using from = detail::absolute_parts<From>;
+    using to = detail::absolute_parts<To>;
+    using factor = detail::conversion_ratio<typename from::unit, typename to::unit>;
+    return { ::boost::units2::conversion_factor<R>(typename from::unit(), typename to::unit()),
+        detail::affine_offset<R, factor, typename from::offset, typename to::offset>() };
+}
+// R defaults to double (see conversion_factor for why this is an overload).
+template<class From, class To, class = detail::requires_absolute<From>, class = detail::requires_absolute<To>>
+constexpr affine_factors<double> affine_conversion(From f, To t)
+{
+    return ::boost::units2::affine_conversion<double>(f, t);
 }
 
-template<class From, class To>
-auto conversion_offset(From, To)
+namespace detail {
+
+// a * x + b.  When the target has a fused multiply-add instruction,
+// this is a single fma, which also vectorizes to one instruction.
+// Constant evaluation rounds twice instead.
+template<class T, class R>
+constexpr auto multiply_add(const T& x, R a, R b)
 {
-    if constexpr(is_absolute)
+#ifdef FP_FAST_FMA
+    if constexpr(std::is_same<T, double>::value && std::is_same<R, double>::value)
+        if(!std::is_constant_evaluated()) return std::fma(x, a, b);
+#endif
+#ifdef FP_FAST_FMAF
+    if constexpr(std::is_same<T, float>::value && std::is_same<R, float>::value)
+        if(!std::is_constant_evaluated()) return std::fma(x, a, b);
+#endif
+    return x * a + b;
 }
 
-template<class From, class To, class T, class=requires_absolute<From>, class=requires_absolute<To>>
-constexpr auto convert(From, To, T&& value)
+template<class T, class S, class From, class To, class X>
+constexpr T convert_absolute(From, To, const X& x)
 {
-    return (value - detail::base_offset(From)) * conversion_factor(detail::unitdiff_t<From>{}, detail::unitdiff_t<To>{}) + detail::base_offset(To{});
+    static_assert(is_absolute_unit<From>::value && is_absolute_unit<To>::value,
+        "Cannot convert between absolute and relative units.");
+    static_assert(!is_rounding<S>::value, "Rounding policies do not apply to absolute units.");
+    using R = choose_scale_type<S, T>;
+    constexpr affine_factors<R> f = ::boost::units2::affine_conversion<R>(From(), To());
+    if constexpr(f.scale == 1 && f.offset == 0) return static_cast<T>(x);
+    else if constexpr(f.offset == 0) return static_cast<T>(x * f.scale);
+    else return static_cast<T>(::boost::units2::detail::multiply_add(x, f.scale, f.offset));
 }
 
 }
+
+// absolute - absolute is relative, in the relative unit of the first.
+template<auto Unit1, class T1, auto Unit2, class T2,
+    class = detail::requires_absolute<decltype(Unit1)>, class = detail::requires_absolute<decltype(Unit2)>>
+constexpr auto operator-(const quantity<Unit1, T1>& q1, const quantity<Unit2, T2>& q2)
+    -> quantity<detail::relative_unit_t<decltype(Unit1)>{}, decltype(q1.value() - q2.value())>
+{
+    using V = decltype(q1.value() - q2.value());
+    return detail::from_value(q1.value() - detail::convert_to<V, void>(Unit2, Unit1, q2.value()));
 }
+
+// absolute +- relative is absolute, in the unit of the absolute operand.
+template<auto Unit1, class T1, auto Unit2, class T2,
+    class = detail::requires_absolute<decltype(Unit1)>, class = detail::requires_relative<decltype(Unit2)>>
+constexpr auto operator+(const quantity<Unit1, T1>& q1, const quantity<Unit2, T2>& q2)
+    -> quantity<Unit1, decltype(q1.value() + q2.value())>
+{
+    using V = decltype(q1.value() + q2.value());
+    return detail::from_value(q1.value() + detail::convert_to<V, void>(Unit2, detail::relative_unit_t<decltype(Unit1)>(), q2.value()));
+}
+template<auto Unit1, class T1, auto Unit2, class T2,
+    class = detail::requires_relative<decltype(Unit1)>, class = detail::requires_absolute<decltype(Unit2)>>
+constexpr auto operator+(const quantity<Unit1, T1>& q1, const quantity<Unit2, T2>& q2)
+    -> quantity<Unit2, decltype(q1.value() + q2.value())>
+{
+    return q2 + q1;
+}
+template<auto Unit1, class T1, auto Unit2, class T2,
+    class = detail::requires_absolute<decltype(Unit1)>, class = detail::requires_relative<decltype(Unit2)>>
+constexpr auto operator-(const quantity<Unit1, T1>& q1, const quantity<Unit2, T2>& q2)
+    -> quantity<Unit1, decltype(q1.value() - q2.value())>
+{
+    using V = decltype(q1.value() - q2.value());
+    return detail::from_value(q1.value() - detail::convert_to<V, void>(Unit2, detail::relative_unit_t<decltype(Unit1)>(), q2.value()));
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,333 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_ALGORITHMS_HPP_INCLUDED
+#define BOOST_UNITS2_ALGORITHMS_HPP_INCLUDED
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/batch.hpp>
+#include <boost/assert.hpp>
+#include <boost/mp11/utility.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <execution>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Reductions over contiguous ranges of quantities.  The unit of each
+// result is computed from the units of the inputs, e.g. the dot product
+// of forces in newtons and displacements in meters is in joules.
+//
+// Every algorithm optionally takes an execution policy as its first
+// argument.  The input is split into chunks of a fixed size, which are
+// reduced in parallel under the policy, and the partial results are
+// combined in order.  The chunks do not depend on the policy or on the
+// number of threads, so the result is the same for every policy.
+//
+// Floating point sums are compensated (Kahan within each chunk, and
+// an exact two-sum when combining chunks), so the error does not grow
+// with the number of elements.  Compensation does not survive
+// -ffast-math, which lets the compiler cancel the correction terms.
+
+namespace boost {
+namespace units2 {
+namespace detail {
+
+template<class T>
+inline constexpr bool is_floating_value = std::is_floating_point<scalar_type_t<T>>::value;
+
+// The type in which a mean or an integral of T is computed.
+template<class T>
+using floating_value_t = mp11::mp_if_c<is_floating_value<T>, T, double>;
+
+template<class P>
+using requires_execution_policy = mp11::mp_if_c<std::is_execution_policy_v<std::remove_cvref_t<P>>, void>;
+
+template<class R>
+using range_quantity_t = std::remove_cv_t<std::ranges::range_value_t<R>>;
+
+template<class R>
+using requires_quantity_range = mp11::mp_if_c<std::ranges::contiguous_range<R> && std::ranges::sized_range<R>,
+    requires_quantity<range_quantity_t<R>>>;
+
+template<class R>
+using range_unit_t = quantity_unit_t<range_quantity_t<R>>;
+template<class R>
+using range_value_t = typename range_quantity_t<R>::value_type;
+
+template<class R>
+constexpr void check_relative_range()
+{
+    static_assert(!is_absolute_unit<range_unit_t<R>>::value,
+        "Quantities of absolute units cannot be summed.");
+}
+
+// A sum, represented as sum + error.  Integers are summed exactly,
+// so they have no error term.
+template<class T>
+struct compensated_sum {
+    T sum = T();
+    T error = T();
+    void add(const T& x)
+    {
+        if constexpr(is_floating_value<T>)
+        {
+            T y = x + error;
+            T t = sum + y;
+            error = y - (t - sum);
+            sum = t;
+        }
+        else sum += x;
+    }
+    void merge(const compensated_sum& other)
+    {
+        if constexpr(is_floating_value<T>)
+        {
+            // two-sum: s + e == sum + other.sum exactly.
+            T s = sum + other.sum;
+            T b = s - sum;
+            T e = (sum - (s - b)) + (other.sum - b);
+            sum = s;
+            error = error + other.error + e;
+        }
+        else sum += other.sum;
+    }
+    T value() const { return sum + error; }
+};
+
+// Sums term(i) for i in [first, last).  Each of batch_block_size lanes
+// keeps its own sum, so the loop has no dependency between adjacent
+// elements and can be vectorized.  The sums and errors of the lanes
+// are kept in separate arrays for the same reason.
+template<class T, class F>
+compensated_sum<T> sum_terms(std::size_t first, std::size_t last, F term)
+{
+    T sums[batch_block_size] = {};
+    T errors[batch_block_size] = {};
+    std::size_t i = first;
+    for(; i + batch_block_size <= last; i += batch_block_size)
+    {
+        for(std::size_t j = 0; j < batch_block_size; ++j)
+        {
+            if constexpr(is_floating_value<T>)
+            {
+                T y = term(i + j) + errors[j];
+                T t = sums[j] + y;
+                errors[j] = y - (t - sums[j]);
+                sums[j] = t;
+            }
+            else sums[j] += term(i + j);
+        }
+    }
+    compensated_sum<T> result;
+    for(std::size_t j = 0; j < batch_block_size; ++j)
+        result.merge({ sums[j], errors[j] });
+    for(; i < last; ++i)
+        result.add(term(i));
+    return result;
+}
+
+// Number of elements in each chunk of a reduction.
+inline constexpr std::size_t reduce_chunk_size = std::size_t(1) << 14;
+
+// Sums term(i) for i in [0, n), one chunk per task.
+template<class T, class P, class F>
+T reduce_terms(P&& policy, std::size_t n, F term)
+{
+    if(n <= reduce_chunk_size)
+        return ::boost::units2::detail::sum_terms<T>(0, n, term).value();
+    std::vector<compensated_sum<T>> partials((n + reduce_chunk_size - 1) / reduce_chunk_size);
+    compensated_sum<T>* first = partials.data();
+    std::for_each(static_cast<P&&>(policy), partials.begin(), partials.end(), [=](compensated_sum<T>& partial) {
+        std::size_t i = static_cast<std::size_t>(&partial - first) * reduce_chunk_size;
+        partial = ::boost::units2::detail::sum_terms<T>(i, std::min(n, i + reduce_chunk_size), term);
+    });
+    compensated_sum<T> result;
+    for(const compensated_sum<T>& partial : partials)
+        result.merge(partial);
+    return result.value();
+}
+
+}
+
+/// The sum of the elements of r.
+template<class P, class R, class = detail::requires_execution_policy<P>, class = detail::requires_quantity_range<R>>
+detail::range_quantity_t<R> sum(P&& policy, const R& r)
+{
+    detail::check_relative_range<R>();
+    using T = detail::range_value_t<R>;
+    const auto* data = std::ranges::data(r);
+    return detail::range_quantity_t<R>::from_value(::boost::units2::detail::reduce_terms<T>(
+        static_cast<P&&>(policy), std::ranges::size(r), [data](std::size_t i) { return data[i].value(); }));
+}
+template<class R, class = detail::requires_quantity_range<R>>
+detail::range_quantity_t<R> sum(const R& r)
+{
+    return ::boost::units2::sum(std::execution::seq, r);
+}
+
+/**
+ * The arithmetic mean of the elements of r.  The mean of integers
+ * is a double.
+ *
+ * \pre r is not empty.
+ */
+template<class P, class R, class = detail::requires_execution_policy<P>, class = detail::requires_quantity_range<R>>
+auto mean(P&& policy, const R& r) -> quantity<detail::range_unit_t<R>{}, detail::floating_value_t<detail::range_value_t<R>>>
+{
+    detail::check_relative_range<R>();
+    using M = detail::floating_value_t<detail::range_value_t<R>>;
+    BOOST_ASSERT(!std::ranges::empty(r));
+    const auto* data = std::ranges::data(r);
+    const std::size_t n = std::ranges::size(r);
+    M total = ::boost::units2::detail::reduce_terms<M>(static_cast<P&&>(policy), n,
+        [data](std::size_t i) { return static_cast<M>(data[i].value()); });
+    return detail::from_value{ total / static_cast<M>(n) };
+}
+template<class R, class = detail::requires_quantity_range<R>>
+auto mean(const R& r)
+{
+    return ::boost::units2::mean(std::execution::seq, r);
+}
+
+/**
+ * The variance of the elements of r, which is in the square of their
+ * unit.  The sum of the squared deviations from the mean is divided by
+ * r.size() - ddof, so ddof = 0 gives the population variance and
+ * ddof = 1 the sample variance.
+ *
+ * \pre r.size() > ddof
+ */
+template<class P, class R, class = detail::requires_execution_policy<P>, class = detail::requires_quantity_range<R>>
+auto variance(P&& policy, const R& r, std::size_t ddof = 0)
+    -> quantity<detail::unit_multiply<detail::range_unit_t<R>, detail::range_unit_t<R>>{}, detail::floating_value_t<detail::range_value_t<R>>>
+{
+    using M = detail::floating_value_t<detail::range_value_t<R>>;
+    const std::size_t n = std::ranges::size(r);
+    BOOST_ASSERT(n > ddof);
+    const M m = ::boost::units2::mean(policy, r).value();
+    const auto* data = std::ranges::data(r);
+    M total = ::boost::units2::detail::reduce_terms<M>(static_cast<P&&>(policy), n, [data, m](std::size_t i) {
+        M d = static_cast<M>(data[i].value()) - m;
+        return d * d;
+    });
+    return detail::from_value{ total / static_cast<M>(n - ddof) };
+}
+template<class R, class = detail::requires_quantity_range<R>>
+auto variance(const R& r, std::size_t ddof = 0)
+{
+    return ::boost::units2::variance(std::execution::seq, r, ddof);
+}
+
+/**
+ * The sum of the products of corresponding elements of a and b.
+ * The unit of the result is the product of their units.
+ *
+ * \pre a.size() == b.size()
+ */
+template<class P, class R1, class R2, class = detail::requires_execution_policy<P>,
+    class = detail::requires_quantity_range<R1>, class = detail::requires_quantity_range<R2>>
+auto dot(P&& policy, const R1& a, const R2& b)
+    -> quantity<detail::unit_multiply<detail::range_unit_t<R1>, detail::range_unit_t<R2>>{},
+        decltype(std::declval<detail::range_value_t<R1>>() * std::declval<detail::range_value_t<R2>>())>
+{
+    detail::check_relative_range<R1>();
+    detail::check_relative_range<R2>();
+    using T = decltype(std::declval<detail::range_value_t<R1>>() * std::declval<detail::range_value_t<R2>>());
+    BOOST_ASSERT(std::ranges::size(a) == std::ranges::size(b));
+    const auto* x = std::ranges::data(a);
+    const auto* y = std::ranges::data(b);
+    return detail::from_value{ ::boost::units2::detail::reduce_terms<T>(static_cast<P&&>(policy), std::ranges::size(a),
+        [x, y](std::size_t i) { return x[i].value() * y[i].value(); }) };
+}
+template<class R1, class R2, class = detail::requires_quantity_range<R1>, class = detail::requires_quantity_range<R2>>
+auto dot(const R1& a, const R2& b)
+{
+    return ::boost::units2::dot(std::execution::seq, a, b);
+}
+
+/**
+ * As std::inner_product: init plus the dot product of a and b.  The
+ * result has the type of init, whose unit must have the dimension of
+ * the product of the units of a and b.
+ *
+ * \pre a.size() == b.size()
+ */
+template<class P, class R1, class R2, class Init, class = detail::requires_execution_policy<P>,
+    class = detail::requires_quantity_range<R1>, class = detail::requires_quantity_range<R2>, class = detail::requires_quantity<Init>>
+Init inner_product(P&& policy, const R1& a, const R2& b, const Init& init)
+{
+    return Init(init + ::boost::units2::dot(static_cast<P&&>(policy), a, b));
+}
+template<class R1, class R2, class Init, class = detail::requires_quantity_range<R1>,
+    class = detail::requires_quantity_range<R2>, class = detail::requires_quantity<Init>>
+Init inner_product(const R1& a, const R2& b, const Init& init)
+{
+    return ::boost::units2::inner_product(std::execution::seq, a, b, init);
+}
+
+/**
+ * Integrates y over x with the trapezoidal rule, where y[i] is the
+ * value at x[i].  The unit of the result is the product of the units
+ * of y and x, e.g. power integrated over time gives energy.  Integers
+ * are integrated in double.
+ *
+ * \pre x.size() == y.size()
+ */
+template<class P, class RX, class RY, class = detail::requires_execution_policy<P>,
+    class = detail::requires_quantity_range<RX>, class = detail::requires_quantity_range<RY>>
+auto trapezoid_integrate(P&& policy, const RX& x, const RY& y)
+    -> quantity<detail::unit_multiply<detail::range_unit_t<RY>, detail::range_unit_t<RX>>{},
+        detail::floating_value_t<decltype(std::declval<detail::range_value_t<RY>>() * std::declval<detail::range_value_t<RX>>())>>
+{
+    detail::check_relative_range<RY>();
+    using T = detail::floating_value_t<decltype(std::declval<detail::range_value_t<RY>>() * std::declval<detail::range_value_t<RX>>())>;
+    const std::size_t n = std::ranges::size(x);
+    BOOST_ASSERT(n == std::ranges::size(y));
+    if(n < 2) return detail::from_value{ T() };
+    const auto* px = std::ranges::data(x);
+    const auto* py = std::ranges::data(y);
+    T total = ::boost::units2::detail::reduce_terms<T>(static_cast<P&&>(policy), n - 1, [px, py](std::size_t i) {
+        return (static_cast<T>(px[i + 1].value()) - static_cast<T>(px[i].value())) *
+            (static_cast<T>(py[i].value()) + static_cast<T>(py[i + 1].value()));
+    });
+    return detail::from_value{ total / 2 };
+}
+template<class RX, class RY, class = detail::requires_quantity_range<RX>, class = detail::requires_quantity_range<RY>>
+auto trapezoid_integrate(const RX& x, const RY& y)
+{
+    return ::boost::units2::trapezoid_integrate(std::execution::seq, x, y);
+}
+
+/// Integrates y, sampled at intervals of dx, with the trapezoidal rule.
+template<class P, class RY, auto Unit, class T, class = detail::requires_execution_policy<P>,
+    class = detail::requires_quantity_range<RY>>
+auto trapezoid_integrate(P&& policy, const RY& y, const quantity<Unit, T>& dx)
+    -> quantity<detail::unit_multiply<detail::range_unit_t<RY>, std::remove_cv_t<decltype(Unit)>>{},
+        detail::floating_value_t<decltype(std::declval<detail::range_value_t<RY>>() * std::declval<T>())>>
+{
+    detail::check_relative_range<RY>();
+    using M = detail::floating_value_t<decltype(std::declval<detail::range_value_t<RY>>() * std::declval<T>())>;
+    const std::size_t n = std::ranges::size(y);
+    if(n < 2) return detail::from_value{ M() };
+    const auto* py = std::ranges::data(y);
+    M total = ::boost::units2::detail::reduce_terms<M>(static_cast<P&&>(policy), n,
+        [py](std::size_t i) { return static_cast<M>(py[i].value()); });
+    total -= (static_cast<M>(py[0].value()) + static_cast<M>(py[n - 1].value())) / 2;
+    return detail::from_value{ total * static_cast<M>(dx.value()) };
+}
+template<class RY, auto Unit, class T, class = detail::requires_quantity_range<RY>>
+auto trapezoid_integrate(const RY& y, const quantity<Unit, T>& dx)
+{
+    return ::boost::units2::trapezoid_integrate(std::execution::seq, y, dx);
+}
+
+}
+}
+
+#endif
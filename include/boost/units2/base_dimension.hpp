@@ -0,0 +1,112 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_BASE_DIMENSION_HPP_INCLUDED
+#define BOOST_UNITS2_BASE_DIMENSION_HPP_INCLUDED
+
+#include <boost/units2/unit.hpp>
+#include <boost/units2/dimensions.hpp>
+#include <boost/units2/detail/rational.hpp>
+#include <boost/mp11/list.hpp>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+// Run time identification of the dimensions in dimensions.hpp.
+// Code that handles units at run time represents a dimension as
+// an array of exponents, indexed by base_dimension.
+
+namespace boost {
+namespace units2 {
+
+enum class base_dimension : unsigned char {
+    length, mass, time, temperature, amount, current,
+    luminous_intensity, angle, solid_angle
+};
+
+inline constexpr std::size_t base_dimension_count = 9;
+
+/// The name that the dimension was defined with.
+constexpr const char* dimension_name(base_dimension d)
+{
+    constexpr const char* names[] = {
+        length_t::name, mass_t::name, time_t::name, temperature_t::name, amount_t::name,
+        current_t::name, luminous_intensity_t::name, angle_t::name, solid_angle_t::name
+    };
+    return names[static_cast<std::size_t>(d)];
+}
+
+namespace detail {
+
+template<class T>
+struct base_dimension_of;
+template<> struct base_dimension_of<length_t> { static constexpr base_dimension value = base_dimension::length; };
+template<> struct base_dimension_of<mass_t> { static constexpr base_dimension value = base_dimension::mass; };
+template<> struct base_dimension_of<time_t> { static constexpr base_dimension value = base_dimension::time; };
+template<> struct base_dimension_of<temperature_t> { static constexpr base_dimension value = base_dimension::temperature; };
+template<> struct base_dimension_of<amount_t> { static constexpr base_dimension value = base_dimension::amount; };
+template<> struct base_dimension_of<current_t> { static constexpr base_dimension value = base_dimension::current; };
+template<> struct base_dimension_of<luminous_intensity_t> { static constexpr base_dimension value = base_dimension::luminous_intensity; };
+template<> struct base_dimension_of<angle_t> { static constexpr base_dimension value = base_dimension::angle; };
+template<> struct base_dimension_of<solid_angle_t> { static constexpr base_dimension value = base_dimension::solid_angle; };
+
+// The dimension for each value of base_dimension, in order.
+using base_dimension_types = mp11::mp_list<length_t, mass_t, time_t, temperature_t, amount_t,
+    current_t, luminous_intensity_t, angle_t, solid_angle_t>;
+
+template<class T, class = void>
+struct is_base_dimension : std::false_type {};
+template<class T>
+struct is_base_dimension<T, std::void_t<decltype(base_dimension_of<T>::value)>> : std::true_type {};
+
+// Note: rational has a user-provided default constructor, and arrays of
+// it are default-initialized rather than value-initialized ({}).  GCC 12
+// miscompiles value-initialized arrays of such class types that come
+// from a constant expression, leaving trailing elements zero-filled.
+using dimension_exponents = std::array<rational, base_dimension_count>;
+
+template<class T>
+struct dimension_exponents_impl
+{
+    static_assert(is_base_dimension<T>::value,
+        "Only the dimensions in dimensions.hpp can be represented at run time.");
+    static constexpr dimension_exponents value()
+    {
+        dimension_exponents result;
+        result[static_cast<std::size_t>(base_dimension_of<T>::value)] = 1;
+        return result;
+    }
+};
+template<class... B, class... E>
+struct dimension_exponents_impl<compound_unit<dim<B, E>...>>
+{
+    static_assert((is_base_dimension<B>::value && ...),
+        "Only the dimensions in dimensions.hpp can be represented at run time.");
+    static constexpr dimension_exponents value()
+    {
+        dimension_exponents result;
+        ((result[static_cast<std::size_t>(base_dimension_of<B>::value)] = rational(E())), ...);
+        return result;
+    }
+};
+
+// Whether the dimension T, as given by dimension_check, can be
+// represented as dimension_exponents.
+template<class T>
+struct has_dimension_exponents : is_base_dimension<T> {};
+template<class... B, class... E>
+struct has_dimension_exponents<compound_unit<dim<B, E>...>> : std::bool_constant<(is_base_dimension<B>::value && ...)> {};
+
+/// The exponent of each base dimension in the dimension of the unit T.
+template<class T>
+constexpr dimension_exponents exponents_of() { return dimension_exponents_impl<dimension_check<std::remove_cv_t<T>>>::value(); }
+
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,80 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_BATCH_HPP_INCLUDED
+#define BOOST_UNITS2_BATCH_HPP_INCLUDED
+
+#include <boost/units2/quantity.hpp>
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+namespace boost {
+namespace units2 {
+namespace detail {
+
+// Number of elements processed per block.  The inner loop over a block
+// has a constant trip count, so the compiler can turn it into vector
+// instructions for whatever the target supports (8 lanes covers AVX-512
+// doubles and AVX2 floats) even at -O2, without a vectorized epilogue.
+// The remainder is handled by a scalar tail.
+inline constexpr std::size_t batch_block_size = 8;
+
+// in and out must not overlap.
+template<class Out, class In, class F>
+constexpr void transform_blocks(const In* BOOST_RESTRICT in, Out* BOOST_RESTRICT out, std::size_t n, F f)
+{
+    std::size_t i = 0;
+    for(; i + batch_block_size <= n; i += batch_block_size)
+        for(std::size_t j = 0; j < batch_block_size; ++j)
+            out[i + j] = Out::from_value(static_cast<typename Out::value_type>(f(in[i + j].value())));
+    for(; i < n; ++i)
+        out[i] = Out::from_value(static_cast<typename Out::value_type>(f(in[i].value())));
+}
+
+}
+
+/**
+ * Converts every element of in to the unit of out.  The conversion
+ * factor is folded at compile time and applied as a single multiply
+ * per element.  Integers are converted exactly instead, as by
+ * quantity_cast.  A factor of exactly 1 skips the multiply.  Absolute
+ * units take one multiply-add per element (see absolute.hpp).  When the
+ * element types are identical, this is a plain copy, or nothing at all
+ * if in and out are the same buffer.
+ *
+ * \pre in.size() == out.size()
+ * \pre in and out do not overlap, except that when the element types
+ *      are identical they may be the same buffer.
+ */
+template<auto From, class T, std::size_t E1, auto To, class U, std::size_t E2>
+constexpr void convert(std::span<const quantity<From, T>, E1> in, std::span<quantity<To, U>, E2> out)
+{
+    BOOST_ASSERT(in.size() == out.size());
+    if constexpr(std::is_same<quantity<From, T>, quantity<To, U>>::value)
+    {
+        if(in.data() != out.data())
+            std::copy(in.begin(), in.end(), out.begin());
+    }
+    else
+    {
+        detail::transform_blocks(in.data(), out.data(), in.size(), [](const T& x) { return detail::convert_to<U, void>(From, To, x); });
+    }
+}
+
+template<auto From, class T, std::size_t E1, auto To, class U, std::size_t E2>
+constexpr void convert(std::span<quantity<From, T>, E1> in, std::span<quantity<To, U>, E2> out)
+{
+    ::boost::units2::convert(std::span<const quantity<From, T>, E1>(in), out);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,106 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_CHRONO_HPP_INCLUDED
+#define BOOST_UNITS2_CHRONO_HPP_INCLUDED
+
+// Conversions between quantities of time and std::chrono::duration.
+//
+// std::chrono::duration<Rep, std::ratio<N, D>> corresponds to
+// quantity<std::ratio<N, D>() * si::second, Rep>.  Between the two,
+// the conversion only copies the count.  Conversions to any other
+// unit or period go through quantity_cast, so integers are converted
+// exactly (see rounding.hpp), and the factor is folded at compile time.
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <chrono>
+#include <ratio>
+#include <type_traits>
+
+namespace boost {
+namespace units2 {
+
+/// The unit that counts ticks of std::chrono::duration<Rep, Period>.
+template<class Period>
+inline constexpr auto duration_unit = Period() * si::second;
+
+namespace detail {
+
+// The period of the std::chrono::duration that holds a quantity in Unit.
+template<class Unit>
+struct duration_period
+{
+    static_assert(std::is_same<dimension_check<Unit>, dimension_check<std::remove_cv_t<decltype(si::second)>>>::value,
+        "Only quantities of time can be converted to std::chrono::duration.");
+    using type = conversion_ratio<Unit, std::remove_cv_t<decltype(si::second)>>;
+    static_assert(is_std_ratio<type>::value,
+        "std::chrono::duration requires a unit that is a rational multiple of a second.");
+};
+
+template<class T>
+struct is_duration : std::false_type {};
+template<class Rep, class Period>
+struct is_duration<std::chrono::duration<Rep, Period>> : std::true_type {};
+
+}
+
+/// Returns the quantity with the same count as d.  This is a copy of the count.
+template<class Rep, class Period>
+constexpr quantity<duration_unit<Period>, Rep> to_quantity(const std::chrono::duration<Rep, Period>& d)
+{
+    return quantity<duration_unit<Period>, Rep>::from_value(d.count());
+}
+
+/// Returns the std::chrono::duration with the same count as q.
+/// This is a copy of the value.
+template<auto Unit, class Rep>
+constexpr auto to_duration(const quantity<Unit, Rep>& q)
+    -> std::chrono::duration<Rep, typename detail::duration_period<std::remove_cv_t<decltype(Unit)>>::type>
+{
+    return decltype(to_duration(q))(q.value());
+}
+
+/**
+ * Converts d to a quantity in Unit, like quantity_cast.  The value_type
+ * stays Rep.  S selects the scale type or the rounding, as for quantity_cast.
+ */
+template<auto Unit, class S, class Rep, class Period>
+constexpr quantity<Unit, Rep> quantity_cast(const std::chrono::duration<Rep, Period>& d)
+{
+    return ::boost::units2::quantity_cast<Unit, S>(::boost::units2::to_quantity(d));
+}
+// S defaults to void (see conversion_factor for why this is an overload).
+template<auto Unit, class Rep, class Period>
+constexpr quantity<Unit, Rep> quantity_cast(const std::chrono::duration<Rep, Period>& d)
+{
+    return ::boost::units2::quantity_cast<Unit, void>(d);
+}
+
+/**
+ * Converts q to the std::chrono::duration Duration.  The factor is
+ * applied as by quantity_cast, and S selects the scale type or the
+ * rounding.  Integers are converted exactly when the periods differ,
+ * unlike std::chrono::duration_cast, which may overflow in the
+ * intermediate product.
+ */
+template<class Duration, class S, auto Unit, class Rep, class = mp11::mp_if<detail::is_duration<Duration>, void>>
+constexpr Duration duration_cast(const quantity<Unit, Rep>& q)
+{
+    return Duration(detail::convert_to<typename Duration::rep, S>(
+        Unit, duration_unit<typename Duration::period>, q.value()));
+}
+// S defaults to void (see conversion_factor for why this is an overload).
+template<class Duration, auto Unit, class Rep, class = mp11::mp_if<detail::is_duration<Duration>, void>>
+constexpr Duration duration_cast(const quantity<Unit, Rep>& q)
+{
+    return ::boost::units2::duration_cast<Duration, void>(q);
+}
+
+}
+}
+
+#endif
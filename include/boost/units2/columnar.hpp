@@ -0,0 +1,388 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_COLUMNAR_HPP_INCLUDED
+#define BOOST_UNITS2_COLUMNAR_HPP_INCLUDED
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/absolute.hpp>
+#include <boost/units2/quantity_span.hpp>
+#include <boost/units2/quantity_vector.hpp>
+#include <boost/units2/batch.hpp>
+#include <boost/units2/converted_column.hpp>
+#include <boost/units2/detail/rational.hpp>
+#include <boost/units2/detail/unit_name.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/assert.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// A columnar file format for quantities.  Every column records the
+// canonical name of its unit (see detail/unit_name.hpp), so a reader can
+// only view the data in the unit it was written in, or convert it
+// explicitly.  The name is not qualified by a namespace, so units that
+// BOOST_UNITS2_DEF defines with the same name in different namespaces
+// are taken to be the same unit.
+//
+// Layout (all integers in the byte order of the writer):
+//
+//   header:    magic "BU2COLS\0", u32 version, u32 byte order mark,
+//              u64 number of columns, u64 total size of the directory
+//   directory: one entry per column:
+//              u64 data offset, u64 number of elements, u32 value type,
+//              u32 element size, u32 name length, u32 unit length,
+//              then the name and the unit, padded to a multiple of 8
+//   data:      the raw values of each column, starting at a multiple
+//              of column_alignment
+//
+// Readers map the file into memory.  Nothing is copied or converted
+// until it is accessed.
+
+namespace boost {
+namespace units2 {
+
+/// Thrown when a columnar file is malformed or does
+/// not contain the requested column.
+class columnar_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+
+// The conversion from From to To.  Only absolute units have an offset.
+template<class R, class From, class To>
+constexpr affine_factors<R> column_conversion(From, To)
+{
+    if constexpr(is_absolute_unit<From>::value || is_absolute_unit<To>::value)
+        return ::boost::units2::affine_conversion<R>(From(), To());
+    else
+        return { ::boost::units2::conversion_factor<R>(From(), To()), R(0) };
+}
+
+// The exact factor from From to To, for integer columns.
+template<class From, class To>
+constexpr rational column_ratio(From, To)
+{
+    using factor = conversion_ratio<From, std::remove_cv_t<To>>;
+    static_assert(!is_absolute_unit<From>::value && !is_absolute_unit<std::remove_cv_t<To>>::value && is_std_ratio<factor>::value,
+        "Integer columns can only be converted by a rational factor, without an offset.");
+    return rational(factor());
+}
+
+inline constexpr char columnar_magic[8] = { 'B', 'U', '2', 'C', 'O', 'L', 'S', '\0' };
+inline constexpr std::uint32_t columnar_version = 1;
+inline constexpr std::uint32_t columnar_byte_order = 0x01020304;
+
+struct columnar_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t column_count;
+    std::uint64_t directory_size;
+};
+
+struct columnar_entry {
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t type;
+    std::uint32_t element_size;
+    std::uint32_t name_size;
+    std::uint32_t unit_size;
+};
+
+constexpr std::uint64_t align_up(std::uint64_t n, std::uint64_t alignment)
+{
+    return (n + alignment - 1) / alignment * alignment;
+}
+
+}
+
+/// Every column starts at a multiple of this many bytes.
+inline constexpr std::size_t column_alignment = 64;
+
+/// Describes a column of a columnar_file.
+struct column_info {
+    std::string_view name;
+    /// The canonical name of the unit.
+    std::string_view unit;
+    column_value_type type;
+    std::size_t size;
+};
+
+/**
+ * Collects columns and writes them to a file.  Columns are
+ * not copied, so the data must remain valid until write returns.
+ */
+class columnar_writer {
+public:
+    /// Adds a column.  Throws columnar_error if a column
+    /// with the same name was already added.
+    template<auto Unit, class T, std::size_t E>
+    void add(std::string name, std::span<const quantity<Unit, T>, E> data)
+    {
+        auto values = ::boost::units2::as_values(data);
+        add_raw(std::move(name), detail::unit_name<decltype(Unit)>(),
+            detail::column_value_type_of<T>::value, sizeof(T), values.data(), values.size());
+    }
+    template<auto Unit, class T, std::size_t E>
+    void add(std::string name, std::span<quantity<Unit, T>, E> data)
+    {
+        add(std::move(name), std::span<const quantity<Unit, T>, E>(data));
+    }
+    template<auto Unit, class T, class Alloc>
+    void add(std::string name, const quantity_vector<Unit, T, Alloc>& data)
+    {
+        add(std::move(name), std::span<const quantity<Unit, T>>(data.data(), data.size()));
+    }
+
+    /// Writes all the columns.  Throws columnar_error if the
+    /// stream fails.
+    void write(std::ostream& os) const
+    {
+        detail::columnar_header header;
+        std::memcpy(header.magic, detail::columnar_magic, sizeof(header.magic));
+        header.version = detail::columnar_version;
+        header.byte_order = detail::columnar_byte_order;
+        header.column_count = columns_.size();
+        header.directory_size = 0;
+        for(const column& c : columns_)
+            header.directory_size += entry_size(c);
+
+        std::uint64_t pos = detail::align_up(sizeof(header) + header.directory_size, column_alignment);
+        std::vector<std::uint64_t> offsets;
+        for(const column& c : columns_)
+        {
+            offsets.push_back(pos);
+            pos = detail::align_up(pos + c.size * c.element_size, column_alignment);
+        }
+
+        std::uint64_t written = 0;
+        auto put = [&](const void* p, std::size_t n) {
+            os.write(static_cast<const char*>(p), static_cast<std::streamsize>(n));
+            written += n;
+        };
+        auto pad_to = [&](std::uint64_t target) {
+            static constexpr char zeros[column_alignment] = {};
+            while(written < target)
+                put(zeros, static_cast<std::size_t>(std::min<std::uint64_t>(target - written, sizeof(zeros))));
+        };
+        put(&header, sizeof(header));
+        for(std::size_t i = 0; i < columns_.size(); ++i)
+        {
+            const column& c = columns_[i];
+            detail::columnar_entry entry = { offsets[i], c.size, static_cast<std::uint32_t>(c.type),
+                c.element_size, static_cast<std::uint32_t>(c.name.size()), static_cast<std::uint32_t>(c.unit.size()) };
+            std::uint64_t start = written;
+            put(&entry, sizeof(entry));
+            put(c.name.data(), c.name.size());
+            put(c.unit.data(), c.unit.size());
+            pad_to(start + entry_size(c));
+        }
+        for(std::size_t i = 0; i < columns_.size(); ++i)
+        {
+            pad_to(offsets[i]);
+            put(columns_[i].data, columns_[i].size * columns_[i].element_size);
+        }
+        pad_to(pos);
+        if(!os) throw columnar_error("boost::units2::columnar_writer: write failed");
+    }
+    void write(const std::string& path) const
+    {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        if(!os) throw columnar_error("boost::units2::columnar_writer: cannot open " + path);
+        write(os);
+        os.close();
+        if(!os) throw columnar_error("boost::units2::columnar_writer: write failed: " + path);
+    }
+private:
+    struct column {
+        std::string name;
+        std::string unit;
+        column_value_type type;
+        std::uint32_t element_size;
+        const void* data;
+        std::uint64_t size;
+    };
+    static std::uint64_t entry_size(const column& c)
+    {
+        return detail::align_up(sizeof(detail::columnar_entry) + c.name.size() + c.unit.size(), 8);
+    }
+    void add_raw(std::string name, const std::string& unit, column_value_type type,
+        std::uint32_t element_size, const void* data, std::size_t size)
+    {
+        for(const column& c : columns_)
+            if(c.name == name)
+                throw columnar_error("boost::units2::columnar_writer: duplicate column: " + name);
+        columns_.push_back(column{ std::move(name), unit, type, element_size, data, size });
+    }
+    std::vector<column> columns_;
+};
+
+/**
+ * A read-only columnar file, mapped into memory.  The
+ * columns are views of the mapping, so they are only valid
+ * as long as the columnar_file is alive.
+ */
+class columnar_file {
+public:
+    /// Maps the file at path.  Throws columnar_error if the
+    /// file cannot be opened or is malformed.
+    explicit columnar_file(const std::string& path)
+    {
+        namespace ipc = ::boost::interprocess;
+        try
+        {
+            ipc::file_mapping mapping(path.c_str(), ipc::read_only);
+            region_ = ipc::mapped_region(mapping, ipc::read_only);
+        }
+        catch(const ipc::interprocess_exception& e)
+        {
+            throw columnar_error("boost::units2::columnar_file: cannot map " + path + ": " + e.what());
+        }
+        parse();
+    }
+
+    /// The columns, in the order in which they were written.
+    std::span<const column_info> columns() const noexcept { return columns_; }
+    bool contains(std::string_view name) const noexcept { return find(name) != npos; }
+    /// Throws columnar_error if there is no such column.
+    const column_info& info(std::string_view name) const { return columns_[index(name)]; }
+
+    /**
+     * Returns the column as stored.  Throws columnar_error if the
+     * column was not written in Unit with values of type T.
+     */
+    template<auto Unit, class T = double>
+    quantity_span<Unit, const T> column(std::string_view name) const
+    {
+        std::size_t i = checked_index<T>(name);
+        if(columns_[i].unit != detail::unit_name<decltype(Unit)>())
+            throw columnar_error(unit_mismatch(columns_[i], detail::unit_name<decltype(Unit)>()));
+        return ::boost::units2::as_quantities<Unit>(static_cast<const T*>(data_[i]), columns_[i].size);
+    }
+
+    /**
+     * Returns the column as values in Unit.  The column must have been
+     * written either in Unit or in one of the units stored.  The factor
+     * for each candidate is computed at compile time; the stored name
+     * selects which one is used.  Throws columnar_error if the column
+     * is in any other unit or its values are not of type T.  Integer
+     * columns are converted exactly, and only between units related
+     * by a rational factor (see converted_column).
+     */
+    template<auto Unit, class T = double, class... Stored>
+    converted_column<Unit, T> column_as(std::string_view name, Stored...) const
+    {
+        using scale_type = typename converted_column<Unit, T>::scale_type;
+        std::size_t i = checked_index<T>(name);
+        const std::string* names[] = { &detail::unit_name<decltype(Unit)>(), &detail::unit_name<Stored>()... };
+        for(std::size_t j = 0; j < std::size(names); ++j)
+        {
+            if(columns_[i].unit != *names[j]) continue;
+            if constexpr(detail::is_integer_value<T>)
+            {
+                constexpr detail::rational ratios[] = { detail::rational(1), detail::column_ratio(Stored{}, Unit)... };
+                return converted_column<Unit, T>(static_cast<const T*>(data_[i]), columns_[i].size, ratios[j]);
+            }
+            else
+            {
+                constexpr affine_factors<scale_type> factors[] = {
+                    { scale_type(1), scale_type(0) }, detail::column_conversion<scale_type>(Stored{}, Unit)... };
+                return converted_column<Unit, T>(static_cast<const T*>(data_[i]), columns_[i].size, factors[j].scale, factors[j].offset);
+            }
+        }
+        throw columnar_error(unit_mismatch(columns_[i], *names[0]));
+    }
+private:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::size_t find(std::string_view name) const noexcept
+    {
+        for(std::size_t i = 0; i < columns_.size(); ++i)
+            if(columns_[i].name == name) return i;
+        return npos;
+    }
+    std::size_t index(std::string_view name) const
+    {
+        std::size_t i = find(name);
+        if(i == npos) throw columnar_error("boost::units2::columnar_file: no column named " + std::string(name));
+        return i;
+    }
+    template<class T>
+    std::size_t checked_index(std::string_view name) const
+    {
+        std::size_t i = index(name);
+        if(columns_[i].type != detail::column_value_type_of<T>::value)
+            throw columnar_error("boost::units2::columnar_file: column " + std::string(name) + " has a different value type");
+        return i;
+    }
+    static std::string unit_mismatch(const column_info& info, const std::string& requested)
+    {
+        return "boost::units2::columnar_file: column " + std::string(info.name) +
+            " is in " + std::string(info.unit) + ", not " + requested;
+    }
+    [[noreturn]] static void malformed(const char* what)
+    {
+        throw columnar_error(std::string("boost::units2::columnar_file: malformed file: ") + what);
+    }
+
+    void parse()
+    {
+        const unsigned char* base = static_cast<const unsigned char*>(region_.get_address());
+        const std::uint64_t file_size = region_.get_size();
+        detail::columnar_header header;
+        if(file_size < sizeof(header)) malformed("truncated header");
+        std::memcpy(&header, base, sizeof(header));
+        if(std::memcmp(header.magic, detail::columnar_magic, sizeof(header.magic)) != 0) malformed("bad magic");
+        if(header.byte_order != detail::columnar_byte_order) malformed("foreign byte order");
+        if(header.version != detail::columnar_version) malformed("unsupported version");
+        if(header.directory_size > file_size - sizeof(header)) malformed("truncated directory");
+
+        static constexpr std::uint32_t element_sizes[] = { 1, 2, 4, 8, 1, 2, 4, 8, 4, 8 };
+        std::uint64_t pos = sizeof(header);
+        const std::uint64_t end = pos + header.directory_size;
+        for(std::uint64_t i = 0; i < header.column_count; ++i)
+        {
+            detail::columnar_entry entry;
+            if(end - pos < sizeof(entry)) malformed("truncated directory");
+            std::memcpy(&entry, base + pos, sizeof(entry));
+            const std::uint64_t strings = std::uint64_t(entry.name_size) + entry.unit_size;
+            if(end - pos - sizeof(entry) < strings) malformed("truncated directory");
+            const char* text = reinterpret_cast<const char*>(base + pos + sizeof(entry));
+            pos = std::min(end, detail::align_up(pos + sizeof(entry) + strings, 8));
+
+            if(entry.type < 1 || entry.type > static_cast<std::uint32_t>(column_value_type::float64)) malformed("unknown value type");
+            if(entry.element_size != element_sizes[entry.type - 1]) malformed("bad element size");
+            if(entry.offset % column_alignment != 0) malformed("misaligned column");
+            if(entry.offset > file_size || entry.size > (file_size - entry.offset) / entry.element_size) malformed("truncated column");
+
+            columns_.push_back(column_info{ std::string_view(text, entry.name_size), std::string_view(text + entry.name_size, entry.unit_size),
+                static_cast<column_value_type>(entry.type), static_cast<std::size_t>(entry.size) });
+            data_.push_back(base + entry.offset);
+        }
+    }
+
+    ::boost::interprocess::mapped_region region_;
+    std::vector<column_info> columns_;
+    std::vector<const void*> data_;
+};
+
+}
+}
+
+#endif
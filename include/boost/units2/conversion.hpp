@@ -7,8 +7,14 @@
 #ifndef BOOST_UNITS2_CONVERSION_HPP_INCLUDED
 #define BOOST_UNITS2_CONVERSION_HPP_INCLUDED
 
-namespace boost {
-namespace units2 {
+#include <boost/units2/unit.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/detail/rational.hpp>
+#include <boost/mp11/algorithm.hpp>
+#include <array>
+#include <cstddef>
+#include <ratio>
+#include <type_traits>
 
 // some conversions may be allowed conditionally.
 // for example, radians is dimensionless.
@@ -20,55 +26,194 @@ namespace units2 {
 // Algorithm: Divide the units as for a regular conversion
 // then match the extra conversions against the quotient.
 //
-// extra conversions are reduced to a dimension + scale
+// Each equivalence A == B is reduced to the unit A/B, which
+// has a dimension d_k and a scale c_k.  We solve for x1, ..., xn in:
+//   x1 * d1 + x2 * d2 + ... + xn * dn = quotient
+// using exact rational arithmetic at compile time.  Then
+//   T/U * (B1/A1)^x1 * ... * (Bn/An)^xn
+// is dimensionless, and its scale is the conversion factor.  The
+// final step goes through the ordinary conversion machinery, so
+// the result is as exact as any other conversion.
 //
-// We solve for x1, x2, ..., xn in:
-// x1 * dim1 + x2 * dim2 + ... + xn * dimn = quotient
-// and then multiply (or maybe divide?) by scale1^x1 * scale2^x2 * ... * scale2^x3
+// If the equivalences are not independent, the free variables are
+// set to 0.  Consistent equivalences give the same answer for any
+// solution.
+
+namespace boost {
+namespace units2 {
 
-template<class... T>
-struct conversion_list {};
+/**
+ * States that one A is the same as one B for the purposes of
+ * a conversion.  Create it with equivalent.
+ */
+template<class A, class B>
+struct equivalence {};
 
-dimension -> factor;
+/// Allows conversion_factor to treat a as equal to b.
+template<class A, class B, class = detail::requires_unit<A>, class = detail::requires_unit<B>>
+constexpr equivalence<A, B> equivalent(A, B) { return {}; }
 
 namespace detail {
 
-struct runtime_ratio { std::intmax_t num, den; };
-
-constexpr array<runtime_ratio, N> solve(...);
+// The base dimensions that appear in a normalized dimension.
+template<class D>
+struct dimension_bases { using type = mp11::mp_list<D>; };
+template<class... B, class... E>
+struct dimension_bases<compound_unit<dim<B, E>...>> { using type = mp11::mp_list<B...>; };
+
+// The exponent of the base dimension B in the normalized dimension D.
+template<class B, class D>
+struct dimension_exponent { static constexpr rational value() { return std::is_same<B, D>::value? 1 : 0; } };
+template<class B, class... B2, class... E>
+struct dimension_exponent<B, compound_unit<dim<B2, E>...>>
+{
+    static constexpr rational value()
+    {
+        rational result;
+        ((std::is_same<B, B2>::value? void(result = rational(E())) : void()), ...);
+        return result;
+    }
+};
 
-inline constexpr void solve(int* matrix, int M, int N, int * vec, int * out)
+template<class Bases, class D>
+struct dimension_vector;
+template<class... B, class D>
+struct dimension_vector<mp11::mp_list<B...>, D>
+{
+    static constexpr std::array<rational, sizeof...(B)> value()
+    {
+        // Not value-initialized: see the note on dimension_exponents.
+        std::array<rational, sizeof...(B)> result;
+        std::size_t i = 0;
+        ((result[i++] = dimension_exponent<B, D>::value()), ...);
+        return result;
+    }
+};
+
+template<std::size_t N>
+struct linear_solution {
+    enum status_type { solved, inconsistent, overflow };
+    status_type status;
+    std::array<rational, N> x;
+};
+
+// Solves A x = b by Gauss-Jordan elimination, where A is M by N,
+// stored row major.  Free variables are set to 0.
+template<std::size_t M, std::size_t N>
+constexpr linear_solution<N> solve(std::array<rational, M * N> a, std::array<rational, M> b)
 {
-    for(int i = 0; i < M; ++i)
+    linear_solution<N> result{ linear_solution<N>::solved, {} };
+    for(rational& x : result.x) x = 0;
+    std::array<std::size_t, M> pivot_column{};
+    std::size_t rank = 0;
+    for(std::size_t col = 0; col < N && rank < M; ++col)
     {
-        // find a column with a non-zero initial element and swap it into place
-        for(int j = i; j < M; ++j)
+        // find a row with a non-zero element and swap it into place
+        std::size_t row = rank;
+        while(row < M && a[row * N + col].num == 0) ++row;
+        if(row == M) continue;
+        for(std::size_t k = 0; k < N; ++k)
+        {
+            rational tmp = a[row * N + k];
+            a[row * N + k] = a[rank * N + k];
+            a[rank * N + k] = tmp;
+        }
+        rational tmp = b[row];
+        b[row] = b[rank];
+        b[rank] = tmp;
+        // eliminate the column from every other row
+        const rational pivot = a[rank * N + col];
+        for(std::size_t k = 0; k < N; ++k) a[rank * N + k] /= pivot;
+        b[rank] /= pivot;
+        for(std::size_t i = 0; i < M; ++i)
         {
-            if(matrix[j * N + i] != 0)
-            {
-                for(int k = i; k < N; ++k)
-                {
-                    swap(matrix[j * N + k], matrix[i * N + k]);
-                }
-                swap(vec[j], vec[i]);
-            }
+            const rational f = a[i * N + col];
+            if(i == rank || f.num == 0) continue;
+            for(std::size_t k = 0; k < N; ++k) a[i * N + k] -= f * a[rank * N + k];
+            b[i] -= f * b[rank];
         }
+        pivot_column[rank++] = col;
     }
+    for(std::size_t i = 0; i < M * N; ++i)
+        if(!a[i].valid()) { result.status = linear_solution<N>::overflow; return result; }
+    for(std::size_t i = 0; i < M; ++i)
+    {
+        if(!b[i].valid()) { result.status = linear_solution<N>::overflow; return result; }
+        if(i >= rank && b[i].num != 0) { result.status = linear_solution<N>::inconsistent; return result; }
+    }
+    for(std::size_t i = 0; i < rank; ++i) result.x[pivot_column[i]] = b[i];
+    return result;
 }
 
-template<class Unit, class N>
+template<class T, class U, class A, class B>
+struct solve_equivalences;
+template<class T, class U, class... A, class... B>
+struct solve_equivalences<T, U, mp11::mp_list<A...>, mp11::mp_list<B...>>
+{
+    using quotient = dimension_check<unit_divide<T, U>>;
+    using bases = mp11::mp_unique<mp11::mp_append<
+        typename dimension_bases<quotient>::type,
+        typename dimension_bases<dimension_check<unit_divide<A, B>>>::type...>>;
+    static constexpr std::size_t M = mp11::mp_size<bases>::value;
+    static constexpr std::size_t N = sizeof...(A);
+
+    static constexpr linear_solution<N> compute()
+    {
+        constexpr std::array<rational, M> columns[] = { dimension_vector<bases, dimension_check<unit_divide<A, B>>>::value()... };
+        std::array<rational, M * N> matrix;
+        for(std::size_t i = 0; i < M; ++i)
+            for(std::size_t j = 0; j < N; ++j)
+                matrix[i * N + j] = columns[j][i];
+        return ::boost::units2::detail::solve<M, N>(matrix, dimension_vector<bases, quotient>::value());
+    }
+    static constexpr linear_solution<N> solution = compute();
+
+    static_assert(solution.status != linear_solution<N>::overflow,
+        "Overflow while solving for the equivalences.");
+    static_assert(solution.status != linear_solution<N>::inconsistent,
+        "Cannot convert units with different dimensions, even using the given equivalences.");
 
-template<class Scale>
+    template<std::size_t I>
+    using exponent = std::ratio<solution.x[I].num, solution.x[I].den>;
+    template<class I>
+    using correction = unit_pow<unit_divide<mp11::mp_at<mp11::mp_list<B...>, I>, mp11::mp_at<mp11::mp_list<A...>, I>>, exponent<I::value>>;
+    // T/U with the equivalences applied.  This is always dimensionless.
+    using type = mp11::mp_fold<mp11::mp_transform<correction, mp11::mp_iota_c<N>>, unit_divide<T, U>, unit_multiply>;
+};
 
 }
 
-template<class T, class U, class... Xtra>
-double conversion_factor(T, U, Xtra...)
+/**
+ * Returns the factor that converts a value in T to a value in U,
+ * where T and U may have different dimensions as long as the
+ * difference can be made up by the given equivalences.  The
+ * equivalences are resolved entirely at compile time:
+ * \code
+ * constexpr double f = conversion_factor(si::radian / si::second, si::hertz, equivalent(si::radian, dimensionless()));
+ * \endcode
+ */
+template<class R = double, class T, class U, class A0, class B0, class... A, class... B,
+    class = detail::requires_unit<T>, class = detail::requires_unit<U>>
+constexpr R conversion_factor(T, U, equivalence<A0, B0>, equivalence<A, B>...)
 {
-    (T/U) = 5;
+    using reduced = typename detail::solve_equivalences<T, U, mp11::mp_list<A0, A...>, mp11::mp_list<B0, B...>>::type;
+    return ::boost::units2::conversion_factor<R>(reduced(), dimensionless());
 }
 
-conversion_factor(radians/second, hertz, radians==dimensionless);
+/**
+ * Converts q to Unit using the given equivalences.  S is as for
+ * quantity_cast: integers are converted exactly, and rounded by S,
+ * when the factor that the equivalences resolve to is rational.
+ * Otherwise the factor is applied in floating point and the result
+ * is truncated.  See conversion_factor.
+ */
+template<auto Unit, class S = void, auto Unit2, class T, class A0, class B0, class... A, class... B>
+constexpr quantity<Unit, T> quantity_cast(const quantity<Unit2, T>& q, equivalence<A0, B0>, equivalence<A, B>...)
+{
+    using reduced = typename detail::solve_equivalences<std::remove_cv_t<decltype(Unit2)>, std::remove_cv_t<decltype(Unit)>,
+        mp11::mp_list<A0, A...>, mp11::mp_list<B0, B...>>::type;
+    return quantity<Unit, T>::from_value(detail::convert_to<T, S>(reduced(), dimensionless(), q.value()));
+}
 
 }
 }
@@ -0,0 +1,483 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_CONVERSION_TABLE_HPP_INCLUDED
+#define BOOST_UNITS2_CONVERSION_TABLE_HPP_INCLUDED
+
+#include <boost/units2/unit.hpp>
+#include <boost/units2/absolute.hpp>
+#include <boost/units2/si.hpp>
+#include <boost/units2/fingerprint.hpp>
+#include <boost/units2/detail/rational.hpp>
+#include <boost/mp11/algorithm.hpp>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Conversions between units that are only identified at run time
+// by their fingerprints.  A conversion_table is built entirely at
+// compile time.  unit_registry collects tables at run time (usually
+// during static initialization) and never blocks readers.
+
+namespace boost {
+namespace units2 {
+namespace detail {
+
+// Open addressing, keyed by fingerprint.  Fingerprints are already
+// well mixed, so the low bits are used directly as the hash.
+struct fingerprint_slot {
+    std::uint64_t key = 0;
+    std::size_t value = 0;
+    bool used = false;
+};
+
+constexpr std::size_t fingerprint_table_capacity(std::size_t n)
+{
+    std::size_t result = 2;
+    while(result < 2 * n) result *= 2;
+    return result;
+}
+
+template<std::size_t N>
+constexpr std::size_t find_fingerprint_slot(const std::array<fingerprint_slot, N>& slots, std::uint64_t key)
+{
+    std::size_t i = static_cast<std::size_t>(key) & (N - 1);
+    while(slots[i].used && slots[i].key != key) i = (i + 1) & (N - 1);
+    return i;
+}
+
+// The key that groups units in a table.  Absolute units are kept
+// apart from relative units of the same dimension, since there is no
+// conversion between them.
+template<class T>
+using table_dimension = mp11::mp_if<is_absolute_unit<T>, absolute_unit<dimension_check<T>>, dimension_check<T>>;
+
+// The conversion from T to U, or 0 if they have different dimensions.
+// Only conversions between absolute units have an offset.
+template<class T, class U>
+constexpr affine_factors<double> table_conversion()
+{
+    if constexpr(!std::is_same<table_dimension<T>, table_dimension<U>>::value)
+        return { 0, 0 };
+    else if constexpr(is_absolute_unit<T>::value)
+        return ::boost::units2::affine_conversion<double>(T(), U());
+    else
+        return { ::boost::units2::conversion_factor(T(), U()), 0 };
+}
+
+// The conversion from T to the base units of its dimension.
+template<class T>
+constexpr affine_factors<double> base_conversion() { return ::boost::units2::detail::table_conversion<T, table_dimension<T>>(); }
+
+// The exact factor from T to U, or an invalid rational if there
+// is none, because the factor is irrational or has an offset.
+template<class T, class U>
+constexpr rational table_ratio()
+{
+    if constexpr(!std::is_same<table_dimension<T>, table_dimension<U>>::value || is_absolute_unit<T>::value)
+        return rational::overflow();
+    else if constexpr(!is_std_ratio<conversion_ratio<T, U>>::value)
+        return rational::overflow();
+    else
+        return rational(conversion_ratio<T, U>());
+}
+
+}
+
+/**
+ * Conversion factors between a fixed set of units, indexed by
+ * fingerprint.  Units are grouped by dimension, and each group
+ * has a dense square table of factors computed by conversion_factor
+ * at compile time.  Looking up a factor costs two probes of a small
+ * hash table and one array access.  A unit may be listed more than
+ * once under different names (e.g. hertz and becquerel).
+ *
+ * Absolute units (absolute.hpp) form groups of their own, and their
+ * conversions also have an offset, computed by affine_conversion.
+ * Use find_affine or affine_at for them.  find and factor_at only
+ * give the scale.
+ *
+ * The exact factors, for converting integers, are in ratios.  They
+ * are invalid where the factor is irrational or has an offset.
+ */
+template<auto... Units>
+class conversion_table {
+    using units = mp11::mp_list<std::remove_cv_t<decltype(Units)>...>;
+public:
+    static constexpr std::size_t size = sizeof...(Units);
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+    static constexpr std::array<std::uint64_t, size> fingerprints = { fingerprint_v<decltype(Units)>... };
+    /// The fingerprint of the dimension of each unit.  For absolute
+    /// units, this is the fingerprint of the absolute base unit.
+    static constexpr std::array<std::uint64_t, size> dimensions = {
+        fingerprint_v<detail::table_dimension<std::remove_cv_t<decltype(Units)>>>... };
+
+private:
+    template<std::size_t... I>
+    static constexpr bool check_collisions(std::index_sequence<I...>)
+    {
+        // Equal fingerprints must come from identical units.
+        constexpr bool same[] = { true, std::is_same<mp11::mp_at_c<units, I / size>, mp11::mp_at_c<units, I % size>>::value... };
+        for(std::size_t i = 0; i < size * size; ++i)
+            if(fingerprints[i / size] == fingerprints[i % size] && !same[i + 1]) return false;
+        return true;
+    }
+    // This also catches units that are defined with the same
+    // name in different namespaces, which are spelled the same.
+    static_assert(check_collisions(std::make_index_sequence<size * size>()),
+        "Two different units have the same fingerprint.  Units defined with the same name in different namespaces cannot be told apart.");
+
+    template<std::size_t... I>
+    static constexpr std::array<affine_factors<double>, size * size> make_matrix(std::index_sequence<I...>)
+    {
+        return { detail::table_conversion<mp11::mp_at_c<units, I / size>, mp11::mp_at_c<units, I % size>>()... };
+    }
+
+    // Layout of the per dimension tables.
+    struct layout_type {
+        std::array<std::size_t, size> group_size{};   // size of the group of each unit
+        std::array<std::size_t, size> position{};     // index within its group
+        std::array<std::size_t, size> offset{};       // start of the group's table
+        std::size_t total = 0;
+    };
+    static constexpr layout_type make_layout()
+    {
+        layout_type result;
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            std::size_t first = 0;
+            while(dimensions[first] != dimensions[i]) ++first;
+            if(first == i)
+            {
+                std::size_t n = 0;
+                for(std::size_t j = i; j < size; ++j)
+                    if(dimensions[j] == dimensions[i]) result.position[j] = n++;
+                for(std::size_t j = i; j < size; ++j)
+                    if(dimensions[j] == dimensions[i]) { result.group_size[j] = n; result.offset[j] = result.total; }
+                result.total += n * n;
+            }
+        }
+        return result;
+    }
+    static constexpr layout_type layout = make_layout();
+
+    static constexpr std::array<affine_factors<double>, size * size> matrix = make_matrix(std::make_index_sequence<size * size>());
+
+    template<std::size_t... I>
+    static constexpr std::array<detail::rational, layout.total + 1> make_ratios(std::index_sequence<I...>)
+    {
+        constexpr detail::rational all[] = {
+            detail::rational(), detail::table_ratio<mp11::mp_at_c<units, I / size>, mp11::mp_at_c<units, I % size>>()... };
+        std::array<detail::rational, layout.total + 1> result{};
+        for(std::size_t i = 0; i < size; ++i)
+            for(std::size_t j = 0; j < size; ++j)
+                if(dimensions[i] == dimensions[j])
+                    result[layout.offset[i] + layout.position[i] * layout.group_size[i] + layout.position[j]] = all[i * size + j + 1];
+        return result;
+    }
+
+    // Member is &affine_factors<double>::scale or ::offset.
+    template<double affine_factors<double>::*Member>
+    static constexpr std::array<double, layout.total + 1> make_factors()
+    {
+        std::array<double, layout.total + 1> result{};
+        for(std::size_t i = 0; i < size; ++i)
+            for(std::size_t j = 0; j < size; ++j)
+                if(dimensions[i] == dimensions[j])
+                    result[layout.offset[i] + layout.position[i] * layout.group_size[i] + layout.position[j]] = matrix[i * size + j].*Member;
+        return result;
+    }
+
+    static constexpr std::array<detail::fingerprint_slot, detail::fingerprint_table_capacity(size)> make_slots()
+    {
+        std::array<detail::fingerprint_slot, detail::fingerprint_table_capacity(size)> result{};
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            std::size_t slot = detail::find_fingerprint_slot(result, fingerprints[i]);
+            if(!result[slot].used) result[slot] = detail::fingerprint_slot{ fingerprints[i], i, true };
+        }
+        return result;
+    }
+    static constexpr auto slots = make_slots();
+
+public:
+    /// The dense tables, one per dimension, concatenated.
+    static constexpr std::array<double, layout.total + 1> factors = make_factors<&affine_factors<double>::scale>();
+    /// The offsets, in the same layout as factors.  These
+    /// are 0 except for conversions between absolute units.
+    static constexpr std::array<double, layout.total + 1> offsets = make_factors<&affine_factors<double>::offset>();
+    /// The factor from each unit to the base units of its dimension.
+    static constexpr std::array<double, size> base_factors = { detail::base_conversion<std::remove_cv_t<decltype(Units)>>().scale... };
+    /// The offset from each unit to the base units of its dimension.
+    static constexpr std::array<double, size> base_offsets = { detail::base_conversion<std::remove_cv_t<decltype(Units)>>().offset... };
+    /// The exact factors, in the same layout as factors.
+    static constexpr std::array<detail::rational, layout.total + 1> ratios = make_ratios(std::make_index_sequence<size * size>());
+    /// The exact factor from each unit to the base units of its dimension.
+    static constexpr std::array<detail::rational, size> base_ratios = {
+        detail::table_ratio<std::remove_cv_t<decltype(Units)>, detail::table_dimension<std::remove_cv_t<decltype(Units)>>>()... };
+
+    /// Returns the index of the unit with fingerprint fp, or npos.
+    static constexpr std::size_t index_of(std::uint64_t fp) noexcept
+    {
+        const detail::fingerprint_slot& slot = slots[detail::find_fingerprint_slot(slots, fp)];
+        return slot.used? slot.value : npos;
+    }
+    static constexpr bool contains(std::uint64_t fp) noexcept { return index_of(fp) != npos; }
+
+    /// The dense table of the dimension of the i-th unit, which
+    /// is a group_size(i) by group_size(i) row major matrix.
+    static constexpr const double* group_factors(std::size_t i) noexcept { return &factors[layout.offset[i]]; }
+    /// The offsets of the same group as group_factors(i).
+    static constexpr const double* group_offsets(std::size_t i) noexcept { return &offsets[layout.offset[i]]; }
+    /// The exact factors of the same group as group_factors(i).
+    static constexpr const detail::rational* group_ratios(std::size_t i) noexcept { return &ratios[layout.offset[i]]; }
+    static constexpr std::size_t group_size(std::size_t i) noexcept { return layout.group_size[i]; }
+    /// The row and column of the i-th unit in group_factors(i).
+    static constexpr std::size_t group_position(std::size_t i) noexcept { return layout.position[i]; }
+
+    /// The factor that converts from the i-th unit to the j-th unit.
+    /// \pre dimensions[i] == dimensions[j]
+    static constexpr double factor_at(std::size_t i, std::size_t j) noexcept
+    {
+        return factors[layout.offset[i] + layout.position[i] * layout.group_size[i] + layout.position[j]];
+    }
+
+    /// The conversion from the i-th unit to the j-th unit.
+    /// \pre dimensions[i] == dimensions[j]
+    static constexpr affine_factors<double> affine_at(std::size_t i, std::size_t j) noexcept
+    {
+        const std::size_t k = layout.offset[i] + layout.position[i] * layout.group_size[i] + layout.position[j];
+        return { factors[k], offsets[k] };
+    }
+
+    /// The exact factor that converts from the i-th unit to the j-th
+    /// unit, which is invalid if there is none.
+    /// \pre dimensions[i] == dimensions[j]
+    static constexpr detail::rational ratio_at(std::size_t i, std::size_t j) noexcept
+    {
+        return ratios[layout.offset[i] + layout.position[i] * layout.group_size[i] + layout.position[j]];
+    }
+
+    /// Returns the exact factor that converts from to to, or nullopt if
+    /// either is not in the table, they have different dimensions, or
+    /// the factor is irrational or has an offset.
+    static constexpr std::optional<detail::rational> find_ratio(std::uint64_t from, std::uint64_t to) noexcept
+    {
+        std::size_t i = index_of(from), j = index_of(to);
+        if(i == npos || j == npos || dimensions[i] != dimensions[j] || !ratio_at(i, j).valid()) return std::nullopt;
+        return ratio_at(i, j);
+    }
+    /// Returns the conversion from from to to, or nullopt if either
+    /// is not in the table, or they have different dimensions.
+    static constexpr std::optional<affine_factors<double>> find_affine(std::uint64_t from, std::uint64_t to) noexcept
+    {
+        std::size_t i = index_of(from), j = index_of(to);
+        if(i == npos || j == npos || dimensions[i] != dimensions[j]) return std::nullopt;
+        return affine_at(i, j);
+    }
+    /// Returns the factor that converts from to to, or nullopt if
+    /// either is not in the table, they have different dimensions, or
+    /// the conversion has an offset.
+    static constexpr std::optional<double> find(std::uint64_t from, std::uint64_t to) noexcept
+    {
+        std::optional<affine_factors<double>> result = find_affine(from, to);
+        if(!result || result->offset != 0) return std::nullopt;
+        return result->scale;
+    }
+    /// As find, but throws std::out_of_range if there is no such conversion.
+    static double factor(std::uint64_t from, std::uint64_t to)
+    {
+        if(std::optional<double> result = find(from, to)) return *result;
+        throw std::out_of_range("boost::units2::conversion_table: no conversion between these units");
+    }
+};
+
+/// The units in si.hpp.
+using si_conversion_table = conversion_table<
+    si::meter, si::gram, si::kilogram, si::second, si::kelvin, si::mole, si::ampere, si::candela,
+    si::radian, si::steradian, si::hertz, si::newton, si::pascal, si::joule, si::watt, si::couloumb,
+    si::volt, si::farad, si::ohm, si::siemens, si::weber, si::tesla, si::henry, si::lumen, si::lux,
+    si::becquerel, si::gray, si::sievert, si::katal>;
+
+/**
+ * A process wide collection of conversion_tables.  Tables are added
+ * at run time, typically during static initialization:
+ * \code
+ * static const bool registered = (unit_registry::global().add(si_conversion_table()), true);
+ * \endcode
+ * Lookups never take a lock.  Each add publishes a new immutable
+ * index with an atomic store, and readers see either the old or the
+ * new index.  Old indexes are kept until the registry is destroyed,
+ * so readers can never observe a dangling pointer.
+ *
+ * Units are identified only by their fingerprints, so a unit of another
+ * table that has the same fingerprint as a registered unit, such as a
+ * unit with the same name in a different namespace, is taken to be
+ * that unit.  See fingerprint.hpp.
+ *
+ * Two units from the same table are converted with that table's
+ * exact factor.  Units of the same dimension from different tables
+ * are converted through the base units of the dimension.  As in
+ * conversion_table, conversions between absolute units have an
+ * offset, and are found by find_affine, and exact factors are found
+ * by find_ratio.
+ */
+class unit_registry {
+public:
+    unit_registry() : current_(nullptr) {}
+    unit_registry(const unit_registry&) = delete;
+    unit_registry& operator=(const unit_registry&) = delete;
+
+    static unit_registry& global()
+    {
+        static unit_registry result;
+        return result;
+    }
+
+    /// Adds all the units of a table.  Units that are already
+    /// registered keep their existing entry.  If every unit is
+    /// already registered, nothing is allocated, so adding the same
+    /// table many times is cheap.
+    template<auto... Units>
+    void add(conversion_table<Units...>)
+    {
+        using table = conversion_table<Units...>;
+        std::lock_guard<std::mutex> lock(mutex_);
+        const index* old = current_.load(std::memory_order_relaxed);
+        std::size_t i = 0;
+        while(i < table::size && old && old->find(table::fingerprints[i])) ++i;
+        if(i == table::size) return;
+        std::vector<entry> entries = old? old->entries : std::vector<entry>();
+        for(; i < table::size; ++i)
+        {
+            // Skip units that are registered or listed earlier in the table.
+            if((old && old->find(table::fingerprints[i])) || table::index_of(table::fingerprints[i]) != i) continue;
+            entries.push_back(entry{ table::fingerprints[i], table::dimensions[i], table::base_factors[i], table::base_offsets[i],
+                table::base_ratios[i], table::group_factors(i), table::group_offsets(i), table::group_ratios(i),
+                table::group_size(i), table::group_position(i) });
+        }
+        indexes_.push_back(std::make_unique<index>(std::move(entries)));
+        current_.store(indexes_.back().get(), std::memory_order_release);
+    }
+
+    /// The number of registered units.
+    std::size_t size() const noexcept
+    {
+        const index* current = current_.load(std::memory_order_acquire);
+        return current? current->entries.size() : 0;
+    }
+    bool contains(std::uint64_t fp) const noexcept
+    {
+        const index* current = current_.load(std::memory_order_acquire);
+        return current && current->find(fp);
+    }
+    /// Returns the conversion from from to to, or nullopt if either
+    /// is not registered, or they have different dimensions.
+    std::optional<affine_factors<double>> find_affine(std::uint64_t from, std::uint64_t to) const noexcept
+    {
+        const index* current = current_.load(std::memory_order_acquire);
+        if(!current) return std::nullopt;
+        const entry* f = current->find(from);
+        const entry* t = current->find(to);
+        if(!f || !t || f->dimension != t->dimension) return std::nullopt;
+        if(f->group == t->group)
+        {
+            const std::size_t k = f->position * f->group_size + t->position;
+            return affine_factors<double>{ f->group[k], f->group_offsets[k] };
+        }
+        // x in from is x * f->base_factor + f->base_offset in the base
+        // units, and y in the base units is (y - t->base_offset) / t->base_factor in to.
+        return affine_factors<double>{ f->base_factor / t->base_factor, (f->base_offset - t->base_offset) / t->base_factor };
+    }
+    /// Returns the exact factor that converts from to to, or nullopt if
+    /// either is not registered, they have different dimensions, or the
+    /// factor is irrational, overflows, or has an offset.
+    std::optional<detail::rational> find_ratio(std::uint64_t from, std::uint64_t to) const noexcept
+    {
+        const index* current = current_.load(std::memory_order_acquire);
+        if(!current) return std::nullopt;
+        const entry* f = current->find(from);
+        const entry* t = current->find(to);
+        if(!f || !t || f->dimension != t->dimension) return std::nullopt;
+        detail::rational result = f->group == t->group? f->group_ratios[f->position * f->group_size + t->position] :
+            f->base_ratio / t->base_ratio;
+        if(!result.valid()) return std::nullopt;
+        return result;
+    }
+    /// Returns the factor that converts from to to, or nullopt if either
+    /// is not registered, they have different dimensions, or the
+    /// conversion has an offset.
+    std::optional<double> find(std::uint64_t from, std::uint64_t to) const noexcept
+    {
+        std::optional<affine_factors<double>> result = find_affine(from, to);
+        if(!result || result->offset != 0) return std::nullopt;
+        return result->scale;
+    }
+    /// As find, but throws std::out_of_range if there is no such conversion.
+    double factor(std::uint64_t from, std::uint64_t to) const
+    {
+        if(std::optional<double> result = find(from, to)) return *result;
+        throw std::out_of_range("boost::units2::unit_registry: no conversion between these units");
+    }
+private:
+    struct entry {
+        std::uint64_t fingerprint;
+        std::uint64_t dimension;
+        double base_factor;
+        double base_offset;
+        detail::rational base_ratio;
+        const double* group;        // the dense table of the unit's table and dimension
+        const double* group_offsets;
+        const detail::rational* group_ratios;
+        std::size_t group_size;
+        std::size_t position;
+    };
+    // An immutable hash table of entries.
+    struct index {
+        explicit index(std::vector<entry>&& e)
+          : entries(std::move(e)),
+            slots(detail::fingerprint_table_capacity(entries.size()), npos)
+        {
+            for(std::size_t i = 0; i < entries.size(); ++i)
+            {
+                std::size_t& slot = slots[probe(entries[i].fingerprint)];
+                if(slot == npos) slot = i;
+            }
+        }
+        std::size_t probe(std::uint64_t fp) const noexcept
+        {
+            const std::size_t mask = slots.size() - 1;
+            std::size_t i = static_cast<std::size_t>(fp) & mask;
+            while(slots[i] != npos && entries[slots[i]].fingerprint != fp) i = (i + 1) & mask;
+            return i;
+        }
+        const entry* find(std::uint64_t fp) const noexcept
+        {
+            std::size_t slot = slots[probe(fp)];
+            return slot == npos? nullptr : &entries[slot];
+        }
+        std::vector<entry> entries;
+        std::vector<std::size_t> slots;
+    };
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::atomic<const index*> current_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<index>> indexes_;
+};
+
+}
+}
+
+#endif
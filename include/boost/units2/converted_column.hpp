@@ -0,0 +1,169 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_CONVERTED_COLUMN_HPP_INCLUDED
+#define BOOST_UNITS2_CONVERTED_COLUMN_HPP_INCLUDED
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/quantity_span.hpp>
+#include <boost/units2/batch.hpp>
+#include <boost/units2/detail/integer_convert.hpp>
+#include <boost/units2/detail/rational.hpp>
+#include <boost/assert.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Views of stored values that are converted as they are read.
+// Shared by the columnar file format and the wire format.
+
+namespace boost {
+namespace units2 {
+
+/// The type of the values in a column.
+enum class column_value_type : std::uint32_t {
+    int8 = 1, int16, int32, int64,
+    uint8, uint16, uint32, uint64,
+    float32, float64
+};
+
+namespace detail {
+
+template<class T>
+struct column_value_type_of;
+
+#define BOOST_UNITS2_COLUMN_VALUE_TYPE(T, e) \
+template<> struct column_value_type_of<T> { static constexpr column_value_type value = column_value_type::e; }
+
+BOOST_UNITS2_COLUMN_VALUE_TYPE(std::int8_t, int8);
+BOOST_UNITS2_COLUMN_VALUE_TYPE(std::int16_t, int16);
+BOOST_UNITS2_COLUMN_VALUE_TYPE(std::int32_t, int32);
+BOOST_UNITS2_COLUMN_VALUE_TYPE(std::int64_t, int64);
+BOOST_UNITS2_COLUMN_VALUE_TYPE(std::uint8_t, uint8);
+BOOST_UNITS2_COLUMN_VALUE_TYPE(std::uint16_t, uint16);
+BOOST_UNITS2_COLUMN_VALUE_TYPE(std::uint32_t, uint32);
+BOOST_UNITS2_COLUMN_VALUE_TYPE(std::uint64_t, uint64);
+BOOST_UNITS2_COLUMN_VALUE_TYPE(float, float32);
+BOOST_UNITS2_COLUMN_VALUE_TYPE(double, float64);
+
+#undef BOOST_UNITS2_COLUMN_VALUE_TYPE
+
+}
+
+/**
+ * A column whose stored unit differs from the requested unit.  The
+ * stored values are converted as they are read, so that nothing is
+ * converted unless it is used.  Conversions between absolute units
+ * (absolute.hpp) also add an offset.
+ *
+ * Integers are never converted through a floating point factor.  An
+ * integer column takes an exact rational factor instead, and converts
+ * with integer arithmetic, rounding toward zero, as quantity_cast does.
+ * Conversions of integers that have an offset or an irrational factor
+ * are rejected by the functions that create columns.
+ */
+template<auto Unit, class T>
+class converted_column {
+public:
+    using value_type = quantity<Unit, T>;
+    using size_type = std::size_t;
+    using scale_type = detail::choose_scale_type<void, T>;
+
+    converted_column() = default;
+    /// data is an array of n values, which become values in Unit
+    /// when multiplied by factor, and offset is added.
+    converted_column(const T* data, size_type n, scale_type factor, scale_type offset = 0) noexcept
+      : data_(data), size_(n), factor_(factor), offset_(offset)
+    {
+        static_assert(!detail::is_integer_value<T>, "Integer columns take an exact rational factor.");
+    }
+    /// data is an array of n values, which become values in Unit
+    /// when multiplied by factor.
+    /// \pre factor.valid() && factor.num > 0
+    converted_column(const T* data, size_type n, detail::rational factor) noexcept
+      : data_(data), size_(n), factor_(factor.value<scale_type>()), num_(factor.num), den_(factor.den)
+    {
+        BOOST_ASSERT(factor.valid() && factor.num > 0);
+    }
+
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    /// The factor that converts a stored value to Unit.  For integer
+    /// columns, this is only an approximation of the exact factor,
+    /// numerator() / denominator().
+    scale_type factor() const noexcept { return factor_; }
+    /// The offset that is added after applying factor().
+    scale_type offset() const noexcept { return offset_; }
+    std::intmax_t numerator() const noexcept { return num_; }
+    std::intmax_t denominator() const noexcept { return den_; }
+    /// Returns true if the stored values are already in Unit.
+    bool is_identity() const noexcept { return num_ == den_ && factor_ == 1 && offset_ == 0; }
+    /// The values as stored.
+    std::span<const T> stored_values() const noexcept { return std::span<const T>(data_, size_); }
+
+    value_type operator[](size_type i) const
+    {
+        BOOST_ASSERT(i < size_);
+        if constexpr(detail::is_integer_value<T>)
+            return value_type::from_value(detail::integer_convert<T>(num_, den_, data_[i]).value);
+        else if(offset_ == 0) return value_type::from_value(static_cast<T>(data_[i] * factor_));
+        else return value_type::from_value(static_cast<T>(data_[i] * factor_ + offset_));
+    }
+
+    /// Converts out.size() elements, starting at offset, into out.
+    void read(size_type offset, std::span<value_type> out) const
+    {
+        BOOST_ASSERT(offset + out.size() <= size_);
+        // The stored values are viewed as Unit only to reuse the batch kernel.
+        const value_type* in = ::boost::units2::as_quantities<Unit>(data_ + offset, out.size()).data();
+        if(is_identity())
+            std::copy(in, in + out.size(), out.data());
+        else if constexpr(detail::is_integer_value<T>)
+            detail::transform_blocks(in, out.data(), out.size(),
+                [num = num_, den = den_](const T& x) { return detail::integer_convert<T>(num, den, x).value; });
+        else if(offset_ == 0)
+            detail::transform_blocks(in, out.data(), out.size(), [factor = factor_](const T& x) { return x * factor; });
+        else
+            detail::transform_blocks(in, out.data(), out.size(),
+                [factor = factor_, offset = offset_](const T& x) { return x * factor + offset; });
+    }
+
+    /**
+     * Calls f with consecutive chunks of the column, each a
+     * std::span<const value_type> of at most buffer.size() elements.
+     * Chunks are converted into buffer, unless no conversion is
+     * needed, in which case f sees the stored data directly.
+     */
+    template<class F>
+    void for_each_chunk(std::span<value_type> buffer, F f) const
+    {
+        if(is_identity())
+        {
+            f(::boost::units2::as_quantities<Unit>(data_, size_));
+            return;
+        }
+        BOOST_ASSERT(!buffer.empty() || size_ == 0);
+        for(size_type i = 0; i < size_; i += buffer.size())
+        {
+            std::span<value_type> chunk = buffer.first(std::min(buffer.size(), size_ - i));
+            read(i, chunk);
+            f(std::span<const value_type>(chunk));
+        }
+    }
+private:
+    const T* data_ = nullptr;
+    size_type size_ = 0;
+    scale_type factor_ = 1;
+    scale_type offset_ = 0;
+    std::intmax_t num_ = 1;
+    std::intmax_t den_ = 1;
+};
+
+}
+}
+
+#endif
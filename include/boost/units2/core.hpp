@@ -0,0 +1,20 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_CORE_HPP_INCLUDED
+#define BOOST_UNITS2_CORE_HPP_INCLUDED
+
+// The unit algebra, the base dimensions and quantity, without any
+// particular system of units.  This only depends on mp11's list and
+// utility headers and a few standard headers.  Include si.hpp (or
+// import boost.units2, see module/) for the SI units.
+
+#include <boost/units2/unit.hpp>
+#include <boost/units2/def.hpp>
+#include <boost/units2/dimensions.hpp>
+#include <boost/units2/quantity.hpp>
+
+#endif
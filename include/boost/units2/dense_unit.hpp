@@ -0,0 +1,455 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_DENSE_UNIT_HPP_INCLUDED
+#define BOOST_UNITS2_DENSE_UNIT_HPP_INCLUDED
+
+#include <boost/units2/unit.hpp>
+#include <boost/units2/base_dimension.hpp>
+#include <boost/units2/detail/rational.hpp>
+#include <boost/mp11/algorithm.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <ratio>
+#include <type_traits>
+#include <utility>
+
+// An alternative normalized form for units, in which the unit is
+// a value instead of a list of types.  A dense_unit holds
+//   - the exponent of each base dimension, indexed by base_dimension, and
+//   - the scale relative to the base units, factored into primes.
+// Multiplying, dividing and raising to a power are constexpr arithmetic
+// on these values, so they cost the same regardless of how many
+// dimensions are involved.
+//
+// Every dense_unit is normalized: the exponents are rationals in lowest
+// terms, and the scale is a list of distinct primes in increasing order,
+// each with a non-zero exponent.  Since prime factorization is unique,
+// two dense_units are the same type iff they have the same dimension
+// and the same scale, no matter how they were computed.
+//
+// Only the dimensions in dimensions.hpp and scales that are std::ratios
+// can be represented.  For conversions, a dense_unit behaves like the
+// equivalent compound_unit.
+
+namespace boost {
+namespace units2 {
+
+namespace detail {
+
+struct prime_power {
+    std::intmax_t prime = 0;
+    rational exponent;
+};
+
+/// The maximum number of distinct primes in the scale of a dense_unit.
+inline constexpr std::size_t dense_scale_capacity = 16;
+
+}
+
+/**
+ * The dimension of a dense_unit: the exponent of each base dimension.
+ */
+struct dense_dimension {
+    detail::dimension_exponents exponents;
+
+    // Not an aggregate, so that the exponents are always
+    // default-initialized.  See the note on dimension_exponents.
+    constexpr dense_dimension() {}
+    constexpr explicit dense_dimension(const detail::dimension_exponents& e) : exponents(e) {}
+
+    constexpr bool valid() const
+    {
+        for(const detail::rational& e : exponents)
+            if(!e.valid()) return false;
+        return true;
+    }
+    constexpr bool is_dimensionless() const
+    {
+        for(const detail::rational& e : exponents)
+            if(e.num != 0) return false;
+        return true;
+    }
+
+    friend constexpr dense_dimension operator*(const dense_dimension& lhs, const dense_dimension& rhs)
+    {
+        dense_dimension result;
+        for(std::size_t i = 0; i < base_dimension_count; ++i)
+            result.exponents[i] = lhs.exponents[i] + rhs.exponents[i];
+        return result;
+    }
+    friend constexpr dense_dimension operator/(const dense_dimension& lhs, const dense_dimension& rhs)
+    {
+        dense_dimension result;
+        for(std::size_t i = 0; i < base_dimension_count; ++i)
+            result.exponents[i] = lhs.exponents[i] - rhs.exponents[i];
+        return result;
+    }
+    friend constexpr dense_dimension pow(const dense_dimension& d, const detail::rational& r)
+    {
+        dense_dimension result;
+        for(std::size_t i = 0; i < base_dimension_count; ++i)
+            result.exponents[i] = d.exponents[i] * r;
+        return result;
+    }
+    friend constexpr bool operator==(const dense_dimension&, const dense_dimension&) = default;
+};
+
+/**
+ * The scale of a dense_unit: the product of factors[i].prime
+ * raised to factors[i].exponent, for i < size.
+ */
+struct dense_scale {
+    std::array<detail::prime_power, detail::dense_scale_capacity> factors;
+    /// Greater than the capacity if there were too many primes.
+    std::size_t size = 0;
+
+    constexpr dense_scale() {}
+
+    /// n/d, which must be positive.
+    static constexpr dense_scale from_ratio(std::intmax_t n, std::intmax_t d);
+
+    constexpr bool valid() const
+    {
+        if(size > detail::dense_scale_capacity) return false;
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            if(!factors[i].exponent.valid() || factors[i].exponent.num == 0) return false;
+            if(factors[i].prime < 2 || (i > 0 && factors[i].prime <= factors[i - 1].prime)) return false;
+        }
+        for(std::size_t i = size; i < detail::dense_scale_capacity; ++i)
+            if(factors[i].prime != 0 || !(factors[i].exponent == 0)) return false;
+        return true;
+    }
+    constexpr bool is_one() const { return size == 0; }
+
+    /// Multiplies by p^e, where p is prime.
+    constexpr void multiply_prime(std::intmax_t p, const detail::rational& e)
+    {
+        if(size > detail::dense_scale_capacity) return;
+        std::size_t i = 0;
+        while(i < size && factors[i].prime < p) ++i;
+        if(i < size && factors[i].prime == p)
+        {
+            factors[i].exponent += e;
+            if(factors[i].exponent.valid() && factors[i].exponent.num == 0)
+            {
+                for(; i + 1 < size; ++i) factors[i] = factors[i + 1];
+                factors[i].prime = 0;
+                factors[i].exponent = 0;
+                --size;
+            }
+        }
+        else if(size == detail::dense_scale_capacity)
+            size = detail::dense_scale_capacity + 1;
+        else
+        {
+            for(std::size_t j = size; j > i; --j) factors[j] = factors[j - 1];
+            factors[i].prime = p;
+            factors[i].exponent = e;
+            ++size;
+        }
+    }
+
+    friend constexpr dense_scale operator*(const dense_scale& lhs, const dense_scale& rhs)
+    {
+        dense_scale result = lhs;
+        if(rhs.size > detail::dense_scale_capacity) result.size = rhs.size;
+        for(std::size_t i = 0; i < rhs.size && i < detail::dense_scale_capacity; ++i)
+            result.multiply_prime(rhs.factors[i].prime, rhs.factors[i].exponent);
+        return result;
+    }
+    friend constexpr dense_scale operator/(const dense_scale& lhs, const dense_scale& rhs)
+    {
+        return lhs * pow(rhs, -1);
+    }
+    friend constexpr dense_scale pow(const dense_scale& s, const detail::rational& r)
+    {
+        if(r.valid() && r.num == 0) return dense_scale();
+        dense_scale result = s;
+        for(std::size_t i = 0; i < s.size && i < detail::dense_scale_capacity; ++i)
+            result.factors[i].exponent *= r;
+        return result;
+    }
+    friend constexpr bool operator==(const dense_scale& lhs, const dense_scale& rhs)
+    {
+        if(lhs.size != rhs.size) return false;
+        for(std::size_t i = 0; i < lhs.size && i < detail::dense_scale_capacity; ++i)
+            if(lhs.factors[i].prime != rhs.factors[i].prime || !(lhs.factors[i].exponent == rhs.factors[i].exponent))
+                return false;
+        return true;
+    }
+};
+
+namespace detail {
+
+// Prime factorization at compile time.  Small factors are found by
+// trial division.  What is left is split by Pollard's rho algorithm,
+// using a deterministic Miller-Rabin test to recognize primes.
+
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 uint128_type;
+constexpr std::uint64_t mul_mod(std::uint64_t a, std::uint64_t b, std::uint64_t m)
+{
+    return static_cast<std::uint64_t>(static_cast<uint128_type>(a) * b % m);
+}
+#else
+// precondition: m < 2^63, so that the sums cannot wrap.
+constexpr std::uint64_t mul_mod(std::uint64_t a, std::uint64_t b, std::uint64_t m)
+{
+    std::uint64_t result = 0;
+    a %= m;
+    for(; b != 0; b >>= 1)
+    {
+        if(b & 1) result = (result + a) % m;
+        a = (a + a) % m;
+    }
+    return result;
+}
+#endif
+
+constexpr std::uint64_t pow_mod(std::uint64_t base, std::uint64_t exponent, std::uint64_t m)
+{
+    std::uint64_t result = 1;
+    base %= m;
+    for(; exponent != 0; exponent >>= 1)
+    {
+        if(exponent & 1) result = ::boost::units2::detail::mul_mod(result, base, m);
+        base = ::boost::units2::detail::mul_mod(base, base, m);
+    }
+    return result;
+}
+
+// These bases are sufficient for every n < 2^64.
+inline constexpr std::uint64_t miller_rabin_bases[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+
+constexpr bool is_prime(std::uint64_t n)
+{
+    if(n < 2) return false;
+    for(std::uint64_t p : miller_rabin_bases)
+        if(n % p == 0) return n == p;
+    std::uint64_t d = n - 1;
+    int s = 0;
+    while(d % 2 == 0) { d /= 2; ++s; }
+    for(std::uint64_t a : miller_rabin_bases)
+    {
+        std::uint64_t x = ::boost::units2::detail::pow_mod(a, d, n);
+        if(x == 1 || x == n - 1) continue;
+        bool composite = true;
+        for(int r = 1; r < s && composite; ++r)
+        {
+            x = ::boost::units2::detail::mul_mod(x, x, n);
+            if(x == n - 1) composite = false;
+        }
+        if(composite) return false;
+    }
+    return true;
+}
+
+// Returns a non-trivial divisor of n, using Brent's variant of
+// Pollard's rho, which only takes a gcd once per batch of steps.
+// precondition: n is odd and composite.
+constexpr std::uint64_t find_divisor(std::uint64_t n)
+{
+    constexpr std::uint64_t batch = 128;
+    for(std::uint64_t c = 1; ; ++c)
+    {
+        auto step = [=](std::uint64_t v) { return (::boost::units2::detail::mul_mod(v, v, n) + c) % n; };
+        std::uint64_t y = 2, x = 2, saved = 2, q = 1, d = 1;
+        for(std::uint64_t r = 1; d == 1; r *= 2)
+        {
+            x = y;
+            for(std::uint64_t i = 0; i < r; ++i) y = step(y);
+            for(std::uint64_t k = 0; k < r && d == 1; k += batch)
+            {
+                saved = y;
+                for(std::uint64_t i = 0; i < batch && i < r - k; ++i)
+                {
+                    y = step(y);
+                    q = ::boost::units2::detail::mul_mod(q, x > y? x - y : y - x, n);
+                }
+                d = std::gcd(q, n);
+            }
+        }
+        if(d == n)
+        {
+            // The batch overshot.  Retrace it one step at a time.
+            do
+            {
+                saved = step(saved);
+                d = std::gcd(x > saved? x - saved : saved - x, n);
+            } while(d == 1);
+        }
+        if(d != n) return d;
+    }
+}
+
+// Multiplies out by n^e, where n has no factors below 1000.
+constexpr void multiply_large_factors(dense_scale& out, std::uint64_t n, const rational& e)
+{
+    if(n == 1) return;
+    if(::boost::units2::detail::is_prime(n))
+    {
+        out.multiply_prime(static_cast<std::intmax_t>(n), e);
+        return;
+    }
+    const std::uint64_t d = ::boost::units2::detail::find_divisor(n);
+    ::boost::units2::detail::multiply_large_factors(out, d, e);
+    ::boost::units2::detail::multiply_large_factors(out, n / d, e);
+}
+
+// Multiplies out by n^e.
+constexpr void multiply_factors(dense_scale& out, std::uint64_t n, const rational& e)
+{
+    std::uint64_t p = 2;
+    for(; p < 1000 && p * p <= n; p += (p == 2? 1 : 2))
+        while(n % p == 0) { out.multiply_prime(static_cast<std::intmax_t>(p), e); n /= p; }
+    if(p * p > n)
+    {
+        if(n != 1) out.multiply_prime(static_cast<std::intmax_t>(n), e);
+    }
+    else
+        ::boost::units2::detail::multiply_large_factors(out, n, e);
+}
+
+}
+
+constexpr dense_scale dense_scale::from_ratio(std::intmax_t n, std::intmax_t d)
+{
+    dense_scale result;
+    if(n <= 0 || d <= 0)
+    {
+        // Not representable.  Mark the result as invalid.
+        result.size = detail::dense_scale_capacity + 1;
+        return result;
+    }
+    ::boost::units2::detail::multiply_factors(result, static_cast<std::uint64_t>(n), 1);
+    ::boost::units2::detail::multiply_factors(result, static_cast<std::uint64_t>(d), -1);
+    return result;
+}
+
+/**
+ * A unit represented by its dimension and scale as values.
+ * Use to_dense to create one from any other unit whose
+ * dimensions are all in dimensions.hpp.
+ *
+ * \pre S is normalized.  The functions and operators that
+ * create dense_units always normalize the scale.
+ */
+template<dense_dimension D, dense_scale S = dense_scale()>
+struct dense_unit;
+
+namespace detail {
+
+// The same unit as a compound_unit of the base dimensions and
+// of dimensionless units scaled by each prime.
+// Lazy only exists to delay the instantiation.
+template<dense_dimension D, dense_scale S, class Lazy = void>
+struct dense_expand_impl
+{
+    template<std::size_t I, bool Zero = (D.exponents[I].num == 0)>
+    struct dimension_factor {
+        using type = compound_unit<dim<mp11::mp_at_c<base_dimension_types, I>,
+            std::ratio<D.exponents[I].num, D.exponents[I].den>>>;
+    };
+    template<std::size_t I>
+    struct dimension_factor<I, true> { using type = compound_unit<>; };
+
+    template<std::size_t K>
+    using scale_factor = compound_unit<dim<scaled_unit<compound_unit<>, std::ratio<S.factors[K].prime>>,
+        std::ratio<S.factors[K].exponent.num, S.factors[K].exponent.den>>>;
+
+    template<std::size_t... I, std::size_t... K>
+    static simplify_unit<merge_all<unit_compare_impl, compound_unit, typename dimension_factor<I>::type..., scale_factor<K>...>>
+        make(std::index_sequence<I...>, std::index_sequence<K...>);
+
+    using type = decltype(make(std::make_index_sequence<base_dimension_count>(), std::make_index_sequence<S.size>()));
+};
+template<dense_dimension D, dense_scale S, class Lazy = void>
+using dense_expand = typename dense_expand_impl<D, S, Lazy>::type;
+
+// The generic unit algebra, which conversion_factor uses, sees the expansion.
+template<dense_dimension D, dense_scale S>
+struct as_compound_unit_impl<dense_unit<D, S>> { using type = as_compound_unit<dense_expand<D, S>>; };
+
+template<class T>
+struct dense_scale_of;
+template<class... B, class... E>
+struct dense_scale_of<scale_list<dim<B, E>...>>
+{
+    static_assert((is_std_ratio<B>::value && ...),
+        "Only scales that are std::ratios can be represented by a dense_unit.");
+    static constexpr dense_scale value()
+    {
+        dense_scale result;
+        ((result = result * pow(dense_scale::from_ratio(B::num, B::den), rational(E()))), ...);
+        return result;
+    }
+};
+
+template<class T>
+struct dense_form {
+    using type = dense_unit<dense_dimension(exponents_of<T>()), dense_scale_of<flatten_scale<T>>::value()>;
+};
+template<dense_dimension D, dense_scale S>
+struct dense_form<dense_unit<D, S>> { using type = dense_unit<D, S>; };
+
+}
+
+template<dense_dimension D, dense_scale S>
+struct dense_unit : unit_base<dense_unit<D, S>> {
+    static_assert(D.valid(), "Overflow in the exponent of a dense_unit.");
+    static_assert(S.valid(), "The scale of a dense_unit overflowed or is not normalized.");
+    static constexpr dense_dimension dimension = D;
+    static constexpr dense_scale scale = S;
+    /// INTERNAL ONLY
+    /// The expansion depends on T so that it is only computed when needed.
+    template<class F, class T>
+    using _boost_units2_apply = detail::visit<F, detail::dense_expand<D, S, T>>;
+    /// INTERNAL ONLY
+    using _boost_units2_own_arithmetic = void;
+    /// INTERNAL ONLY
+    auto operator<=>(const dense_unit&) const = default;
+};
+
+/// Converts any unit to the equivalent dense_unit.
+template<class T, class = detail::requires_unit<T>>
+constexpr typename detail::dense_form<std::remove_cv_t<T>>::type to_dense(T) { return {}; }
+
+template<dense_dimension D1, dense_scale S1, dense_dimension D2, dense_scale S2>
+constexpr dense_unit<D1 * D2, S1 * S2> operator*(dense_unit<D1, S1>, dense_unit<D2, S2>) { return {}; }
+template<dense_dimension D1, dense_scale S1, dense_dimension D2, dense_scale S2>
+constexpr dense_unit<D1 / D2, S1 / S2> operator/(dense_unit<D1, S1>, dense_unit<D2, S2>) { return {}; }
+
+// Mixing a dense_unit with any other unit gives a dense_unit.
+template<dense_dimension D, dense_scale S, class U, class = detail::requires_generic_unit<U>>
+constexpr auto operator*(dense_unit<D, S> t, U u) -> decltype(t * ::boost::units2::to_dense(u)) { return {}; }
+template<class T, dense_dimension D, dense_scale S, class = detail::requires_generic_unit<T>>
+constexpr auto operator*(T t, dense_unit<D, S> u) -> decltype(::boost::units2::to_dense(t) * u) { return {}; }
+template<dense_dimension D, dense_scale S, class U, class = detail::requires_generic_unit<U>>
+constexpr auto operator/(dense_unit<D, S> t, U u) -> decltype(t / ::boost::units2::to_dense(u)) { return {}; }
+template<class T, dense_dimension D, dense_scale S, class = detail::requires_generic_unit<T>>
+constexpr auto operator/(T t, dense_unit<D, S> u) -> decltype(::boost::units2::to_dense(t) / u) { return {}; }
+
+template<dense_dimension D, dense_scale S, std::intmax_t N, std::intmax_t M>
+constexpr dense_unit<D, S * dense_scale::from_ratio(std::ratio<N, M>::num, std::ratio<N, M>::den)>
+operator*(dense_unit<D, S>, std::ratio<N, M>) { return {}; }
+template<dense_dimension D, dense_scale S, std::intmax_t N, std::intmax_t M>
+constexpr dense_unit<D, S * dense_scale::from_ratio(std::ratio<N, M>::num, std::ratio<N, M>::den)>
+operator*(std::ratio<N, M>, dense_unit<D, S>) { return {}; }
+
+template<std::intmax_t N, dense_dimension D, dense_scale S>
+constexpr dense_unit<pow(D, N), pow(S, N)> pow(dense_unit<D, S>) { return {}; }
+template<dense_dimension D, dense_scale S, std::intmax_t N, std::intmax_t M>
+constexpr dense_unit<pow(D, detail::rational(N, M)), pow(S, detail::rational(N, M))> pow(dense_unit<D, S>, std::ratio<N, M>)
+{ return {}; }
+
+}
+}
+
+#endif
@@ -0,0 +1,173 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_DETAIL_INTEGER_CONVERT_HPP_INCLUDED
+#define BOOST_UNITS2_DETAIL_INTEGER_CONVERT_HPP_INCLUDED
+
+// The rounding policies and the exact integer conversion that
+// quantity.hpp uses.  checked_quantity_cast and conversion_overflow
+// are in rounding.hpp, so that the core does not need <stdexcept>.
+
+#include <boost/mp11/utility.hpp>
+#include <cstdint>
+#include <limits>
+#include <ratio>
+#include <type_traits>
+
+namespace boost {
+namespace units2 {
+
+/**
+ * Rounding policies for converting integral quantities.  When the
+ * conversion factor is rational, integers are converted exactly, with
+ * integer arithmetic, and then rounded.  Pass a policy to quantity_cast
+ * or checked_quantity_cast (rounding.hpp) in place of the scale type, e.g.
+ *
+ *   quantity_cast<si::second, rounding::to_nearest>(ticks)
+ */
+namespace rounding {
+
+/// Rounds toward zero, like integer division.  This is the default.
+struct toward_zero {};
+/// Rounds toward negative infinity.
+struct down {};
+/// Rounds toward positive infinity.
+struct up {};
+/// Rounds to the nearest integer, and halfway cases away from zero.
+struct to_nearest {};
+/// Rounds to the nearest integer, and halfway cases to even.
+struct to_nearest_even {};
+
+}
+
+namespace detail {
+
+template<class R>
+struct is_rounding : std::false_type {};
+template<> struct is_rounding<rounding::toward_zero> : std::true_type {};
+template<> struct is_rounding<rounding::down> : std::true_type {};
+template<> struct is_rounding<rounding::up> : std::true_type {};
+template<> struct is_rounding<rounding::to_nearest> : std::true_type {};
+template<> struct is_rounding<rounding::to_nearest_even> : std::true_type {};
+
+template<class T>
+inline constexpr bool is_integer_value = std::is_integral<T>::value && !std::is_same<T, bool>::value;
+
+// Whether a value of type From can be converted to To exactly by
+// the factor F.  This needs 128 bit intermediates.  Without them,
+// integers fall back to a floating point factor.
+template<class From, class To, class F>
+inline constexpr bool has_integer_conversion = false;
+
+#ifdef __SIZEOF_INT128__
+
+__extension__ typedef __int128 int128_type;
+
+template<class From, class To, std::intmax_t N, std::intmax_t D>
+inline constexpr bool has_integer_conversion<From, To, std::ratio<N, D>> =
+    is_integer_value<From> && is_integer_value<To> && sizeof(From) <= 8 && sizeof(To) <= 8 && N > 0;
+
+#endif
+
+// Tests the sign without warning for unsigned types.  This is not based
+// on is_signed, which is false for __int128 in strict ISO mode.
+template<class T>
+constexpr bool is_negative(T x)
+{
+    if constexpr(std::is_unsigned<T>::value) return false;
+    else return x < 0;
+}
+
+// The correction to a quotient that was truncated toward zero, given
+// the remainder m of the division by d.  m has the sign of the dividend.
+template<class T>
+constexpr int rounding_adjust(rounding::toward_zero, T, T, bool) { return 0; }
+template<class T>
+constexpr int rounding_adjust(rounding::down, T m, T, bool) { return is_negative(m)? -1 : 0; }
+template<class T>
+constexpr int rounding_adjust(rounding::up, T m, T, bool) { return m > 0? 1 : 0; }
+template<class T>
+constexpr int rounding_adjust(rounding::to_nearest, T m, T d, bool)
+{
+    T abs_m = is_negative(m)? -m : m;
+    // abs_m * 2 >= d, without overflowing
+    if(abs_m == 0 || abs_m < d - abs_m) return 0;
+    return is_negative(m)? -1 : 1;
+}
+template<class T>
+constexpr int rounding_adjust(rounding::to_nearest_even, T m, T d, bool odd)
+{
+    T abs_m = is_negative(m)? -m : m;
+    if(abs_m == 0 || abs_m < d - abs_m || (abs_m == d - abs_m && !odd)) return 0;
+    return is_negative(m)? -1 : 1;
+}
+
+template<class T>
+struct integer_conversion_result {
+    T value;
+    bool overflow;
+};
+
+#ifdef __SIZEOF_INT128__
+
+// Computes x * N / D, rounded by R, as a To.  x is divided by D first,
+// at the width of x, where the compiler turns division by a constant into
+// a multiplication.  The rest, (x % D) * N, is smaller than N * D in
+// magnitude, so it only needs 128 bits if N * D does not fit in 64.
+// The quotient is scaled in 128 bits, which cannot overflow, and is then
+// checked against the range of To.
+template<class To, class R, std::intmax_t N, std::intmax_t D, class From>
+constexpr integer_conversion_result<To> integer_convert(std::ratio<N, D>, From x)
+{
+    static_assert(has_integer_conversion<From, To, std::ratio<N, D>>, "integer_convert requires integers of at most 64 bits.");
+    using wide = std::common_type_t<decltype(+x), std::intmax_t>;
+    using rest_type = mp11::mp_if_c<(N <= (std::numeric_limits<std::intmax_t>::max)() / D), wide, int128_type>;
+    const wide q = static_cast<wide>(x) / D;
+    const rest_type rest = static_cast<rest_type>(static_cast<wide>(x) % D) * N;
+    int128_type result = static_cast<int128_type>(q) * N + static_cast<int128_type>(rest / D);
+    result += rounding_adjust(R(), static_cast<rest_type>(rest % D), static_cast<rest_type>(D), (result & 1) != 0);
+    return { static_cast<To>(result),
+        result < static_cast<int128_type>((std::numeric_limits<To>::min)()) ||
+        result > static_cast<int128_type>((std::numeric_limits<To>::max)()) };
+}
+
+// As above, for a factor num / den that is only known at run time,
+// rounded toward zero.  Used by the views that convert stored integers.
+// \pre num > 0 && den > 0
+template<class To, class From>
+constexpr integer_conversion_result<To> integer_convert(std::intmax_t num, std::intmax_t den, From x)
+{
+    using wide = std::common_type_t<decltype(+x), std::intmax_t>;
+    const wide q = static_cast<wide>(x) / static_cast<wide>(den);
+    const int128_type rest = static_cast<int128_type>(static_cast<wide>(x) % static_cast<wide>(den)) * num;
+    const int128_type result = static_cast<int128_type>(q) * num + rest / den;
+    return { static_cast<To>(result),
+        result < static_cast<int128_type>((std::numeric_limits<To>::min)()) ||
+        result > static_cast<int128_type>((std::numeric_limits<To>::max)()) };
+}
+
+#else
+
+template<class To, class R, std::intmax_t N, std::intmax_t D, class From>
+constexpr integer_conversion_result<To> integer_convert(std::ratio<N, D>, From x);
+
+// Without 128 bit intermediates, the factor is applied in long double.
+template<class To, class From>
+constexpr integer_conversion_result<To> integer_convert(std::intmax_t num, std::intmax_t den, From x)
+{
+    const long double result = static_cast<long double>(x) * num / den;
+    const bool overflow = result < static_cast<long double>((std::numeric_limits<To>::min)()) ||
+        result > static_cast<long double>((std::numeric_limits<To>::max)());
+    return { overflow? To() : static_cast<To>(result), overflow };
+}
+
+#endif
+
+}
+}
+}
+
+#endif
@@ -7,7 +7,13 @@
 #ifndef BOOST_UNITS2_DETAIL_MERGE_HPP_INCLUDED
 #define BOOST_UNITS2_DETAIL_MERGE_HPP_INCLUDED
 
+#include <boost/mp11/list.hpp>
+#include <boost/mp11/utility.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <ratio>
+#include <utility>
 
 // Defines a merge operation for sequences of (Base, Exponent) pairs.
 // Identical bases are combined, and 0 exponents are removed.
@@ -16,6 +22,11 @@
 // empty: bool
 // pop_front: sequence
 // front: a specialization of dim
+//
+// merge recurses once per element, so sequences longer than
+// merge_recurse_limit are normalized instead (see normalize_impl),
+// which has a fixed instantiation depth.  merge_all combines any
+// number of sequences in a single normalization.
 
 namespace boost {
 namespace units2 {
@@ -123,9 +134,176 @@ struct merge_impl<0> {
             std::ratio_add<typename T::front::exponent, typename U::front::exponent> >, R...>;
 };
 
-//
+// Merging more than two sequences at once.  The sequences are
+// concatenated and normalized in one step: a constexpr function finds
+// the groups of equal elements and sorts them, using a table of all
+// the comparisons, and the result is assembled with a single pack
+// expansion.  Unlike the pairwise merge above, the instantiation
+// depth does not depend on the length of the sequences.
+
+template<std::size_t I, class T>
+struct merge_leaf {};
+template<std::size_t I, class T>
+T merge_pick(const merge_leaf<I, T>*);
+
+// Looks up elements by index with overload resolution, instead of
+// instantiating a recursive template for each lookup.
+template<class Seq, class... T>
+struct merge_index;
+template<std::size_t... I, class... T>
+struct merge_index<std::index_sequence<I...>, T...> : merge_leaf<I, T>... {};
+
+constexpr std::intmax_t merge_gcd(std::intmax_t a, std::intmax_t b)
+{
+    if(a < 0) a = -a;
+    while(b != 0) { std::intmax_t t = a % b; a = b; b = t; }
+    return a;
+}
+
+// Checks that x*y does not overflow.  y must not be 0.
+constexpr bool merge_product_fits(std::intmax_t x, std::intmax_t y)
+{
+    return x == 0 || (x < 0? -x : x) <= (std::numeric_limits<std::intmax_t>::max)() / (y < 0? -y : y);
+}
+
+// Stores a/b + c/d in num/den, which are in lowest terms
+// with den > 0.  Returns false on overflow.
+constexpr bool merge_add_exponents(std::intmax_t a, std::intmax_t b, std::intmax_t c, std::intmax_t d,
+    std::intmax_t& num, std::intmax_t& den)
+{
+    constexpr std::intmax_t max = (std::numeric_limits<std::intmax_t>::max)();
+    const std::intmax_t g = merge_gcd(b, d);
+    const std::intmax_t b1 = b / g, d1 = d / g;
+    if(!merge_product_fits(a, d1) || !merge_product_fits(c, b1) || !merge_product_fits(b1, d)) return false;
+    const std::intmax_t x = a * d1, y = c * b1;
+    if((y > 0 && x > max - y) || (y < 0 && x < -max - y)) return false;
+    num = x + y;
+    den = b1 * d;
+    const std::intmax_t h = num == 0? den : merge_gcd(num, den);
+    num /= h;
+    den /= h;
+    return true;
+}
+
+template<std::size_t N>
+struct normalize_plan {
+    std::size_t size = 0;
+    bool overflow = false;
+    std::size_t source[N + 1] = {};
+    bool combined[N + 1] = {};
+    std::intmax_t num[N + 1] = {};
+    std::intmax_t den[N + 1] = {};
+};
+
+template<bool Combined>
+struct normalize_element { template<class A, std::intmax_t N, std::intmax_t D> using fn = A; };
+template<>
+struct normalize_element<true> { template<class A, std::intmax_t N, std::intmax_t D> using fn = dim<typename A::base, std::ratio<N, D> >; };
+
+template<template<class, class> class Cmp, class L>
+struct normalize_impl;
+
+template<template<class, class> class Cmp, template<class...> class L, class... T>
+struct normalize_impl<Cmp, L<T...>>
+{
+    static constexpr std::size_t n = sizeof...(T);
+
+    // The results of comparing X with every element.
+    template<class X>
+    static constexpr int compare_row[n + 1] = { Cmp<typename X::base, typename T::base>::value..., 0 };
+
+    static constexpr normalize_plan<n> make_plan()
+    {
+        constexpr const int* rows[n + 1] = { compare_row<T>..., nullptr };
+        constexpr std::intmax_t nums[n + 1] = { T::exponent::num..., 0 };
+        constexpr std::intmax_t dens[n + 1] = { T::exponent::den..., 1 };
+        normalize_plan<n> result;
+        bool seen[n + 1] = {};
+        std::size_t rank[n + 1] = {};
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            if(seen[i]) continue;
+            // The first of a group of equal elements represents the group.
+            std::intmax_t num = nums[i], den = dens[i];
+            bool combined = false;
+            std::size_t r = 0;
+            for(std::size_t j = 0; j < n; ++j)
+            {
+                if(rows[i][j] > 0) ++r;
+                else if(j > i && rows[i][j] == 0)
+                {
+                    seen[j] = true;
+                    combined = true;
+                    if(!merge_add_exponents(num, den, nums[j], dens[j], num, den)) result.overflow = true;
+                }
+            }
+            // Remove the group if the exponents cancel.
+            if(num == 0) continue;
+            // Insert, keeping the groups sorted by rank.
+            std::size_t k = result.size++;
+            for(; k > 0 && rank[k - 1] > r; --k)
+            {
+                rank[k] = rank[k - 1];
+                result.source[k] = result.source[k - 1];
+                result.combined[k] = result.combined[k - 1];
+                result.num[k] = result.num[k - 1];
+                result.den[k] = result.den[k - 1];
+            }
+            rank[k] = r;
+            result.source[k] = i;
+            result.combined[k] = combined;
+            result.num[k] = num;
+            result.den[k] = den;
+        }
+        return result;
+    }
+    static constexpr normalize_plan<n> plan = make_plan();
+    static_assert(!plan.overflow, "overflow in exponent");
+
+    using index = merge_index<std::make_index_sequence<n>, T...>;
+    // Elements that were not combined with anything are reused as is.
+    template<std::size_t... K>
+    static L<typename normalize_element<plan.combined[K]>::template fn<
+        decltype(::boost::units2::detail::merge_pick<plan.source[K]>(static_cast<const index*>(nullptr))),
+        plan.num[K], plan.den[K]>...> make(std::index_sequence<K...>);
+
+    using type = decltype(make(std::make_index_sequence<plan.size>()));
+};
+
+template<template<class, class> class Cmp, template<class...> class L>
+struct normalize_impl<Cmp, L<>> { using type = L<>; };
+
+// The pairwise merge is cheaper for short sequences, and its depth
+// is bounded as long as they stay short.
+inline constexpr std::size_t merge_recurse_limit = 64;
+
+struct merge_pairwise {
+    template<template<class, class> class Cmp, template<class...> class L, class T, class U>
+    using fn = merge_recurse<Cmp, L, T, U>;
+};
+struct merge_normalize {
+    template<template<class, class> class Cmp, template<class...> class L, class T, class U>
+    using fn = typename normalize_impl<Cmp, typename append<T, U>::type>::type;
+};
+
+template<template<class, class> class Cmp, template<class...> class L, class T, class U>
+using merge = typename ::boost::mp11::mp_if_c<
+    (::boost::mp11::mp_size<T>::value + ::boost::mp11::mp_size<U>::value <= merge_recurse_limit),
+    merge_pairwise, merge_normalize>::template fn<Cmp, L, T, U>;
+
+template<template<class, class> class Cmp, template<class...> class L, class... T>
+struct merge_all_impl { using type = typename normalize_impl<Cmp, ::boost::mp11::mp_append<L<>, T...>>::type; };
+template<template<class, class> class Cmp, template<class...> class L>
+struct merge_all_impl<Cmp, L> { using type = L<>; };
+template<template<class, class> class Cmp, template<class...> class L, class T>
+struct merge_all_impl<Cmp, L, T> { using type = T; };
 template<template<class, class> class Cmp, template<class...> class L, class T, class U>
-using merge = merge_recurse<Cmp, L, T, U>;
+struct merge_all_impl<Cmp, L, T, U> { using type = merge<Cmp, L, T, U>; };
+
+// Merges any number of sequences.  Equivalent to folding merge
+// over them, but only instantiates a single merge.
+template<template<class, class> class Cmp, template<class...> class L, class... T>
+using merge_all = typename merge_all_impl<Cmp, L, T...>::type;
 
 }
 }
@@ -0,0 +1,125 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_DETAIL_RATIONAL_HPP_INCLUDED
+#define BOOST_UNITS2_DETAIL_RATIONAL_HPP_INCLUDED
+
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <ratio>
+
+namespace boost {
+namespace units2 {
+namespace detail {
+
+// Stores a*b in out.  Returns false on overflow.
+constexpr bool checked_multiply(std::intmax_t a, std::intmax_t b, std::intmax_t& out)
+{
+    constexpr std::intmax_t max = (std::numeric_limits<std::intmax_t>::max)();
+    if(a == 0 || b == 0) { out = 0; return true; }
+    // Reject the one value whose magnitude is not representable.
+    if(a < -max || b < -max) return false;
+    std::intmax_t abs_a = a < 0? -a : a;
+    std::intmax_t abs_b = b < 0? -b : b;
+    if(max / abs_a < abs_b) return false;
+    out = a * b;
+    return true;
+}
+
+// Stores a+b in out.  Returns false on overflow.
+constexpr bool checked_add(std::intmax_t a, std::intmax_t b, std::intmax_t& out)
+{
+    constexpr std::intmax_t max = (std::numeric_limits<std::intmax_t>::max)();
+    if((b > 0 && a > max - b) || (b < 0 && a < -max - b)) return false;
+    out = a + b;
+    return true;
+}
+
+/**
+ * A run time rational number, always in lowest terms with a positive
+ * denominator.  Arithmetic that would overflow produces a value
+ * with a zero denominator, which compares unequal to everything
+ * and propagates through later operations.  Check valid() at the end.
+ */
+struct rational {
+    std::intmax_t num;
+    std::intmax_t den;
+
+    constexpr rational() : num(0), den(1) {}
+    constexpr rational(std::intmax_t n) : num(n), den(1) {}
+    constexpr rational(std::intmax_t n, std::intmax_t d) : num(n), den(d) { normalize(); }
+    template<std::intmax_t N, std::intmax_t D>
+    constexpr rational(std::ratio<N, D>) : num(std::ratio<N, D>::num), den(std::ratio<N, D>::den) {}
+
+    static constexpr rational overflow() { rational result; result.den = 0; return result; }
+    constexpr bool valid() const { return den != 0; }
+
+    template<class R = double>
+    constexpr R value() const { return static_cast<R>(num) / static_cast<R>(den); }
+
+    friend constexpr rational operator*(const rational& lhs, const rational& rhs)
+    {
+        if(!lhs.valid() || !rhs.valid()) return overflow();
+        // Cancel first, so that the products only overflow if the result does.
+        std::intmax_t g1 = std::gcd(lhs.num, rhs.den);
+        std::intmax_t g2 = std::gcd(rhs.num, lhs.den);
+        if(g1 == 0) g1 = 1;
+        if(g2 == 0) g2 = 1;
+        rational result;
+        if(!checked_multiply(lhs.num / g1, rhs.num / g2, result.num) ||
+           !checked_multiply(lhs.den / g2, rhs.den / g1, result.den))
+            return overflow();
+        return result;
+    }
+    friend constexpr rational operator/(const rational& lhs, const rational& rhs)
+    {
+        if(!rhs.valid() || rhs.num == 0) return overflow();
+        return lhs * rational(rhs.den, rhs.num);
+    }
+    friend constexpr rational operator+(const rational& lhs, const rational& rhs)
+    {
+        if(!lhs.valid() || !rhs.valid()) return overflow();
+        std::intmax_t g = std::gcd(lhs.den, rhs.den);
+        std::intmax_t a, b, n, d;
+        if(!checked_multiply(lhs.num, rhs.den / g, a) ||
+           !checked_multiply(rhs.num, lhs.den / g, b) ||
+           !checked_add(a, b, n) ||
+           !checked_multiply(lhs.den / g, rhs.den, d))
+            return overflow();
+        return rational(n, d);
+    }
+    friend constexpr rational operator-(const rational& arg)
+    {
+        rational result = arg;
+        result.num = -result.num;
+        return result;
+    }
+    friend constexpr rational operator-(const rational& lhs, const rational& rhs) { return lhs + -rhs; }
+    constexpr rational& operator*=(const rational& other) { return *this = *this * other; }
+    constexpr rational& operator/=(const rational& other) { return *this = *this / other; }
+    constexpr rational& operator+=(const rational& other) { return *this = *this + other; }
+    constexpr rational& operator-=(const rational& other) { return *this = *this - other; }
+
+    friend constexpr bool operator==(const rational& lhs, const rational& rhs)
+    { return lhs.valid() && rhs.valid() && lhs.num == rhs.num && lhs.den == rhs.den; }
+
+private:
+    constexpr void normalize()
+    {
+        if(den == 0) return;
+        if(den < 0) { num = -num; den = -den; }
+        std::intmax_t g = std::gcd(num, den);
+        num /= g;
+        den /= g;
+    }
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,179 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_DETAIL_UNIT_NAME_HPP_INCLUDED
+#define BOOST_UNITS2_DETAIL_UNIT_NAME_HPP_INCLUDED
+
+#include <boost/units2/unit.hpp>
+#include <charconv>
+#include <cstdint>
+#include <ratio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// A canonical spelling of a unit, built from its normalized type.
+// Units of the same type have the same spelling.  The converse does
+// not hold: names are not qualified by their namespace, so units
+// defined by BOOST_UNITS2_DEF with the same name in different
+// namespaces are spelled the same.  Code that identifies units by
+// their spelling or fingerprint cannot tell such units apart.
+//
+//   unit     := name | "1" | factor ("*" factor)* | "[" scale "]*" unit
+//             | "abs(" unit ";" scale ")"
+//   factor   := operand | operand "^" exponent
+//   operand  := name | "(" unit ")"
+//   exponent := N | "(" N "/" D ")"
+//   scale    := N | N "/" D | value
+//
+// where name is the string given to BOOST_UNITS2_DEF and value is a
+// non-ratio scale printed with full precision.  abs(u;o) is the
+// absolute_unit whose zero is at o in u (see absolute.hpp).
+//
+// The spelling is produced by writing tokens to a sink, which
+// must provide put(std::string_view), put_integer(std::intmax_t)
+// and put_real(double).  This allows the same traversal to compute
+// a hash at compile time (see fingerprint.hpp).
+
+namespace boost {
+namespace units2 {
+namespace detail {
+
+template<class T, class = void>
+struct has_unit_name : std::false_type {};
+template<class T>
+struct has_unit_name<T, std::void_t<decltype(T::name)>> : std::true_type {};
+
+template<class Sink, std::intmax_t N, std::intmax_t D>
+constexpr void put_ratio(Sink& out, std::ratio<N, D>)
+{
+    out.put_integer(N);
+    if(D != 1) { out.put("/"); out.put_integer(D); }
+}
+
+template<class Sink, class Scale>
+constexpr void put_scale(Sink& out, Scale s)
+{
+    out.put_real(::boost::units2::detail::get_value(s));
+}
+template<class Sink, std::intmax_t N, std::intmax_t D>
+constexpr void put_scale(Sink& out, std::ratio<N, D> r)
+{
+    ::boost::units2::detail::put_ratio(out, r);
+}
+
+template<class T, class Sink>
+constexpr void put_unit_name(Sink& out, bool nested);
+
+struct unit_name_impl
+{
+    template<class T>
+    struct apply_base {
+        template<class Sink>
+        static constexpr void put(Sink& out, bool) { out.put(T::name); }
+    };
+
+    template<class Base, class Scale>
+    struct apply_scaled {
+        template<class Sink>
+        static constexpr void put(Sink& out, bool nested)
+        {
+            if(nested) out.put("(");
+            out.put("[");
+            ::boost::units2::detail::put_scale(out, Scale());
+            out.put("]*");
+            ::boost::units2::detail::put_unit_name<Base>(out, false);
+            if(nested) out.put(")");
+        }
+    };
+
+    template<class... T>
+    struct apply_compound {
+        template<class Sink>
+        static constexpr void put(Sink& out, bool nested)
+        {
+            if constexpr(sizeof...(T) == 0)
+                out.put("1");
+            else
+            {
+                bool first = true;
+                if(nested && sizeof...(T) > 1) out.put("(");
+                ((put_factor<typename T::base>(out, typename T::exponent(), first), first = false), ...);
+                if(nested && sizeof...(T) > 1) out.put(")");
+            }
+        }
+    };
+
+    template<class Unit, class Offset>
+    struct apply_absolute {
+        template<class Sink>
+        static constexpr void put(Sink& out, bool)
+        {
+            out.put("abs(");
+            ::boost::units2::detail::put_unit_name<Unit>(out, false);
+            out.put(";");
+            ::boost::units2::detail::put_scale(out, Offset());
+            out.put(")");
+        }
+    };
+
+    template<class B, class Sink, std::intmax_t N, std::intmax_t D>
+    static constexpr void put_factor(Sink& out, std::ratio<N, D>, bool first)
+    {
+        if(!first) out.put("*");
+        ::boost::units2::detail::put_unit_name<B>(out, true);
+        if(N == 1 && D == 1) return;
+        out.put("^");
+        if(D != 1) out.put("(");
+        ::boost::units2::detail::put_ratio(out, std::ratio<N, D>());
+        if(D != 1) out.put(")");
+    }
+};
+
+template<class T, class Sink>
+constexpr void put_unit_name(Sink& out, bool nested)
+{
+    // Units defined by BOOST_UNITS2_DEF are opaque, even
+    // when they are defined in terms of another unit.
+    if constexpr(has_unit_name<T>::value)
+        out.put(T::name);
+    else
+        visit<unit_name_impl, T>::template put(out, nested);
+}
+
+struct string_sink {
+    std::string& out;
+    void put(std::string_view s) { out += s; }
+    void put_integer(std::intmax_t x)
+    {
+        char buf[24];
+        out.append(buf, std::to_chars(buf, buf + sizeof(buf), x).ptr);
+    }
+    void put_real(double x)
+    {
+        char buf[32];
+        out.append(buf, std::to_chars(buf, buf + sizeof(buf), x).ptr);
+    }
+};
+
+/// Returns the canonical spelling of the unit T.
+template<class T>
+const std::string& unit_name()
+{
+    static const std::string result = [] {
+        std::string out;
+        string_sink sink{ out };
+        ::boost::units2::detail::put_unit_name<std::remove_cv_t<T>>(sink, false);
+        return out;
+    }();
+    return result;
+}
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,224 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_DYNAMIC_QUANTITY_HPP_INCLUDED
+#define BOOST_UNITS2_DYNAMIC_QUANTITY_HPP_INCLUDED
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/base_dimension.hpp>
+#include <boost/units2/runtime_unit.hpp>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace boost {
+namespace units2 {
+
+/**
+ * The dimension of a dynamic_quantity: an integer exponent for each
+ * base dimension, packed into one 64 bit word as 7 bit two's complement
+ * lanes.  Lane i holds the exponent of base_dimension(i), so exponents
+ * range from -64 to 63.  Multiplying and dividing dimensions adds and
+ * subtracts all the lanes at once, with ordinary integer instructions.
+ */
+class packed_dimension {
+public:
+    static constexpr int lane_bits = 7;
+    static constexpr int min_exponent = -(1 << (lane_bits - 1));
+    static constexpr int max_exponent = (1 << (lane_bits - 1)) - 1;
+
+    /// Creates the dimension of a dimensionless quantity.
+    constexpr packed_dimension() = default;
+    static constexpr packed_dimension from_bits(std::uint64_t bits) { return packed_dimension(bits & used_mask); }
+    /// Throws runtime_unit_error if an exponent is not an
+    /// integer, or does not fit.
+    static constexpr packed_dimension from_exponents(const detail::dimension_exponents& exponents)
+    {
+        std::uint64_t bits = 0;
+        for(std::size_t i = 0; i < base_dimension_count; ++i)
+        {
+            const detail::rational& e = exponents[i];
+            if(e.den != 1 || e.num < min_exponent || e.num > max_exponent)
+                throw runtime_unit_error("boost::units2::packed_dimension: exponent cannot be represented");
+            bits |= (static_cast<std::uint64_t>(e.num) & lane_mask) << (i * lane_bits);
+        }
+        return packed_dimension(bits);
+    }
+
+    constexpr std::uint64_t bits() const noexcept { return bits_; }
+    constexpr int exponent(base_dimension d) const noexcept
+    {
+        int lane = static_cast<int>((bits_ >> (static_cast<std::size_t>(d) * lane_bits)) & lane_mask);
+        return lane > max_exponent? lane - (1 << lane_bits) : lane;
+    }
+    constexpr detail::dimension_exponents exponents() const
+    {
+        detail::dimension_exponents result;
+        for(std::size_t i = 0; i < base_dimension_count; ++i)
+            result[i] = exponent(static_cast<base_dimension>(i));
+        return result;
+    }
+    constexpr bool is_dimensionless() const noexcept { return bits_ == 0; }
+
+    /// Stores lhs*rhs in out.  Returns false if an exponent overflows.
+    static constexpr bool multiply(packed_dimension lhs, packed_dimension rhs, packed_dimension& out) noexcept
+    {
+        const std::uint64_t a = lhs.bits_, b = rhs.bits_;
+        // Add the low bits of each lane, so that the carries stay
+        // within the lane, then fix up the top bit.
+        const std::uint64_t sum = (((a & ~high_bits) + (b & ~high_bits)) ^ ((a ^ b) & high_bits)) & used_mask;
+        out.bits_ = sum;
+        // Signed overflow: both operands have the same sign, which differs from the result.
+        return (~(a ^ b) & (a ^ sum) & high_bits) == 0;
+    }
+    /// Stores lhs/rhs in out.  Returns false if an exponent overflows.
+    static constexpr bool divide(packed_dimension lhs, packed_dimension rhs, packed_dimension& out) noexcept
+    {
+        const std::uint64_t a = lhs.bits_, b = rhs.bits_;
+        // Setting the top bit of each lane of a means that no lane borrows.
+        const std::uint64_t diff = (((a | high_bits) - (b & ~high_bits)) ^ ((a ^ ~b) & high_bits)) & used_mask;
+        out.bits_ = diff;
+        // Signed overflow: the operands have different signs and the result has the sign of b.
+        return ((a ^ b) & (a ^ diff) & high_bits) == 0;
+    }
+
+    /// Throws runtime_unit_error if an exponent overflows.
+    friend constexpr packed_dimension operator*(packed_dimension lhs, packed_dimension rhs)
+    {
+        packed_dimension result;
+        if(!multiply(lhs, rhs, result)) overflow();
+        return result;
+    }
+    friend constexpr packed_dimension operator/(packed_dimension lhs, packed_dimension rhs)
+    {
+        packed_dimension result;
+        if(!divide(lhs, rhs, result)) overflow();
+        return result;
+    }
+    friend constexpr packed_dimension pow(packed_dimension d, int n)
+    {
+        detail::dimension_exponents exponents = d.exponents();
+        for(detail::rational& e : exponents) e *= n;
+        return from_exponents(exponents);
+    }
+    friend constexpr bool operator==(packed_dimension, packed_dimension) = default;
+private:
+    static constexpr std::uint64_t lane_mask = (std::uint64_t(1) << lane_bits) - 1;
+    static constexpr std::uint64_t used_mask = (std::uint64_t(1) << (lane_bits * base_dimension_count)) - 1;
+    static constexpr std::uint64_t low_bits = used_mask / lane_mask;
+    static constexpr std::uint64_t high_bits = low_bits << (lane_bits - 1);
+    static_assert(lane_bits * base_dimension_count <= 64);
+
+    constexpr explicit packed_dimension(std::uint64_t bits) : bits_(bits) {}
+    [[noreturn]] static void overflow()
+    {
+        throw runtime_unit_error("boost::units2::packed_dimension: exponent overflow");
+    }
+
+    std::uint64_t bits_ = 0;
+};
+
+/// The dimension of the static unit U, computed at compile time.
+template<class U>
+inline constexpr packed_dimension packed_dimension_of =
+    packed_dimension::from_exponents(detail::exponents_of<U>());
+
+namespace detail {
+
+// The unit in which a dynamic_quantity with the dimension of U stores
+// its value: the product of the base dimensions.
+template<class U>
+using dynamic_base_unit = dimension_check<std::remove_cv_t<U>>;
+
+[[noreturn]] inline void dimension_mismatch()
+{
+    throw runtime_unit_error("boost::units2::dynamic_quantity: dimensions do not match");
+}
+
+}
+
+/**
+ * A quantity whose unit is only known at run time.  The value is
+ * always stored in the base units of its dimension (see runtime_unit),
+ * so only the dimension needs to be tracked.  Operations that require
+ * matching dimensions throw runtime_unit_error when they do not match.
+ */
+template<class T = double>
+class dynamic_quantity {
+public:
+    using value_type = T;
+
+    /// Creates a dimensionless zero.
+    constexpr dynamic_quantity() = default;
+    /// value is in the base units of d.
+    constexpr dynamic_quantity(const T& value, packed_dimension d) : value_(value), dimension_(d) {}
+    /// value is in the unit u.
+    dynamic_quantity(const T& value, const runtime_unit& u)
+      : value_(static_cast<T>(value * u.factor())), dimension_(packed_dimension::from_exponents(u.exponents())) {}
+    /// Converts from a static quantity.  The dimension is a compile time
+    /// constant and the conversion factor is elided when it is 1.
+    template<auto Unit, class U>
+    constexpr dynamic_quantity(const quantity<Unit, U>& q)
+      : value_(detail::convert_to<T, void>(Unit, detail::dynamic_base_unit<decltype(Unit)>{}, q.value())),
+        dimension_(packed_dimension_of<decltype(Unit)>) {}
+
+    /// The value in the base units of the dimension.
+    constexpr const T& value() const noexcept { return value_; }
+    constexpr packed_dimension dimension() const noexcept { return dimension_; }
+    /// The value in u.  Throws runtime_unit_error if u has a different dimension.
+    T value_in(const runtime_unit& u) const
+    {
+        check(packed_dimension::from_exponents(u.exponents()));
+        return static_cast<T>(value_ / u.factor());
+    }
+
+    dynamic_quantity& operator+=(const dynamic_quantity& other) { check(other.dimension_); value_ += other.value_; return *this; }
+    dynamic_quantity& operator-=(const dynamic_quantity& other) { check(other.dimension_); value_ -= other.value_; return *this; }
+    dynamic_quantity& operator*=(const dynamic_quantity& other) { dimension_ = dimension_ * other.dimension_; value_ *= other.value_; return *this; }
+    dynamic_quantity& operator/=(const dynamic_quantity& other) { dimension_ = dimension_ / other.dimension_; value_ /= other.value_; return *this; }
+    dynamic_quantity& operator*=(const T& x) { value_ *= x; return *this; }
+    dynamic_quantity& operator/=(const T& x) { value_ /= x; return *this; }
+
+    friend dynamic_quantity operator+(dynamic_quantity lhs, const dynamic_quantity& rhs) { return lhs += rhs; }
+    friend dynamic_quantity operator-(dynamic_quantity lhs, const dynamic_quantity& rhs) { return lhs -= rhs; }
+    friend dynamic_quantity operator*(dynamic_quantity lhs, const dynamic_quantity& rhs) { return lhs *= rhs; }
+    friend dynamic_quantity operator/(dynamic_quantity lhs, const dynamic_quantity& rhs) { return lhs /= rhs; }
+    friend dynamic_quantity operator*(dynamic_quantity lhs, const T& rhs) { return lhs *= rhs; }
+    friend dynamic_quantity operator*(const T& lhs, dynamic_quantity rhs) { return rhs *= lhs; }
+    friend dynamic_quantity operator/(dynamic_quantity lhs, const T& rhs) { return lhs /= rhs; }
+    friend dynamic_quantity operator-(const dynamic_quantity& q) { return dynamic_quantity(-q.value_, q.dimension_); }
+    friend dynamic_quantity operator+(const dynamic_quantity& q) { return q; }
+
+    friend bool operator==(const dynamic_quantity& lhs, const dynamic_quantity& rhs)
+    { lhs.check(rhs.dimension_); return lhs.value_ == rhs.value_; }
+    friend auto operator<=>(const dynamic_quantity& lhs, const dynamic_quantity& rhs)
+    { lhs.check(rhs.dimension_); return lhs.value_ <=> rhs.value_; }
+private:
+    constexpr void check(packed_dimension d) const
+    {
+        if(d != dimension_) detail::dimension_mismatch();
+    }
+    T value_ = T();
+    packed_dimension dimension_;
+};
+
+/**
+ * Converts a dynamic_quantity back to a static quantity.  Throws
+ * runtime_unit_error if q does not have the dimension of Unit.  The
+ * conversion factor is applied in S, which defaults as for quantity_cast.
+ */
+template<auto Unit, class S = void, class T>
+constexpr quantity<Unit, T> quantity_cast(const dynamic_quantity<T>& q)
+{
+    if(q.dimension() != packed_dimension_of<decltype(Unit)>) detail::dimension_mismatch();
+    return quantity<Unit, T>::from_value(detail::convert_to<T, S>(detail::dynamic_base_unit<decltype(Unit)>{}, Unit, q.value()));
+}
+
+}
+}
+
+#endif
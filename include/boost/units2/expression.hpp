@@ -0,0 +1,309 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_EXPRESSION_HPP_INCLUDED
+#define BOOST_UNITS2_EXPRESSION_HPP_INCLUDED
+
+#include <boost/units2/quantity.hpp>
+#include <type_traits>
+#include <utility>
+
+// Lazy quantity expressions.  lazy(q) wraps a quantity, and the
+// arithmetic operators on the result build an expression tree instead
+// of computing anything.  The tree is evaluated when it is converted to
+// a quantity, directly in the unit of that quantity.
+//
+// The conversion factors are never applied one operation at a time.
+// Every node knows, at compile time, how many multiplications by a
+// conversion factor it needs to produce its value in a given unit, and
+// for each product, quotient and sum it picks where to apply the
+// factor: to one of the operands, which may absorb it into a factor
+// that they need anyway, or once to the result.  Each factor is
+// computed from the unit types with conversion_factor, so the factors
+// that are combined are folded into one exact constant.
+//
+// As with conversion_factor, the factors are applied in the value_type
+// for floating point types and in double otherwise.  For integral
+// types a factor may therefore be rounded at a different point than
+// with step by step conversions.
+
+namespace boost {
+namespace units2 {
+
+template<class E>
+class quantity_expression;
+
+namespace detail {
+
+// Every node has
+//   unit_type:     the unit that the value is naturally computed in
+//   value_type
+//   cost<Target>:  the number of multiplications by a conversion
+//                  factor that are needed to compute the value in Target
+//   eval<Target>() computes the value in Target.
+
+template<class From, class To, class T>
+inline constexpr int conversion_cost =
+    ::boost::units2::conversion_factor<choose_scale_type<void, T>>(From{}, To{}) == 1? 0 : 1;
+
+template<class T, class From, class To>
+constexpr T convert_value(const T& x)
+{
+    return convert_to<T, void>(From{}, To{}, x);
+}
+
+template<class Unit, class T>
+struct expr_leaf
+{
+    using unit_type = Unit;
+    using value_type = T;
+    template<class Target>
+    static constexpr int cost = conversion_cost<Unit, Target, T>;
+    template<class Target>
+    constexpr value_type eval() const { return convert_value<T, Unit, Target>(value); }
+    T value;
+};
+
+// Where a conversion factor is applied.
+enum class expr_strategy { left, right, result };
+
+template<class Target, class Unit, class T, class L, class R>
+constexpr expr_strategy choose_strategy(int left, int right)
+{
+    constexpr int natural = L::template cost<typename L::unit_type> + R::template cost<typename R::unit_type>;
+    const int result = natural + conversion_cost<Unit, Target, T>;
+    // Prefer to convert the result on ties, since that is what
+    // the eager operators would do.
+    if(result <= left && result <= right) return expr_strategy::result;
+    return left <= right? expr_strategy::left : expr_strategy::right;
+}
+
+template<class L, class R>
+struct expr_multiply
+{
+    using lunit = typename L::unit_type;
+    using runit = typename R::unit_type;
+    using unit_type = decltype(lunit{} * runit{});
+    using value_type = decltype(std::declval<typename L::value_type>() * std::declval<typename R::value_type>());
+    // The unit that an operand needs, so that the product is in Target.
+    template<class Target>
+    using left_target = decltype(Target{} / runit{});
+    template<class Target>
+    using right_target = decltype(Target{} / lunit{});
+    template<class Target>
+    static constexpr expr_strategy strategy = choose_strategy<Target, unit_type, value_type, L, R>(
+        L::template cost<left_target<Target>> + R::template cost<runit>,
+        L::template cost<lunit> + R::template cost<right_target<Target>>);
+    template<class Target>
+    static constexpr int cost =
+        strategy<Target> == expr_strategy::left? L::template cost<left_target<Target>> + R::template cost<runit> :
+        strategy<Target> == expr_strategy::right? L::template cost<lunit> + R::template cost<right_target<Target>> :
+        L::template cost<lunit> + R::template cost<runit> + conversion_cost<unit_type, Target, value_type>;
+    template<class Target>
+    constexpr value_type eval() const
+    {
+        if constexpr(strategy<Target> == expr_strategy::left)
+            return l.template eval<left_target<Target>>() * r.template eval<runit>();
+        else if constexpr(strategy<Target> == expr_strategy::right)
+            return l.template eval<lunit>() * r.template eval<right_target<Target>>();
+        else
+            return convert_value<value_type, unit_type, Target>(l.template eval<lunit>() * r.template eval<runit>());
+    }
+    L l;
+    R r;
+};
+
+template<class L, class R>
+struct expr_divide
+{
+    using lunit = typename L::unit_type;
+    using runit = typename R::unit_type;
+    using unit_type = decltype(lunit{} / runit{});
+    using value_type = decltype(std::declval<typename L::value_type>() / std::declval<typename R::value_type>());
+    template<class Target>
+    using left_target = decltype(Target{} * runit{});
+    template<class Target>
+    using right_target = decltype(lunit{} / Target{});
+    template<class Target>
+    static constexpr expr_strategy strategy = choose_strategy<Target, unit_type, value_type, L, R>(
+        L::template cost<left_target<Target>> + R::template cost<runit>,
+        L::template cost<lunit> + R::template cost<right_target<Target>>);
+    template<class Target>
+    static constexpr int cost =
+        strategy<Target> == expr_strategy::left? L::template cost<left_target<Target>> + R::template cost<runit> :
+        strategy<Target> == expr_strategy::right? L::template cost<lunit> + R::template cost<right_target<Target>> :
+        L::template cost<lunit> + R::template cost<runit> + conversion_cost<unit_type, Target, value_type>;
+    template<class Target>
+    constexpr value_type eval() const
+    {
+        if constexpr(strategy<Target> == expr_strategy::left)
+            return l.template eval<left_target<Target>>() / r.template eval<runit>();
+        else if constexpr(strategy<Target> == expr_strategy::right)
+            return l.template eval<lunit>() / r.template eval<right_target<Target>>();
+        else
+            return convert_value<value_type, unit_type, Target>(l.template eval<lunit>() / r.template eval<runit>());
+    }
+    L l;
+    R r;
+};
+
+struct expr_plus { template<class T, class U> static constexpr auto apply(T&& t, U&& u) { return t + u; } };
+struct expr_minus { template<class T, class U> static constexpr auto apply(T&& t, U&& u) { return t - u; } };
+
+// A sum is in the common_unit of its operands, like the eager operators.
+// Either both operands are converted to Target, or the sum is converted once.
+template<class Op, class L, class R>
+struct expr_sum
+{
+    using lunit = typename L::unit_type;
+    using runit = typename R::unit_type;
+    static_assert(std::is_same<dimension_check<lunit>, dimension_check<runit>>::value,
+        "Cannot add quantities with different dimensions.");
+    using value_type = decltype(Op::apply(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()));
+    using unit_type = common_unit_t<lunit, runit, !std::is_floating_point<scalar_type_t<value_type>>::value>;
+    template<class Target>
+    static constexpr bool convert_operands =
+        L::template cost<Target> + R::template cost<Target> <=
+        L::template cost<unit_type> + R::template cost<unit_type> + conversion_cost<unit_type, Target, value_type>;
+    template<class Target>
+    static constexpr int cost = convert_operands<Target>?
+        L::template cost<Target> + R::template cost<Target> :
+        L::template cost<unit_type> + R::template cost<unit_type> + conversion_cost<unit_type, Target, value_type>;
+    template<class Target>
+    constexpr value_type eval() const
+    {
+        if constexpr(convert_operands<Target>)
+            return Op::apply(l.template eval<Target>(), r.template eval<Target>());
+        else
+            return convert_value<value_type, unit_type, Target>(Op::apply(l.template eval<unit_type>(), r.template eval<unit_type>()));
+    }
+    L l;
+    R r;
+};
+
+template<class E>
+struct expr_negate
+{
+    using unit_type = typename E::unit_type;
+    using value_type = decltype(-std::declval<typename E::value_type>());
+    template<class Target>
+    static constexpr int cost = E::template cost<Target>;
+    template<class Target>
+    constexpr value_type eval() const { return -e.template eval<Target>(); }
+    E e;
+};
+
+template<class T>
+struct is_quantity_expression : std::false_type {};
+template<class E>
+struct is_quantity_expression<quantity_expression<E>> : std::true_type {};
+
+// Converts an operand of the expression operators to a node.
+template<class E>
+constexpr const E& as_expr_node(const quantity_expression<E>& e) { return e.node(); }
+template<auto Unit, class T>
+constexpr expr_leaf<std::remove_cv_t<decltype(Unit)>, T> as_expr_node(const quantity<Unit, T>& q) { return { q.value() }; }
+template<class T, class = requires_numeric<T>>
+constexpr expr_leaf<dimensionless, T> as_expr_node(const T& x) { return { x }; }
+
+template<class T>
+using expr_node_t = std::remove_cv_t<std::remove_reference_t<decltype(::boost::units2::detail::as_expr_node(std::declval<const T&>()))>>;
+
+// At least one operand is an expression, and the other is an expression,
+// a quantity or a number.  The second check is only made when the first
+// succeeds, which keeps these operators cheap for everything else.
+template<class T, class U, bool = is_quantity_expression<T>::value || is_quantity_expression<U>::value>
+struct expression_operands {};
+template<class T, class U>
+struct expression_operands<T, U, true> { using type = expr_node_t<std::conditional_t<is_quantity_expression<T>::value, U, T>>; };
+
+template<class T, class U>
+using requires_expression_operands = typename expression_operands<T, U>::type;
+
+template<template<class...> class Node, class... A, class T, class U>
+constexpr auto make_expression(const T& t, const U& u)
+{
+    using node = Node<A..., expr_node_t<T>, expr_node_t<U>>;
+    return quantity_expression<node>(node{ as_expr_node(t), as_expr_node(u) });
+}
+
+}
+
+/**
+ * A lazily evaluated quantity expression.  Create one with lazy().
+ * Converting it to a quantity evaluates it in the unit of that quantity.
+ * The conversion is implicit if the unit is the natural unit of the
+ * expression (the product of the units for products, and the
+ * common_unit of the operands for sums), and explicit otherwise.
+ */
+template<class E>
+class quantity_expression
+{
+public:
+    using unit_type = typename E::unit_type;
+    using value_type = typename E::value_type;
+    explicit constexpr quantity_expression(const E& e) : node_(e) {}
+    static constexpr auto unit() -> unit_type { return {}; }
+    template<auto Unit, class T>
+    constexpr explicit(!std::is_same<std::remove_cv_t<decltype(Unit)>, unit_type>::value) operator quantity<Unit, T>() const
+    {
+        using target = std::remove_cv_t<decltype(Unit)>;
+        static_assert(std::is_same<detail::dimension_check<target>, detail::dimension_check<unit_type>>::value,
+            "Cannot convert units with different dimensions.");
+        return quantity<Unit, T>::from_value(static_cast<T>(node_.template eval<target>()));
+    }
+    /// INTERNAL ONLY
+    constexpr const E& node() const { return node_; }
+private:
+    E node_;
+};
+
+/// Starts a lazy expression.
+template<auto Unit, class T>
+constexpr auto lazy(const quantity<Unit, T>& q)
+{
+    using node = detail::expr_leaf<std::remove_cv_t<decltype(Unit)>, T>;
+    return quantity_expression<node>(node{ q.value() });
+}
+
+/// Evaluates e in its natural unit.
+template<class E>
+constexpr auto evaluate(const quantity_expression<E>& e) -> quantity<(typename E::unit_type{}), typename E::value_type>
+{
+    return e;
+}
+
+/// Evaluates e in Unit.
+template<auto Unit, class E>
+constexpr auto evaluate(const quantity_expression<E>& e) -> quantity<Unit, typename E::value_type>
+{
+    return quantity<Unit, typename E::value_type>(e);
+}
+
+template<class T, class U, class = detail::requires_expression_operands<T, U>>
+constexpr auto operator*(const T& t, const U& u)
+{ return detail::make_expression<detail::expr_multiply>(t, u); }
+
+template<class T, class U, class = detail::requires_expression_operands<T, U>>
+constexpr auto operator/(const T& t, const U& u)
+{ return detail::make_expression<detail::expr_divide>(t, u); }
+
+template<class T, class U, class = detail::requires_expression_operands<T, U>>
+constexpr auto operator+(const T& t, const U& u)
+{ return detail::make_expression<detail::expr_sum, detail::expr_plus>(t, u); }
+
+template<class T, class U, class = detail::requires_expression_operands<T, U>>
+constexpr auto operator-(const T& t, const U& u)
+{ return detail::make_expression<detail::expr_sum, detail::expr_minus>(t, u); }
+
+template<class E>
+constexpr auto operator-(const quantity_expression<E>& e)
+{ return quantity_expression<detail::expr_negate<E>>(detail::expr_negate<E>{ e.node() }); }
+
+}
+}
+
+#endif
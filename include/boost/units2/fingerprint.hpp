@@ -0,0 +1,83 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_FINGERPRINT_HPP_INCLUDED
+#define BOOST_UNITS2_FINGERPRINT_HPP_INCLUDED
+
+#include <boost/units2/unit.hpp>
+#include <boost/units2/detail/unit_name.hpp>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace boost {
+namespace units2 {
+namespace detail {
+
+// 64 bit FNV-1a over the canonical spelling of the unit.  Non-ratio
+// scales are hashed by their bit pattern instead of their text,
+// since formatting a double is not a constant expression.
+struct fnv1a_sink {
+    std::uint64_t hash = 0xcbf29ce484222325u;
+    constexpr void put_byte(unsigned char c)
+    {
+        hash ^= c;
+        hash *= 0x100000001b3u;
+    }
+    constexpr void put(std::string_view s)
+    {
+        for(char c : s) put_byte(static_cast<unsigned char>(c));
+    }
+    constexpr void put_integer(std::intmax_t x)
+    {
+        char buf[24];
+        char* p = buf + sizeof(buf);
+        std::uintmax_t n = x < 0? 0 - static_cast<std::uintmax_t>(x) : static_cast<std::uintmax_t>(x);
+        do { *--p = static_cast<char>('0' + n % 10); n /= 10; } while(n != 0);
+        if(x < 0) *--p = '-';
+        put(std::string_view(p, static_cast<std::size_t>(buf + sizeof(buf) - p)));
+    }
+    constexpr void put_real(double x)
+    {
+        std::uint64_t bits = std::bit_cast<std::uint64_t>(x);
+        for(int i = 0; i < 8; ++i) put_byte(static_cast<unsigned char>(bits >> (8 * i)));
+    }
+};
+
+template<class T>
+constexpr std::uint64_t compute_fingerprint()
+{
+    fnv1a_sink sink;
+    ::boost::units2::detail::put_unit_name<T>(sink, false);
+    return sink.hash;
+}
+
+}
+
+/**
+ * A 64 bit hash of the normalized form of the unit T.  Since every
+ * unit has exactly one normalized type, two units that are the same
+ * always have the same fingerprint, regardless of how they were
+ * spelled in the source.  Different units have different fingerprints,
+ * except in the case of a hash collision, or if they have the same
+ * canonical spelling (see detail/unit_name.hpp), as do two units that
+ * BOOST_UNITS2_DEF defines with the same name in different namespaces.
+ * conversion_table rejects both cases at compile time.  Fingerprints
+ * that meet only at run time, in a unit_registry, a wire message or
+ * a columnar file, cannot be checked, so every unit that is exchanged
+ * must have a distinct name.
+ */
+template<class T>
+inline constexpr std::uint64_t fingerprint_v = detail::compute_fingerprint<std::remove_cv_t<T>>();
+
+template<class T, class = detail::requires_unit<T>>
+constexpr std::uint64_t fingerprint(T) { return fingerprint_v<T>; }
+
+}
+}
+
+#endif
@@ -0,0 +1,397 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_FORMAT_HPP_INCLUDED
+#define BOOST_UNITS2_FORMAT_HPP_INCLUDED
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/unit.hpp>
+#include <boost/units2/detail/unit_name.hpp>
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <ratio>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <version>
+#ifdef __cpp_lib_format
+#include <format>
+#endif
+
+// Text output for quantities.  A quantity is printed as its value,
+// a space and the symbol of its unit, e.g. "9.81 m/s²".
+//
+// The symbol is a UTF-8 string that is built at compile time from
+// the normalized type of the unit:
+//
+//   - Units with a unit_symbol (by default the name given to
+//     BOOST_UNITS2_DEF) print that symbol.
+//   - A named unit scaled by a power of ten that has an SI prefix
+//     prints the prefix, as in "km".  Other scales are printed in
+//     brackets, as in "[3600]·s".
+//   - Compound units print the factors with positive exponents,
+//     separated by "·", then "/" and the factors with negative
+//     exponents, as in "m·kg/s²" or "m/(s·A)".  Integer exponents
+//     are superscripts and other exponents are written as "^(1/2)".
+//     If there are no positive exponents, the negative exponents are
+//     printed as is, as in "s⁻¹".
+//   - Absolute units print their relative unit, followed by the
+//     offset of the zero, as in "K[+5463/20]", unless they have
+//     a unit_symbol.
+//   - Dimensionless quantities have an empty symbol and are printed
+//     without a suffix.
+//
+// Unlike detail::unit_name, the symbol is meant to be read and
+// need not be unique: "s⁻¹" is printed for both hertz and becquerel.
+//
+// Formatting does not allocate.  to_chars writes into a caller
+// provided buffer, std::formatter writes directly into the output
+// of std::format, and operator<< writes to the stream.
+
+namespace boost {
+namespace units2 {
+namespace detail {
+
+template<class T, class = void>
+struct has_unit_symbol : std::false_type {};
+template<class T>
+struct has_unit_symbol<T, std::void_t<decltype(unit_symbol<T>::value)>> : std::true_type {};
+
+inline constexpr const char* middle_dot = "\xC2\xB7";
+inline constexpr const char* superscript_minus = "\xE2\x81\xBB";
+inline constexpr const char* superscript_digits[] = {
+    "\xE2\x81\xB0", "\xC2\xB9", "\xC2\xB2", "\xC2\xB3", "\xE2\x81\xB4",
+    "\xE2\x81\xB5", "\xE2\x81\xB6", "\xE2\x81\xB7", "\xE2\x81\xB8", "\xE2\x81\xB9"
+};
+
+// The SI prefix for N/D, or a null pointer if there is none.
+constexpr const char* si_prefix(std::intmax_t n, std::intmax_t d)
+{
+    if(d == 1)
+    {
+        switch(n)
+        {
+        case 10: return "da";
+        case 100: return "h";
+        case 1000: return "k";
+        case 1000000: return "M";
+        case 1000000000: return "G";
+        case 1000000000000: return "T";
+        case 1000000000000000: return "P";
+        case 1000000000000000000: return "E";
+        }
+    }
+    else if(n == 1)
+    {
+        switch(d)
+        {
+        case 10: return "d";
+        case 100: return "c";
+        case 1000: return "m";
+        case 1000000: return "\xC2\xB5";
+        case 1000000000: return "n";
+        case 1000000000000: return "p";
+        case 1000000000000000: return "f";
+        case 1000000000000000000: return "a";
+        }
+    }
+    return nullptr;
+}
+
+template<class Scale>
+constexpr const char* scale_prefix(Scale) { return nullptr; }
+template<std::intmax_t N, std::intmax_t D>
+constexpr const char* scale_prefix(std::ratio<N, D>) { return ::boost::units2::detail::si_prefix(N, D); }
+
+template<class Sink>
+constexpr void put_superscript(Sink& out, std::intmax_t n)
+{
+    if(n < 0) { out.put(superscript_minus); n = -n; }
+    if(n >= 10) ::boost::units2::detail::put_superscript(out, n / 10);
+    out.put(superscript_digits[n % 10]);
+}
+
+template<class Sink>
+constexpr void put_exponent(Sink& out, std::intmax_t n, std::intmax_t d)
+{
+    if(d != 1)
+    {
+        out.put("^(");
+        out.put_integer(n);
+        out.put("/");
+        out.put_integer(d);
+        out.put(")");
+    }
+    else if(n != 1) ::boost::units2::detail::put_superscript(out, n);
+}
+
+template<class T, class Sink>
+constexpr void put_unit_symbol(Sink& out, bool nested);
+
+struct unit_symbol_impl
+{
+    template<class T>
+    struct apply_base {
+        template<class Sink>
+        static constexpr void put(Sink& out, bool) { out.put(T::name); }
+    };
+
+    template<class Base, class Scale>
+    struct apply_scaled {
+        template<class Sink>
+        static constexpr void put(Sink& out, bool nested)
+        {
+            constexpr const char* prefix = ::boost::units2::detail::scale_prefix(Scale());
+            if constexpr(prefix != nullptr && has_unit_symbol<Base>::value)
+            {
+                out.put(prefix);
+                out.put(unit_symbol<Base>::value);
+            }
+            else
+            {
+                if(nested) out.put("(");
+                out.put("[");
+                ::boost::units2::detail::put_scale(out, Scale());
+                out.put("]");
+                out.put(middle_dot);
+                ::boost::units2::detail::put_unit_symbol<Base>(out, true);
+                if(nested) out.put(")");
+            }
+        }
+    };
+
+    template<class... T>
+    struct apply_compound {
+        template<class Sink>
+        static constexpr void put(Sink& out, bool nested)
+        {
+            constexpr std::size_t positive = (0 + ... + (T::exponent::num > 0));
+            constexpr std::size_t negative = sizeof...(T) - positive;
+            if(nested && sizeof...(T) > 1) out.put("(");
+            bool first = true;
+            if constexpr(positive == 0)
+            {
+                (put_factor<typename T::base>(out, typename T::exponent(), 0, first), ...);
+            }
+            else
+            {
+                (put_factor<typename T::base>(out, typename T::exponent(), 1, first), ...);
+                if constexpr(negative != 0)
+                {
+                    out.put("/");
+                    if(negative > 1) out.put("(");
+                    first = true;
+                    (put_factor<typename T::base>(out, typename T::exponent(), -1, first), ...);
+                    if(negative > 1) out.put(")");
+                }
+            }
+            if(nested && sizeof...(T) > 1) out.put(")");
+        }
+    };
+
+    // sign selects the factors with positive (1) or negative (-1)
+    // exponents, or all factors (0).  The exponents of the denominator
+    // are negated, so that they are printed as positive.
+    template<class B, class Sink, std::intmax_t N, std::intmax_t D>
+    static constexpr void put_factor(Sink& out, std::ratio<N, D>, int sign, bool& first)
+    {
+        if(sign * N < 0) return;
+        if(!first) out.put(middle_dot);
+        first = false;
+        ::boost::units2::detail::put_unit_symbol<B>(out, true);
+        ::boost::units2::detail::put_exponent(out, sign == 0? N : sign * N, D);
+    }
+
+    template<class Unit, class Offset>
+    struct apply_absolute {
+        template<class Sink>
+        static constexpr void put(Sink& out, bool nested)
+        {
+            constexpr double offset = ::boost::units2::detail::get_value(Offset());
+            ::boost::units2::detail::put_unit_symbol<Unit>(out, nested);
+            if constexpr(offset != 0)
+            {
+                out.put(offset > 0? "[+" : "[");
+                ::boost::units2::detail::put_scale(out, Offset());
+                out.put("]");
+            }
+        }
+    };
+};
+
+template<class T, class Sink>
+constexpr void put_unit_symbol(Sink& out, bool nested)
+{
+    if constexpr(has_unit_symbol<T>::value)
+        out.put(unit_symbol<T>::value);
+    else
+        visit<unit_symbol_impl, T>::template put(out, nested);
+}
+
+// Counts the characters of a symbol, and also stores
+// them if data is not null.
+struct symbol_sink {
+    char* data = nullptr;
+    std::size_t size = 0;
+    constexpr void put(std::string_view s)
+    {
+        for(char c : s)
+        {
+            if(data) data[size] = c;
+            ++size;
+        }
+    }
+    constexpr void put_integer(std::intmax_t x)
+    {
+        char buf[24];
+        char* p = buf + sizeof(buf);
+        std::uintmax_t n = x < 0? 0 - static_cast<std::uintmax_t>(x) : static_cast<std::uintmax_t>(x);
+        do { *--p = static_cast<char>('0' + n % 10); n /= 10; } while(n != 0);
+        if(x < 0) *--p = '-';
+        put(std::string_view(p, static_cast<std::size_t>(buf + sizeof(buf) - p)));
+    }
+    // Six significant digits, as printf's %g, since std::to_chars
+    // cannot be used in a constant expression.
+    constexpr void put_real(double x)
+    {
+        if(x < 0) { put("-"); x = -x; }
+        if(x == 0) { put("0"); return; }
+        long double m = x;
+        int exponent = 0;
+        while(m >= 10) { m /= 10; ++exponent; }
+        while(m < 1) { m *= 10; --exponent; }
+        std::intmax_t value = static_cast<std::intmax_t>(m * 100000 + 0.5L);
+        if(value >= 1000000) { value /= 10; ++exponent; }
+        char digits[6];
+        for(int i = 5; i >= 0; --i) { digits[i] = static_cast<char>('0' + value % 10); value /= 10; }
+        std::size_t n = 6;
+        while(n > 1 && digits[n - 1] == '0') --n;
+        if(exponent < -4 || exponent >= 6)
+        {
+            put(std::string_view(digits, 1));
+            if(n > 1) { put("."); put(std::string_view(digits + 1, n - 1)); }
+            put("e");
+            put_integer(exponent);
+        }
+        else if(exponent < 0)
+        {
+            put("0.");
+            for(int i = -1; i > exponent; --i) put("0");
+            put(std::string_view(digits, n));
+        }
+        else
+        {
+            std::size_t integer_digits = static_cast<std::size_t>(exponent) + 1;
+            put(std::string_view(digits, std::min(n, integer_digits)));
+            for(std::size_t i = n; i < integer_digits; ++i) put("0");
+            if(n > integer_digits) { put("."); put(std::string_view(digits + integer_digits, n - integer_digits)); }
+        }
+    }
+};
+
+template<std::size_t N>
+struct symbol_string {
+    char data[N + 1] = {};
+    constexpr std::string_view view() const { return std::string_view(data, N); }
+};
+
+template<class T>
+constexpr std::size_t symbol_size()
+{
+    symbol_sink sink;
+    ::boost::units2::detail::put_unit_symbol<T>(sink, false);
+    return sink.size;
+}
+
+template<class T>
+constexpr symbol_string<symbol_size<T>()> make_symbol()
+{
+    symbol_string<symbol_size<T>()> result;
+    symbol_sink sink{ result.data };
+    ::boost::units2::detail::put_unit_symbol<T>(sink, false);
+    return result;
+}
+
+template<class T>
+inline constexpr auto symbol_storage = make_symbol<T>();
+
+}
+
+/// The symbol of the unit T, as described at the top of this file.
+template<class T>
+inline constexpr std::string_view symbol_v = detail::symbol_storage<std::remove_cv_t<T>>.view();
+
+template<class T, class = detail::requires_unit<T>>
+constexpr std::string_view symbol(T) { return symbol_v<T>; }
+
+/**
+ * Writes q to [first, last) as std::to_chars writes its value, followed
+ * by a space and the symbol of its unit.  args are passed on to
+ * std::to_chars, e.g. std::chars_format::fixed and a precision.  On
+ * failure, returns { last, std::errc::value_too_large }, and the
+ * contents of [first, last) are unspecified.
+ */
+template<auto Unit, class T, class... Args>
+std::to_chars_result to_chars(char* first, char* last, const quantity<Unit, T>& q, Args... args)
+{
+    std::to_chars_result result = std::to_chars(first, last, q.value(), args...);
+    constexpr std::string_view s = symbol_v<decltype(Unit)>;
+    if constexpr(!s.empty())
+    {
+        if(result.ec != std::errc()) return result;
+        if(static_cast<std::size_t>(last - result.ptr) < s.size() + 1)
+            return { last, std::errc::value_too_large };
+        *result.ptr++ = ' ';
+        result.ptr = std::copy(s.begin(), s.end(), result.ptr);
+    }
+    return result;
+}
+
+/// Writes the value of q, then a space and the symbol.  The
+/// formatting flags of os only apply to the value.
+template<auto Unit, class T>
+std::ostream& operator<<(std::ostream& os, const quantity<Unit, T>& q)
+{
+    os << q.value();
+    constexpr std::string_view s = symbol_v<decltype(Unit)>;
+    if constexpr(!s.empty())
+    {
+        os.put(' ');
+        os.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+    return os;
+}
+
+}
+}
+
+#ifdef __cpp_lib_format
+
+/// Formats the value with the format spec of T, then a space
+/// and the symbol, e.g. std::format("{:.2f}", q) gives "1.50 km".
+template<auto Unit, class T>
+struct std::formatter<::boost::units2::quantity<Unit, T>, char> : std::formatter<T, char>
+{
+    template<class FormatContext>
+    auto format(const ::boost::units2::quantity<Unit, T>& q, FormatContext& ctx) const
+    {
+        auto out = std::formatter<T, char>::format(q.value(), ctx);
+        constexpr std::string_view s = ::boost::units2::symbol_v<decltype(Unit)>;
+        if constexpr(!s.empty())
+        {
+            *out++ = ' ';
+            out = std::copy(s.begin(), s.end(), out);
+        }
+        return out;
+    }
+};
+
+#endif
+
+#endif
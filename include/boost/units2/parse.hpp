@@ -0,0 +1,670 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_PARSE_HPP_INCLUDED
+#define BOOST_UNITS2_PARSE_HPP_INCLUDED
+
+#include <boost/units2/format.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <boost/units2/base_dimension.hpp>
+#include <boost/units2/detail/integer_convert.hpp>
+#include <boost/units2/detail/rational.hpp>
+#include <boost/mp11/algorithm.hpp>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ratio>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+// Parsing of quantities with a statically known unit, such as
+// "12.5 km/h" into quantity<meter / second>.
+//
+// The accepted spellings of units are listed in a symbol_table, which
+// is built at compile time.  The spellings are resolved by a perfect
+// hash, so a lookup hashes the text once, reads two small arrays and
+// compares the text with a single candidate.  Each entry of a table is
+// one of
+//
+//   unit                the unit, spelled as symbol_v<unit> (format.hpp)
+//   spelled<"s", unit>  the unit, spelled as s
+//   prefixed<e>         the entry e, and e with every SI prefix
+//
+// The conversion from each entry to the unit of the target quantity is
+// folded at compile time, so after the lookup, the value is converted
+// with a single multiply, as by the constructor of quantity.
+//
+// Text that is not an entry is parsed as a product of entries, with
+// integer exponents, such as "km/h", "kg·m/s²" or "m*s^-1".  This
+// accepts what format.hpp prints, except fractional exponents.  The
+// dimension and scale of each entry are precomputed, so parsing costs
+// one lookup per symbol, and the dimension is checked and the factor
+// composed at run time.  Absolute units, and units whose dimensions
+// are not in dimensions.hpp, are only accepted as a single entry.
+//
+// Nothing is allocated.
+
+namespace boost {
+namespace units2 {
+namespace detail {
+
+// A string literal as a template argument.
+template<std::size_t N>
+struct fixed_string {
+    char data[N] = {};
+    constexpr fixed_string(const char (&s)[N])
+    {
+        for(std::size_t i = 0; i < N; ++i) data[i] = s[i];
+    }
+    constexpr std::string_view view() const { return std::string_view(data, N - 1); }
+};
+
+}
+
+/// Unit, spelled as Symbol.  See symbol_table.
+template<detail::fixed_string Symbol, auto Unit>
+struct spelled_unit {};
+template<detail::fixed_string Symbol, auto Unit>
+inline constexpr spelled_unit<Symbol, Unit> spelled{};
+
+/// Entry and Entry with every SI prefix.  See symbol_table.
+template<auto Entry>
+struct prefixed_unit {};
+template<auto Entry>
+inline constexpr prefixed_unit<Entry> prefixed{};
+
+namespace detail {
+
+template<class Unit, class Symbol>
+struct symbol_entry {
+    using unit = Unit;
+    static constexpr std::string_view symbol = Symbol::value;
+};
+
+template<class Unit>
+struct default_symbol { static constexpr std::string_view value = symbol_v<Unit>; };
+template<fixed_string S>
+struct literal_symbol { static constexpr std::string_view value = S.view(); };
+
+// The prefix P followed by the symbol of E.
+template<std::string_view const& P, class E>
+struct prefixed_symbol {
+    static constexpr symbol_string<P.size() + E::symbol.size()> make()
+    {
+        symbol_string<P.size() + E::symbol.size()> result;
+        symbol_sink sink{ result.data };
+        sink.put(P);
+        sink.put(E::symbol);
+        return result;
+    }
+    static constexpr auto storage = make();
+    static constexpr std::string_view value = storage.view();
+};
+
+template<class Ratio>
+inline constexpr std::string_view prefix_symbol = ::boost::units2::detail::si_prefix(Ratio::num, Ratio::den);
+// ASCII and Greek spellings of micro.
+inline constexpr std::string_view micro_ascii = "u";
+inline constexpr std::string_view micro_greek = "\xCE\xBC";
+
+template<class Ratio, class E, std::string_view const& P = prefix_symbol<Ratio>>
+using prefixed_entry = symbol_entry<decltype(Ratio() * typename E::unit()), prefixed_symbol<P, E>>;
+
+// Yotta, zetta, zepto and yocto do not fit in std::intmax_t.
+template<class E>
+using with_prefixes = mp11::mp_list<E,
+    prefixed_entry<std::atto, E>, prefixed_entry<std::femto, E>, prefixed_entry<std::pico, E>,
+    prefixed_entry<std::nano, E>, prefixed_entry<std::micro, E>, prefixed_entry<std::micro, E, micro_ascii>,
+    prefixed_entry<std::micro, E, micro_greek>, prefixed_entry<std::milli, E>, prefixed_entry<std::centi, E>,
+    prefixed_entry<std::deci, E>, prefixed_entry<std::deca, E>, prefixed_entry<std::hecto, E>,
+    prefixed_entry<std::kilo, E>, prefixed_entry<std::mega, E>, prefixed_entry<std::giga, E>,
+    prefixed_entry<std::tera, E>, prefixed_entry<std::peta, E>, prefixed_entry<std::exa, E>>;
+
+// The list of symbol_entries for an argument of symbol_table.
+template<class T>
+struct symbol_entries_impl { using type = mp11::mp_list<symbol_entry<T, default_symbol<T>>>; };
+template<fixed_string S, auto Unit>
+struct symbol_entries_impl<spelled_unit<S, Unit>> {
+    using type = mp11::mp_list<symbol_entry<std::remove_cv_t<decltype(Unit)>, literal_symbol<S>>>;
+};
+template<auto Entry>
+struct symbol_entries_impl<prefixed_unit<Entry>> {
+    using entries = typename symbol_entries_impl<std::remove_cv_t<decltype(Entry)>>::type;
+    static_assert(mp11::mp_size<entries>::value == 1, "prefixed applies to a single unit.");
+    using type = with_prefixes<mp11::mp_front<entries>>;
+};
+template<class T>
+using symbol_entries = typename symbol_entries_impl<std::remove_cv_t<T>>::type;
+template<class E>
+using entry_unit = typename E::unit;
+
+// The perfect hash is a two level scheme (hash and displace).  The
+// hash of a symbol selects a bucket, and the displacement of the
+// bucket is mixed into the hash to select a slot.  The displacements
+// are chosen at compile time so that no two symbols share a slot.
+
+// The finalizer of MurmurHash3.
+constexpr std::uint64_t mix_hash(std::uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdu;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53u;
+    x ^= x >> 33;
+    return x;
+}
+
+// FNV-1a, mixed, since the bits of FNV-1a are poorly
+// distributed for strings as short as most symbols.
+constexpr std::uint64_t symbol_hash(std::string_view s)
+{
+    std::uint64_t result = 0xcbf29ce484222325u;
+    for(char c : s)
+    {
+        result ^= static_cast<unsigned char>(c);
+        result *= 0x100000001b3u;
+    }
+    return ::boost::units2::detail::mix_hash(result);
+}
+
+constexpr std::size_t symbol_bucket(std::uint64_t hash, std::size_t buckets)
+{
+    return static_cast<std::size_t>(hash >> 32) & (buckets - 1);
+}
+
+constexpr std::size_t symbol_slot(std::uint64_t hash, std::uint32_t displacement, std::size_t capacity)
+{
+    return static_cast<std::size_t>(::boost::units2::detail::mix_hash(hash + displacement * 0x9e3779b97f4a7c15u)) & (capacity - 1);
+}
+
+constexpr std::size_t power_of_two_at_least(std::size_t n)
+{
+    std::size_t result = 1;
+    while(result < n) result *= 2;
+    return result;
+}
+
+template<std::size_t B, std::size_t M>
+struct perfect_hash {
+    static constexpr std::size_t buckets = B;
+    static constexpr std::size_t capacity = M;
+    std::array<std::uint32_t, B> displacement{};
+    // The index of the symbol in each slot plus one, or 0 if the slot is empty.
+    std::array<std::uint32_t, M> slots{};
+    bool duplicate = false;
+};
+
+template<std::size_t N>
+constexpr auto make_perfect_hash(const std::array<std::string_view, N>& keys)
+{
+    constexpr std::size_t B = ::boost::units2::detail::power_of_two_at_least(N / 2 + 1);
+    constexpr std::size_t M = ::boost::units2::detail::power_of_two_at_least(2 * N + 1);
+    perfect_hash<B, M> result;
+    std::array<std::uint64_t, N + 1> hash{};
+    // Sort the keys by bucket.  The keys of bucket b are
+    // members[first[b]] to members[first[b + 1] - 1].
+    std::array<std::size_t, B + 1> first{};
+    std::size_t largest = 0;
+    for(std::size_t i = 0; i < N; ++i)
+    {
+        hash[i] = ::boost::units2::detail::symbol_hash(keys[i]);
+        std::size_t n = ++first[::boost::units2::detail::symbol_bucket(hash[i], B) + 1];
+        if(n > largest) largest = n;
+    }
+    for(std::size_t b = 0; b < B; ++b) first[b + 1] += first[b];
+    std::array<std::size_t, N + 1> members{};
+    std::array<std::size_t, B> filled{};
+    for(std::size_t i = 0; i < N; ++i)
+    {
+        std::size_t b = ::boost::units2::detail::symbol_bucket(hash[i], B);
+        members[first[b] + filled[b]++] = i;
+    }
+    // Place the largest buckets first, while the table is emptiest.
+    std::array<std::size_t, N + 1> chosen{};
+    for(std::size_t size = largest; size > 0; --size)
+    {
+        for(std::size_t b = 0; b < B; ++b)
+        {
+            if(first[b + 1] - first[b] != size) continue;
+            const std::size_t* bucket = &members[first[b]];
+            // Equal symbols can never be separated.
+            for(std::size_t i = 0; i < size; ++i)
+                for(std::size_t j = i + 1; j < size; ++j)
+                    if(keys[bucket[i]] == keys[bucket[j]]) { result.duplicate = true; return result; }
+            for(std::uint32_t d = 0;; ++d)
+            {
+                bool ok = true;
+                for(std::size_t i = 0; i < size && ok; ++i)
+                {
+                    chosen[i] = ::boost::units2::detail::symbol_slot(hash[bucket[i]], d, M);
+                    if(result.slots[chosen[i]] != 0) ok = false;
+                    for(std::size_t j = 0; j < i && ok; ++j)
+                        if(chosen[j] == chosen[i]) ok = false;
+                }
+                if(!ok) continue;
+                result.displacement[b] = d;
+                for(std::size_t i = 0; i < size; ++i)
+                    result.slots[chosen[i]] = static_cast<std::uint32_t>(bucket[i] + 1);
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+template<class... E>
+constexpr std::array<std::string_view, sizeof...(E)> make_symbols(mp11::mp_list<E...>)
+{
+    return { E::symbol... };
+}
+
+}
+
+/**
+ * The spellings of units accepted by from_chars.  Entries may be
+ * units, spelled<"symbol", unit> or prefixed<entry>, e.g.
+ * \code
+ * using speed_symbols = symbol_table<
+ *     prefixed<si::meter / si::second>,
+ *     spelled<"km/h", std::kilo() * si::meter / (std::ratio<3600>() * si::second)>,
+ *     spelled<"mph", mile / hour>>;
+ * \endcode
+ * The same unit may be listed under several spellings, but no
+ * spelling may be listed twice.
+ */
+template<auto... Entries>
+class symbol_table {
+    using entries = mp11::mp_append<mp11::mp_list<>, detail::symbol_entries<decltype(Entries)>...>;
+public:
+    static constexpr std::size_t size = mp11::mp_size<entries>::value;
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+    /// The spelling of each entry.
+    static constexpr std::array<std::string_view, size> symbols = detail::make_symbols(entries());
+    /// The unit of each entry.
+    using units = mp11::mp_transform<detail::entry_unit, entries>;
+    template<std::size_t I>
+    using unit_at = typename mp11::mp_at_c<entries, I>::unit;
+
+private:
+    static constexpr auto hash = detail::make_perfect_hash(symbols);
+    static_assert(!hash.duplicate, "A symbol appears more than once in a symbol_table.");
+
+public:
+    /// Returns the index of the entry spelled s, or npos.
+    static constexpr std::size_t find(std::string_view s) noexcept
+    {
+        const std::uint64_t h = detail::symbol_hash(s);
+        const std::uint32_t d = hash.displacement[detail::symbol_bucket(h, hash.buckets)];
+        const std::uint32_t i = hash.slots[detail::symbol_slot(h, d, hash.capacity)];
+        return (i != 0 && symbols[i - 1] == s)? i - 1 : npos;
+    }
+    static constexpr bool contains(std::string_view s) noexcept { return find(s) != npos; }
+};
+
+/// The symbols of si.hpp, and the units min, h and d.  Every
+/// unit except min, h and d accepts the SI prefixes, including u
+/// and μ for micro.  Ohm is spelled Ω or ohm.
+using si_symbol_table = symbol_table<
+    prefixed<si::meter>, prefixed<si::gram>, prefixed<si::second>, prefixed<si::kelvin>,
+    prefixed<si::mole>, prefixed<si::ampere>, prefixed<si::candela>, prefixed<si::radian>,
+    prefixed<si::steradian>, prefixed<spelled<"Hz", si::hertz>>, prefixed<spelled<"N", si::newton>>,
+    prefixed<spelled<"Pa", si::pascal>>, prefixed<spelled<"J", si::joule>>, prefixed<spelled<"W", si::watt>>,
+    prefixed<spelled<"C", si::couloumb>>, prefixed<spelled<"V", si::volt>>, prefixed<spelled<"F", si::farad>>,
+    prefixed<spelled<"ohm", si::ohm>>, prefixed<spelled<"\xCE\xA9", si::ohm>>, prefixed<spelled<"S", si::siemens>>,
+    prefixed<spelled<"Wb", si::weber>>, prefixed<spelled<"T", si::tesla>>, prefixed<spelled<"H", si::henry>>,
+    prefixed<spelled<"lm", si::lumen>>, prefixed<spelled<"lx", si::lux>>, prefixed<spelled<"Bq", si::becquerel>>,
+    prefixed<spelled<"Gy", si::gray>>, prefixed<spelled<"Sv", si::sievert>>, prefixed<spelled<"kat", si::katal>>,
+    spelled<"min", std::ratio<60>() * si::second>, spelled<"h", std::ratio<3600>() * si::second>,
+    spelled<"d", std::ratio<86400>() * si::second>>;
+
+namespace detail {
+
+template<class From, class To>
+inline constexpr bool parse_compatible =
+    std::is_same<dimension_check<From>, dimension_check<To>>::value &&
+    is_absolute_unit<From>::value == is_absolute_unit<To>::value;
+
+template<class T, class From, class To>
+T parse_convert(const T& x) { return ::boost::units2::detail::convert_to<T, void>(From(), To(), x); }
+
+// Floating point values in relative units are converted by a
+// table of factors.  0 marks entries of other dimensions.  Other
+// values are converted by a table of functions.
+template<class T, class To>
+inline constexpr bool parse_by_factor = std::is_floating_point<T>::value && !is_absolute_unit<To>::value;
+
+template<class T, class To>
+using parse_conversion_t = mp11::mp_if_c<parse_by_factor<T, To>, choose_scale_type<void, T>, T(*)(const T&)>;
+
+template<class T, class To, class From>
+constexpr parse_conversion_t<T, To> parse_conversion()
+{
+    if constexpr(!parse_compatible<From, To>) return {};
+    else if constexpr(parse_by_factor<T, To>) return ::boost::units2::conversion_factor<choose_scale_type<void, T>>(From(), To());
+    else return &parse_convert<T, From, To>;
+}
+
+template<class T, class To, class... From>
+constexpr std::array<parse_conversion_t<T, To>, sizeof...(From)> make_parse_conversions(mp11::mp_list<From...>)
+{
+    return { parse_conversion<T, To, From>()... };
+}
+
+template<class Table, class To, class T>
+inline constexpr auto parse_conversions = make_parse_conversions<T, To>(typename Table::units());
+
+constexpr bool is_parse_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+// A unit that is composed at run time from the entries of a table: the
+// exponents of its dimension and its scale relative to the base units.
+// As in runtime_unit, the scale is an exact rational times a floating
+// point factor, which is 1 unless some entry has an irrational scale,
+// or the rational part overflowed.  Only integer exponents are needed,
+// and they are kept as plain integers, which is much cheaper than
+// rationals.
+struct parsed_unit {
+    static constexpr std::intmax_t max_exponent = 1 << 20;
+
+    std::array<std::intmax_t, base_dimension_count> exponents{};
+    rational scale = 1;
+    double irrational_scale = 1;
+    // Whether the unit can be used in a compound unit.  Absolute
+    // units, dimensions outside dimensions.hpp and fractional
+    // exponents cannot.
+    bool composable = false;
+
+    // Multiplies by other^n.  Returns false if an exponent is too large.
+    // \pre |n| <= 1000
+    constexpr bool multiply(const parsed_unit& other, std::intmax_t n)
+    {
+        for(std::size_t i = 0; i < base_dimension_count; ++i)
+        {
+            exponents[i] += other.exponents[i] * n;
+            if(exponents[i] > max_exponent || exponents[i] < -max_exponent) return false;
+        }
+        if(other.scale == rational(1) && other.irrational_scale == 1) return true;
+        for(std::intmax_t k = 0; k < (n < 0? -n : n); ++k)
+        {
+            const rational next = n < 0? scale / other.scale : scale * other.scale;
+            if(next.valid()) scale = next;
+            else
+            {
+                irrational_scale *= n < 0? scale.value() / other.scale.value() : scale.value() * other.scale.value();
+                scale = 1;
+            }
+            irrational_scale = n < 0? irrational_scale / other.irrational_scale : irrational_scale * other.irrational_scale;
+        }
+        return true;
+    }
+};
+
+template<class U>
+constexpr parsed_unit make_parsed_unit()
+{
+    parsed_unit result;
+    if constexpr(!is_absolute_unit<U>::value)
+    {
+        if constexpr(has_dimension_exponents<dimension_check<U>>::value)
+        {
+            using factor = typename fold_conversion<flatten_scale<U>>::type;
+            const dimension_exponents exponents = ::boost::units2::detail::exponents_of<U>();
+            for(std::size_t i = 0; i < base_dimension_count; ++i)
+            {
+                if(exponents[i].den != 1) return result;
+                result.exponents[i] = exponents[i].num;
+            }
+            if constexpr(is_std_ratio<factor>::value) result.scale = rational(factor());
+            else result.irrational_scale = ::boost::units2::detail::get_value<double>(factor());
+            result.composable = true;
+        }
+    }
+    return result;
+}
+
+template<class... U>
+constexpr std::array<parsed_unit, sizeof...(U)> make_parsed_units(mp11::mp_list<U...>)
+{
+    return { ::boost::units2::detail::make_parsed_unit<U>()... };
+}
+
+template<class Table>
+inline constexpr auto parsed_units = make_parsed_units(typename Table::units());
+
+// Parses a compound unit made of the symbols of Table:
+//
+//   unit     := power (("·" | "*") power | "/" power)*
+//   power    := primary exponent?
+//   primary  := symbol | "(" unit ")" | "[" integer ("/" integer)? "]"
+//   exponent := "^" "-"? integer | "^(" "-"? integer ")" | "⁻"? superscript+
+//
+// A / applies to the single power that follows it, so "m/s/s" is m/s².
+// This accepts every unit that format.hpp prints, except for
+// fractional exponents.
+template<class Table>
+class unit_expression_parser {
+public:
+    constexpr unit_expression_parser(const char* first, const char* last) : pos_(first), last_(last) {}
+    constexpr bool parse(parsed_unit& out)
+    {
+        return product(out) && pos_ == last_;
+    }
+private:
+    static constexpr int max_depth = 16;
+    static constexpr std::intmax_t max_exponent = 1000;
+
+    constexpr bool at(std::string_view s) const
+    {
+        return static_cast<std::size_t>(last_ - pos_) >= s.size() && std::string_view(pos_, s.size()) == s;
+    }
+    constexpr bool accept(std::string_view s)
+    {
+        if(!at(s)) return false;
+        pos_ += s.size();
+        return true;
+    }
+    // The middle dot and the superscripts are the only
+    // operators that start with these bytes.
+    constexpr bool at_multibyte_operator() const
+    {
+        return pos_ != last_ && (*pos_ == '\xC2' || *pos_ == '\xE2');
+    }
+    // The value of the superscript digit at pos_, or -1.
+    constexpr int superscript() const
+    {
+        if(at_multibyte_operator())
+            for(int d = 0; d < 10; ++d)
+                if(at(superscript_digits[d])) return d;
+        return -1;
+    }
+    constexpr bool at_symbol_char() const
+    {
+        if(pos_ == last_) return false;
+        if(at_multibyte_operator()) return !at(middle_dot) && !at(superscript_minus) && superscript() < 0;
+        const char c = *pos_;
+        return c != '*' && c != '/' && c != '^' && c != '(' && c != ')' && c != '[' && c != ']';
+    }
+    constexpr bool digits(std::intmax_t& out)
+    {
+        if(pos_ == last_ || *pos_ < '0' || *pos_ > '9') return false;
+        out = 0;
+        for(; pos_ != last_ && *pos_ >= '0' && *pos_ <= '9'; ++pos_)
+        {
+            out = out * 10 + (*pos_ - '0');
+            if(out > (std::numeric_limits<std::int32_t>::max)()) return false;
+        }
+        return true;
+    }
+
+    constexpr bool product(parsed_unit& out)
+    {
+        out = parsed_unit{};
+        out.composable = true;
+        parsed_unit term;
+        std::intmax_t n;
+        if(!power(term, n) || !out.multiply(term, n)) return false;
+        while(pos_ != last_ && *pos_ != ')')
+        {
+            std::intmax_t sign = 1;
+            if(accept("/")) sign = -1;
+            else if(!accept(middle_dot) && !accept("*")) return false;
+            if(!power(term, n) || !out.multiply(term, sign * n)) return false;
+        }
+        return true;
+    }
+    // Parses primary^n into out and n.
+    constexpr bool power(parsed_unit& out, std::intmax_t& n)
+    {
+        if(!primary(out)) return false;
+        n = 1;
+        if(accept("^"))
+        {
+            const bool parenthesized = accept("(");
+            const bool negative = accept("-");
+            if(!digits(n) || (parenthesized && !accept(")"))) return false;
+            if(negative) n = -n;
+        }
+        else if(at_multibyte_operator() && (at(superscript_minus) || superscript() >= 0))
+        {
+            const bool negative = accept(superscript_minus);
+            int d = superscript();
+            if(d < 0) return false;
+            n = 0;
+            for(; d >= 0; d = superscript())
+            {
+                pos_ += std::string_view(superscript_digits[d]).size();
+                n = n * 10 + d;
+                if(n > max_exponent) return false;
+            }
+            if(negative) n = -n;
+        }
+        return n != 0 && n >= -max_exponent && n <= max_exponent;
+    }
+    constexpr bool primary(parsed_unit& out)
+    {
+        if(accept("("))
+        {
+            if(++depth_ > max_depth || !product(out) || !accept(")")) return false;
+            --depth_;
+            return true;
+        }
+        if(accept("["))
+        {
+            std::intmax_t num, den = 1;
+            if(!digits(num) || num == 0 || (accept("/") && (!digits(den) || den == 0)) || !accept("]")) return false;
+            out = parsed_unit{};
+            out.scale = rational(num, den);
+            out.composable = true;
+            return true;
+        }
+        const char* start = pos_;
+        while(at_symbol_char()) ++pos_;
+        const std::size_t i = Table::find(std::string_view(start, static_cast<std::size_t>(pos_ - start)));
+        if(i == Table::npos) return false;
+        out = parsed_units<Table>[i];
+        return out.composable;
+    }
+
+    const char* pos_;
+    const char* last_;
+    int depth_ = 0;
+};
+
+// Converts value in the parsed unit from to To, which is composable.
+template<class To, class T>
+constexpr std::errc parsed_convert(const parsed_unit& from, const T& value, T& out)
+{
+    constexpr parsed_unit to = ::boost::units2::detail::make_parsed_unit<To>();
+    if(from.exponents != to.exponents) return std::errc::invalid_argument;
+    const rational exact = from.scale / to.scale;
+    const double irrational = from.irrational_scale / to.irrational_scale;
+    if constexpr(is_integer_value<T>)
+    {
+        // Integers are converted exactly, as by the constructor, unless the factor is irrational.
+        if(exact.valid() && irrational == 1)
+        {
+            integer_conversion_result<T> result = ::boost::units2::detail::integer_convert<T>(exact.num, exact.den, value);
+            if(result.overflow) return std::errc::result_out_of_range;
+            out = result.value;
+            return std::errc();
+        }
+    }
+    using scale_type = choose_scale_type<void, T>;
+    const scale_type factor = static_cast<scale_type>(exact.valid()? exact.value() * irrational :
+        from.scale.value() / to.scale.value() * irrational);
+    out = static_cast<T>(value * factor);
+    return std::errc();
+}
+
+}
+
+/**
+ * Parses a number followed by a unit from [first, last) into q.  The
+ * number is parsed by std::from_chars as a T.  It may be followed by
+ * spaces, and the unit is the text up to the next whitespace or last.
+ * The unit must be spelled as an entry of Table, or as a product of
+ * entries (see the top of this file), and have the same dimensions as
+ * the unit of q.  The value is converted to the unit of q as by the
+ * constructor of quantity.
+ *
+ * On success, returns a pointer to the end of the unit.  If the number
+ * cannot be parsed, returns the result of std::from_chars.  If the unit
+ * cannot be parsed, returns { first, std::errc::invalid_argument }, and
+ * if an integer converted from a product of entries does not fit in T,
+ * returns { first, std::errc::result_out_of_range }.  In every case of
+ * failure, q is unchanged.
+ */
+template<auto Unit, class T, auto... Entries>
+std::from_chars_result from_chars(const char* first, const char* last, quantity<Unit, T>& q, symbol_table<Entries...>)
+{
+    using table = symbol_table<Entries...>;
+    using to = std::remove_cv_t<decltype(Unit)>;
+    T value;
+    std::from_chars_result result = std::from_chars(first, last, value);
+    if(result.ec != std::errc()) return result;
+    const char* begin = result.ptr;
+    while(begin != last && *begin == ' ') ++begin;
+    const char* end = begin;
+    while(end != last && !detail::is_parse_space(*end)) ++end;
+    const std::size_t i = table::find(std::string_view(begin, static_cast<std::size_t>(end - begin)));
+    if(i == table::npos)
+    {
+        if constexpr(detail::make_parsed_unit<to>().composable)
+        {
+            detail::parsed_unit unit;
+            if(begin == end || !detail::unit_expression_parser<table>(begin, end).parse(unit))
+                return { first, std::errc::invalid_argument };
+            T converted;
+            if(std::errc ec = detail::parsed_convert<to>(unit, value, converted); ec != std::errc())
+                return { first, ec };
+            q = quantity<Unit, T>::from_value(converted);
+            return { end, std::errc() };
+        }
+        else return { first, std::errc::invalid_argument };
+    }
+    constexpr const auto& conversions = detail::parse_conversions<table, to, T>;
+    if(!conversions[i]) return { first, std::errc::invalid_argument };
+    if constexpr(detail::parse_by_factor<T, to>)
+        q = quantity<Unit, T>::from_value(value * conversions[i]);
+    else
+        q = quantity<Unit, T>::from_value(conversions[i](value));
+    return { end, std::errc() };
+}
+
+/// Parses with si_symbol_table.
+template<auto Unit, class T>
+std::from_chars_result from_chars(const char* first, const char* last, quantity<Unit, T>& q)
+{
+    return ::boost::units2::from_chars(first, last, q, si_symbol_table());
+}
+
+}
+}
+
+#endif
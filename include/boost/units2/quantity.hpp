@@ -8,35 +8,160 @@
 #define BOOST_UNITS2_QUANTITY_HPP_INCLUDED
 
 #include <boost/units2/unit.hpp>
+#include <boost/units2/detail/integer_convert.hpp>
 
 namespace boost {
 namespace units2 {
 
 using dimensionless = compound_unit<>;
 
+/**
+ * Describes the value types of quantities.  The primary template covers
+ * the arithmetic types, and any type with a numeric_limits
+ * specialization.  Specialize it for other numeric types, such as SIMD
+ * packs (see simd.hpp), with
+ *
+ *   is_numeric:   true, so that the type can multiply quantities and units
+ *   scalar_type:  the element type.  Conversion factors are applied to
+ *                 the whole value as a single scalar_type, and integer
+ *                 elements select the integer rules of common_unit and
+ *                 integer conversion by rational factors.
+ */
+template<class T, class = void>
+struct numeric_traits
+{
+    static constexpr bool is_numeric = std::numeric_limits<T>::is_specialized;
+    using scalar_type = T;
+};
+
 namespace detail {
 
 template<class T>
-using requires_dimensionless = mp11::mp_if_c<std::is_same<T, dimensionless>::value,void>;
+using requires_dimensionless = mp11::mp_if_c<std::is_same<std::remove_cv_t<T>, dimensionless>::value,void>;
+
+template<class T>
+using scalar_type_t = typename numeric_traits<std::remove_cv_t<std::remove_reference_t<T>>>::scalar_type;
 
+// The type in which conversion factors are applied to a value of type T.
+// Floating point values are scaled in the precision of their elements.
+template<class T, class = void>
+struct value_scale_type { using type = double; };
+template<class T>
+struct value_scale_type<T, std::enable_if_t<std::is_floating_point<scalar_type_t<T>>::value>> { using type = scalar_type_t<T>; };
+
+template<class S, class T>
+using choose_scale_type = mp11::mp_if<std::is_void<S>, typename value_scale_type<T>::type, S>;
+
+// Applies the conversion factor from From to To, evaluated in S.
+// An exact factor of 1 is elided, so that no conversion is done at all.
+template<class S, class From, class To, class T>
+constexpr auto apply_conversion(From, To, const T& x)
+{
+    constexpr S factor = ::boost::units2::conversion_factor<S>(From{}, To{});
+    if constexpr(factor == 1) return x;
+    else return x * factor;
 }
 
+// Units of absolute scales (absolute.hpp) mark themselves
+// with _boost_units2_is_absolute.
+template<class T, class = void>
+struct is_absolute_unit : std::false_type {};
+template<class T>
+struct is_absolute_unit<T, typename T::_boost_units2_is_absolute> : std::true_type {};
+
+// Defined in absolute.hpp.
+template<class T, class S, class From, class To, class X>
+constexpr T convert_absolute(From, To, const X& x);
+
+// Packs of integers, such as simd<int>, which cannot be multiplied
+// by a double.
+template<class T>
+inline constexpr bool is_integer_pack = !is_integer_value<T> && is_integer_value<scalar_type_t<T>>;
+
+// Computes x * N / D, truncated toward zero, in the elements of X.
+// Unlike integer_convert, there are no wider intermediates, so
+// (D - 1) * N must fit in an element.
+template<std::intmax_t N, std::intmax_t D, class X>
+constexpr X pack_convert(std::ratio<N, D>, const X& x)
+{
+    using E = scalar_type_t<X>;
+    static_assert(N > 0 && static_cast<std::uintmax_t>(N) <= static_cast<std::uintmax_t>((std::numeric_limits<E>::max)()) / D,
+        "The conversion factor is too large for the elements of the value_type.");
+    if constexpr(D == 1) return x * static_cast<E>(N);
+    else if constexpr(N == 1) return x / static_cast<E>(D);
+    else return x / static_cast<E>(D) * static_cast<E>(N) + x % static_cast<E>(D) * static_cast<E>(N) / static_cast<E>(D);
+}
+
+template<class T, class S, class From, class To, class X>
+constexpr T convert_relative(From, To, const X& x)
+{
+    using factor = conversion_ratio<From, To>;
+    if constexpr(is_rounding<S>::value || (std::is_void<S>::value && has_integer_conversion<X, T, factor>))
+    {
+        static_assert(has_integer_conversion<X, T, factor>,
+            "Rounding policies require integral values and a rational conversion factor.");
+        check_conversion<dimension_check<From>, dimension_check<To>>();
+        return integer_convert<T, mp11::mp_if<std::is_void<S>, rounding::toward_zero, S>>(factor(), x).value;
+    }
+    else if constexpr(std::is_void<S>::value && is_integer_pack<X> && is_std_ratio<factor>::value)
+    {
+        check_conversion<dimension_check<From>, dimension_check<To>>();
+        if constexpr(std::is_same<factor, std::ratio<1>>::value) return static_cast<T>(x);
+        else return static_cast<T>(pack_convert(factor(), x));
+    }
+    else return static_cast<T>(apply_conversion<choose_scale_type<S, T>>(From{}, To{}, x));
+}
+
+// Converts x from From to To and returns it as a T.  S is the type
+// that the factor is applied in, a rounding policy, or void.  Integers
+// are converted exactly whenever the factor is rational, unless S is
+// a floating point type, and are rounded by S, or toward zero by default,
+// as the floating point conversion would.  Absolute units are converted
+// by convert_absolute.
+template<class T, class S, class From, class To, class X>
+constexpr T convert_to(From, To, const X& x)
+{
+    if constexpr(is_absolute_unit<From>::value || is_absolute_unit<To>::value)
+        return convert_absolute<T, S>(From{}, To{}, x);
+    else return convert_relative<T, S>(From{}, To{}, x);
+}
+
+}
+
+/**
+ * A value of type T measured in Unit.
+ *
+ * Layout guarantee: quantity<Unit, T> has exactly one non-static data
+ * member, of type T, and no base classes with data.  It has the same
+ * size and alignment as T, is standard-layout whenever T is, and is
+ * trivially copyable whenever T is.  As a result an array of T
+ * can be viewed in place as an array of quantity<Unit, T> (see
+ * quantity_span.hpp).
+ */
 template<auto Unit, class T=double>
 class quantity {
 public:
     /// INTERNAL ONLY
     using _boost_units2_is_quantity = void;
     using unit_type = decltype(Unit);
+    using value_type = T;
     constexpr quantity() = default;
+    /// Converts from any unit with the same dimensions.  The conversion
+    /// factor is applied in T if T is a floating point type.  Integers
+    /// are converted exactly when the factor is rational, and the result
+    /// is truncated toward zero (see rounding.hpp).
+    template<auto Unit2, class T2>
+    explicit constexpr quantity(const quantity<Unit2, T2>& other)
+      : value_(detail::convert_to<T, void>(Unit2, Unit, other.value())) {}
     static constexpr quantity from_value(const T& x) { return quantity{x}; }
     static constexpr quantity from_value(T&& x) { return quantity{static_cast<T&&>(x)}; }
     constexpr const T& value() const & { return value_; }
-    constexpr T&& value() && { return value_; }
+    constexpr T&& value() && { return static_cast<T&&>(value_); }
     // Implicit conversion to the value_type is valid for dimensionless quantities
-    template<class = detail::requires_dimensionless<decltype(Unit)>>
+    template<class U = decltype(Unit), class = detail::requires_dimensionless<U>>
     constexpr operator const T& () const & { return value_; }
-    template<class = detail::requires_dimensionless<decltype(Unit)>>
-    constexpr operator T&& () && { return value_; }
+    template<class U = decltype(Unit), class = detail::requires_dimensionless<U>>
+    constexpr operator T&& () && { return static_cast<T&&>(value_); }
     static constexpr auto unit() -> decltype(Unit) { return {}; }
 private:
     explicit constexpr quantity(const T& x) : value_(x) {}
@@ -45,6 +170,15 @@ private:
 };
 
 namespace detail {
+
+// Checks the layout guarantee for a particular quantity.  Every
+// component that reinterprets arrays of T asserts this.
+template<class Q, class T = typename Q::value_type>
+inline constexpr bool has_value_layout =
+    sizeof(Q) == sizeof(T) && alignof(Q) == alignof(T) &&
+    std::is_standard_layout<Q>::value == std::is_standard_layout<T>::value &&
+    std::is_trivially_copyable<Q>::value == std::is_trivially_copyable<T>::value;
+
 // Helper to simplify construction.
 template<class T>
 struct from_value {
@@ -57,7 +191,7 @@ template<class T>
 from_value(T&&) -> from_value<T>;
 
 template<class T>
-using requires_numeric = ::boost::mp11::mp_if_c<std::numeric_limits<std::remove_reference_t<T>>::is_specialized, void>;
+using requires_numeric = ::boost::mp11::mp_if_c<numeric_traits<std::remove_cv_t<std::remove_reference_t<T>>>::is_numeric, void>;
 
 template<class T>
 using requires_quantity = typename std::remove_reference_t<T>::_boost_units2_is_quantity;
@@ -78,8 +212,27 @@ using requires_any_unit = visit<requires_any_unit_impl, T>;
 
 }
 
-// +-*/, unary +-
-// operator<=>
+/**
+ * Converts q to Unit without changing its value_type.  The conversion
+ * factor is applied in S, which defaults to the value_type for floating
+ * point types and to double otherwise.  For integral value types and a
+ * rational factor, the default is an exact integer conversion, truncated
+ * toward zero.  S may also be a rounding policy (see rounding.hpp), which
+ * selects the exact conversion and how it is rounded.  The result is
+ * unspecified if it does not fit in T.  See checked_quantity_cast in
+ * rounding.hpp.
+ */
+template<auto Unit, class S, auto Unit2, class T>
+constexpr quantity<Unit, T> quantity_cast(const quantity<Unit2, T>& q)
+{
+    return quantity<Unit, T>::from_value(detail::convert_to<T, S>(Unit2, Unit, q.value()));
+}
+// S defaults to void (see conversion_factor for why this is an overload).
+template<auto Unit, auto Unit2, class T>
+constexpr quantity<Unit, T> quantity_cast(const quantity<Unit2, T>& q)
+{
+    return ::boost::units2::quantity_cast<Unit, void>(q);
+}
 
 // Quantity * Quantity
 template<class T, class U, class=detail::requires_quantity<T>, class=detail::requires_quantity<U>>
@@ -96,10 +249,10 @@ constexpr auto operator*(T&& x, U&& q) -> quantity<dimensionless{} * decltype(q.
 
 // Unit * value
 template<class Unit, class T, class=detail::requires_any_unit<Unit>, class=detail::requires_numeric<T>>
-constexpr auto operator*(Unit, T&& x) -> quantity<Unit{}, T>
+constexpr auto operator*(Unit, T&& x) -> quantity<Unit{}, std::decay_t<T>>
 { return detail::from_value{static_cast<T&&>(x)}; }
 template<class Unit, class T, class=detail::requires_any_unit<Unit>, class=detail::requires_numeric<T>>
-constexpr auto operator*(T&& x, Unit) -> quantity<Unit{}, T>
+constexpr auto operator*(T&& x, Unit) -> quantity<Unit{}, std::decay_t<T>>
 { return detail::from_value{static_cast<T&&>(x)}; }
 
 // Quantity * Unit
@@ -110,19 +263,166 @@ template<class Unit1, class Q, class=detail::requires_unit<Unit1>, class=detail:
 constexpr auto operator*(Unit1, Q&& q) -> quantity<Unit1{} * decltype(q.unit()){}, std::decay_t<decltype(q.value())>>
 { return detail::from_value{static_cast<Q&&>(q).value()}; }
 
-// Quantity +- Quantity (other combinations are not supported for addition)
-template<class Q1, class Q2, class=detail::requires_quantity<Q1>, class=detail::requires_quantity<Q2>>
-constexpr auto operator+(Q1&& q1, Q2&& q2) -> quantity<decltype(q1.unit() + q2.unit()){}, decltype(q1.value() + q2.value())>
-{ return detail::from_value(static_cast<Q1&&>(q1).value() + static_cast<Q2&&>(q2).value()); }
-template<class Q1, class Q2, class=detail::requires_quantity<Q1>, class=detail::requires_quantity<Q2>>
-constexpr auto operator-(Q1&& q1, Q2&& q2) -> quantity<decltype(q1.unit() - q2.unit()){}, decltype(q1.value() + q2.value())>
-{ return detail::from_value(static_cast<Q1&&>(q1).value() - static_cast<Q2&&>(q2).value()); }
+// Quantity / Quantity
+template<class T, class U, class=detail::requires_quantity<T>, class=detail::requires_quantity<U>>
+constexpr auto operator/(T&& q1, U&& q2) -> quantity<decltype(q1.unit() / q2.unit()){}, decltype(q1.value() / q2.value())>
+{ return detail::from_value{static_cast<T&&>(q1).value() / static_cast<U&&>(q2).value()}; }
+
+// Quantity / value
+template<class T, class U, class=detail::requires_quantity<T>, class = detail::requires_numeric<U>>
+constexpr auto operator/(T&& q, U&& x) -> quantity<decltype(q.unit()){} * dimensionless{}, decltype(q.value() / x)>
+{ return detail::from_value{static_cast<T&&>(q).value() / static_cast<U&&>(x)}; }
+template<class T, class U, class=detail::requires_numeric<T>, class=detail::requires_quantity<U>>
+constexpr auto operator/(T&& x, U&& q) -> quantity<dimensionless{} / decltype(q.unit()){}, decltype(x / q.value())>
+{ return detail::from_value{static_cast<T&&>(x) / static_cast<U&&>(q).value()}; }
+
+// Quantity / Unit
+template<class Q, class Unit2, class=detail::requires_quantity<Q>, class=detail::requires_unit<Unit2>>
+constexpr auto operator/(Q&& q, Unit2) -> quantity<decltype(q.unit()){} / Unit2{}, std::decay_t<decltype(q.value())>>
+{ return detail::from_value{static_cast<Q&&>(q).value()}; }
+
+// unary +-
+template<class Q, class=detail::requires_quantity<Q>>
+constexpr auto operator+(Q&& q) -> quantity<decltype(q.unit()){}, decltype(+q.value())>
+{ return detail::from_value{+static_cast<Q&&>(q).value()}; }
+template<class Q, class=detail::requires_quantity<Q>>
+constexpr auto operator-(Q&& q) -> quantity<decltype(q.unit()){}, decltype(-q.value())>
+{ return detail::from_value{-static_cast<Q&&>(q).value()}; }
+
+namespace detail {
+
+template<class Q>
+using quantity_unit_t = std::remove_cv_t<typename std::remove_reference_t<Q>::unit_type>;
 
-// Comparison operators are permitted for identical units
-template<auto Unit, class T1, class T2>
-constexpr auto operator<=>(const quantity<Unit, T1>& q1, const quantity<Unit, T2>& q2) -> decltype(q1.value() <=> q2.value())
-{ return q1.value() <=> q2.value(); }
+template<class T, class U, class Integral>
+using common_unit_q = common_unit_t<T, U, Integral::value>;
 
+// The unit in which Q1 and Q2 are added or compared.  Quantities of
+// absolute units are compared in the unit of the first.
+template<class Q1, class Q2>
+using common_quantity_unit = mp11::mp_eval_if_c<
+    is_absolute_unit<quantity_unit_t<Q1>>::value || is_absolute_unit<quantity_unit_t<Q2>>::value,
+    quantity_unit_t<Q1>,
+    common_unit_q, quantity_unit_t<Q1>, quantity_unit_t<Q2>,
+    mp11::mp_bool<!std::is_floating_point<scalar_type_t<decltype(std::declval<Q1>().value() + std::declval<Q2>().value())>>::value>>;
+
+// Absolute units have their own addition and subtraction (absolute.hpp).
+template<class Q1, class Q2>
+using requires_relative_quantities = mp11::mp_if_c<
+    !is_absolute_unit<quantity_unit_t<Q1>>::value && !is_absolute_unit<quantity_unit_t<Q2>>::value, void>;
+
+// Whether the integer conversion factor Factor can be represented
+// in the elements of V.
+template<class V, class Factor>
+inline constexpr bool integer_factor_fits =
+    static_cast<std::uintmax_t>(Factor::num) <= static_cast<std::uintmax_t>((std::numeric_limits<scalar_type_t<V>>::max)());
+
+// Converts x from From to To.  An integer factor is applied in
+// V instead of in floating point, so that it stays exact.  A factor
+// that does not fit in V is rejected, since the result would be
+// meaningless.
+template<class V, class From, class To, class T>
+constexpr auto to_common_unit(From, To, const T& x)
+{
+    if constexpr(std::is_same<From, To>::value) return x;
+    else if constexpr(is_absolute_unit<From>::value || is_absolute_unit<To>::value)
+        return convert_absolute<V, void>(From{}, To{}, x);
+    else
+    {
+        using factor = conversion_ratio<From, To>;
+        if constexpr(!std::is_floating_point<scalar_type_t<V>>::value && is_std_ratio<factor>::value && factor::den == 1)
+        {
+            static_assert(integer_factor_fits<V, factor>,
+                "The factor to the common unit does not fit in the value type.  Convert one side explicitly, or use a wider value type.");
+            if constexpr(factor::num == 1) return x;
+            else return x * static_cast<scalar_type_t<V>>(factor::num);
+        }
+        else return apply_conversion<choose_scale_type<void, V>>(From{}, To{}, x);
+    }
+}
+
+// The value of q in the common_unit of Q1 and Q2.
+template<class Q1, class Q2, class Q>
+constexpr auto common_value(const Q& q)
+{
+    using value_type = decltype(std::declval<Q1>().value() + std::declval<Q2>().value());
+    return to_common_unit<value_type>(q.unit(), common_quantity_unit<Q1, Q2>(), q.value());
+}
+
+// Comparisons of SIMD packs return masks and have no operator<=>,
+// so the relational operators cannot be rewritten from it.
+template<class T1, class T2>
+using requires_mask_comparison = mp11::mp_if_c<!std::is_same<decltype(std::declval<const T1&>() == std::declval<const T2&>()), bool>::value, void>;
+
+}
+
+// Quantity +- Quantity.  The units may differ as long as they have the
+// same dimensions.  The result is in their common_unit.
+template<class Q1, class Q2, class=detail::requires_quantity<Q1>, class=detail::requires_quantity<Q2>,
+    class=detail::requires_relative_quantities<Q1, Q2>>
+constexpr auto operator+(Q1&& q1, Q2&& q2) -> quantity<detail::common_quantity_unit<Q1, Q2>{}, decltype(q1.value() + q2.value())>
+{
+    return detail::from_value(detail::common_value<Q1, Q2>(q1) + detail::common_value<Q1, Q2>(q2));
+}
+template<class Q1, class Q2, class=detail::requires_quantity<Q1>, class=detail::requires_quantity<Q2>,
+    class=detail::requires_relative_quantities<Q1, Q2>>
+constexpr auto operator-(Q1&& q1, Q2&& q2) -> quantity<detail::common_quantity_unit<Q1, Q2>{}, decltype(q1.value() - q2.value())>
+{
+    return detail::from_value(detail::common_value<Q1, Q2>(q1) - detail::common_value<Q1, Q2>(q2));
+}
+
+// Comparison operators convert both sides to the common_unit.
+template<auto Unit1, class T1, auto Unit2, class T2>
+constexpr auto operator<=>(const quantity<Unit1, T1>& q1, const quantity<Unit2, T2>& q2) -> decltype(q1.value() <=> q2.value())
+{
+    using Q1 = const quantity<Unit1, T1>&;
+    using Q2 = const quantity<Unit2, T2>&;
+    return detail::common_value<Q1, Q2>(q1) <=> detail::common_value<Q1, Q2>(q2);
+}
+template<auto Unit1, class T1, auto Unit2, class T2>
+constexpr auto operator==(const quantity<Unit1, T1>& q1, const quantity<Unit2, T2>& q2) -> decltype(q1.value() == q2.value())
+{
+    using Q1 = const quantity<Unit1, T1>&;
+    using Q2 = const quantity<Unit2, T2>&;
+    return detail::common_value<Q1, Q2>(q1) == detail::common_value<Q1, Q2>(q2);
+}
+
+// Element-wise comparisons for value types whose == returns a mask.
+template<auto Unit1, class T1, auto Unit2, class T2, class = detail::requires_mask_comparison<T1, T2>>
+constexpr auto operator!=(const quantity<Unit1, T1>& q1, const quantity<Unit2, T2>& q2) -> decltype(q1.value() != q2.value())
+{
+    using Q1 = const quantity<Unit1, T1>&;
+    using Q2 = const quantity<Unit2, T2>&;
+    return detail::common_value<Q1, Q2>(q1) != detail::common_value<Q1, Q2>(q2);
+}
+template<auto Unit1, class T1, auto Unit2, class T2, class = detail::requires_mask_comparison<T1, T2>>
+constexpr auto operator<(const quantity<Unit1, T1>& q1, const quantity<Unit2, T2>& q2) -> decltype(q1.value() < q2.value())
+{
+    using Q1 = const quantity<Unit1, T1>&;
+    using Q2 = const quantity<Unit2, T2>&;
+    return detail::common_value<Q1, Q2>(q1) < detail::common_value<Q1, Q2>(q2);
+}
+template<auto Unit1, class T1, auto Unit2, class T2, class = detail::requires_mask_comparison<T1, T2>>
+constexpr auto operator<=(const quantity<Unit1, T1>& q1, const quantity<Unit2, T2>& q2) -> decltype(q1.value() <= q2.value())
+{
+    using Q1 = const quantity<Unit1, T1>&;
+    using Q2 = const quantity<Unit2, T2>&;
+    return detail::common_value<Q1, Q2>(q1) <= detail::common_value<Q1, Q2>(q2);
+}
+template<auto Unit1, class T1, auto Unit2, class T2, class = detail::requires_mask_comparison<T1, T2>>
+constexpr auto operator>(const quantity<Unit1, T1>& q1, const quantity<Unit2, T2>& q2) -> decltype(q1.value() > q2.value())
+{
+    using Q1 = const quantity<Unit1, T1>&;
+    using Q2 = const quantity<Unit2, T2>&;
+    return detail::common_value<Q1, Q2>(q1) > detail::common_value<Q1, Q2>(q2);
+}
+template<auto Unit1, class T1, auto Unit2, class T2, class = detail::requires_mask_comparison<T1, T2>>
+constexpr auto operator>=(const quantity<Unit1, T1>& q1, const quantity<Unit2, T2>& q2) -> decltype(q1.value() >= q2.value())
+{
+    using Q1 = const quantity<Unit1, T1>&;
+    using Q2 = const quantity<Unit2, T2>&;
+    return detail::common_value<Q1, Q2>(q1) >= detail::common_value<Q1, Q2>(q2);
+}
 }
 }
 
@@ -0,0 +1,192 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_QUANTITY_SPAN_HPP_INCLUDED
+#define BOOST_UNITS2_QUANTITY_SPAN_HPP_INCLUDED
+
+#include <boost/units2/quantity.hpp>
+#include <boost/assert.hpp>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <type_traits>
+
+// Views of existing memory as quantities.  These rely on the layout
+// guarantee of quantity, so they never copy.  The memory must contain
+// valid objects of type T, which are assumed to be measured in Unit.
+
+namespace boost {
+namespace units2 {
+
+namespace detail {
+
+template<auto Unit, class T>
+struct quantity_element { using type = quantity<Unit, T>; };
+template<auto Unit, class T>
+struct quantity_element<Unit, const T> { using type = const quantity<Unit, T>; };
+
+template<auto Unit, class T>
+using quantity_element_t = typename quantity_element<Unit, T>::type;
+
+template<class Q>
+constexpr void check_value_layout()
+{
+    static_assert(has_value_layout<std::remove_const_t<Q>> && std::is_standard_layout<std::remove_const_t<Q>>::value,
+        "quantity<Unit, T> must have the same layout as T");
+}
+
+}
+
+/**
+ * A contiguous view of quantities.  T may be const qualified,
+ * giving a read-only view.
+ */
+template<auto Unit, class T, std::size_t Extent = std::dynamic_extent>
+using quantity_span = std::span<detail::quantity_element_t<Unit, T>, Extent>;
+
+/// Views an array of T, measured in Unit, as quantities.
+template<auto Unit, class T, std::size_t Extent>
+quantity_span<Unit, T, Extent> as_quantities(std::span<T, Extent> values) noexcept
+{
+    using element = detail::quantity_element_t<Unit, T>;
+    detail::check_value_layout<element>();
+    return quantity_span<Unit, T, Extent>(reinterpret_cast<element*>(values.data()), values.size());
+}
+
+template<auto Unit, class T>
+quantity_span<Unit, T> as_quantities(T* data, std::size_t n) noexcept
+{
+    return ::boost::units2::as_quantities<Unit>(std::span<T>(data, n));
+}
+
+/// Views an array of quantities as their raw values.
+template<auto Unit, class T, std::size_t Extent>
+std::span<T, Extent> as_values(std::span<quantity<Unit, T>, Extent> q) noexcept
+{
+    detail::check_value_layout<quantity<Unit, T>>();
+    return std::span<T, Extent>(reinterpret_cast<T*>(q.data()), q.size());
+}
+template<auto Unit, class T, std::size_t Extent>
+std::span<const T, Extent> as_values(std::span<const quantity<Unit, T>, Extent> q) noexcept
+{
+    detail::check_value_layout<quantity<Unit, T>>();
+    return std::span<const T, Extent>(reinterpret_cast<const T*>(q.data()), q.size());
+}
+
+/**
+ * A view of quantities that are separated by a fixed number of bytes,
+ * such as one field of an array of records.  T may be const qualified.
+ *
+ * \pre Every element is suitably aligned for T.
+ */
+template<auto Unit, class T>
+class strided_quantity_view {
+    using byte_type = std::conditional_t<std::is_const<T>::value, const unsigned char, unsigned char>;
+public:
+    using element_type = detail::quantity_element_t<Unit, T>;
+    using value_type = std::remove_const_t<element_type>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = element_type&;
+    using pointer = element_type*;
+
+    class iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = strided_quantity_view::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = element_type&;
+        using pointer = element_type*;
+        iterator() = default;
+        reference operator*() const { return *reinterpret_cast<pointer>(pos_); }
+        pointer operator->() const { return reinterpret_cast<pointer>(pos_); }
+        reference operator[](difference_type n) const { return *(*this + n); }
+        iterator& operator++() { pos_ += stride_; return *this; }
+        iterator operator++(int) { iterator result = *this; ++*this; return result; }
+        iterator& operator--() { pos_ -= stride_; return *this; }
+        iterator operator--(int) { iterator result = *this; --*this; return result; }
+        iterator& operator+=(difference_type n) { pos_ += n * stride_; return *this; }
+        iterator& operator-=(difference_type n) { pos_ -= n * stride_; return *this; }
+        friend iterator operator+(iterator it, difference_type n) { return it += n; }
+        friend iterator operator+(difference_type n, iterator it) { return it += n; }
+        friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const iterator& lhs, const iterator& rhs) { return (lhs.pos_ - rhs.pos_) / lhs.stride_; }
+        friend bool operator==(const iterator& lhs, const iterator& rhs) { return lhs.pos_ == rhs.pos_; }
+        friend auto operator<=>(const iterator& lhs, const iterator& rhs) { return (lhs.pos_ - rhs.pos_) * lhs.stride_ <=> 0; }
+    private:
+        friend class strided_quantity_view;
+        iterator(byte_type* pos, difference_type stride) : pos_(pos), stride_(stride) {}
+        byte_type* pos_ = nullptr;
+        difference_type stride_ = sizeof(T);
+    };
+
+    strided_quantity_view() = default;
+    /// Views n elements, the first at first, with byte_stride bytes between
+    /// consecutive elements.  A negative stride views the elements in
+    /// reverse order of address.
+    /// \pre byte_stride != 0
+    strided_quantity_view(T* first, size_type n, difference_type byte_stride) noexcept
+      : first_(reinterpret_cast<byte_type*>(first)), size_(n), stride_(byte_stride)
+    {
+        detail::check_value_layout<element_type>();
+        BOOST_ASSERT(byte_stride != 0);
+        BOOST_ASSERT(byte_stride % static_cast<difference_type>(alignof(T)) == 0);
+    }
+    /// Views a contiguous array.
+    strided_quantity_view(quantity_span<Unit, T> q) noexcept
+      : strided_quantity_view(reinterpret_cast<T*>(q.data()), q.size(), sizeof(T)) {}
+    /// Allows a read-only view to be formed from a mutable one.
+    template<class U, class = std::enable_if_t<std::is_same<const U, T>::value>>
+    strided_quantity_view(const strided_quantity_view<Unit, U>& other) noexcept
+      : first_(other.first_), size_(other.size_), stride_(other.stride_) {}
+
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    difference_type stride() const noexcept { return stride_; }
+    bool is_contiguous() const noexcept { return stride_ == static_cast<difference_type>(sizeof(T)); }
+
+    reference operator[](size_type i) const { BOOST_ASSERT(i < size_); return *reinterpret_cast<pointer>(first_ + static_cast<difference_type>(i) * stride_); }
+    iterator begin() const noexcept { return iterator(first_, stride_); }
+    iterator end() const noexcept { return iterator(first_ + static_cast<difference_type>(size_) * stride_, stride_); }
+
+    /// Every n-th element, starting from the first.
+    /// \pre n > 0
+    strided_quantity_view every(size_type n) const noexcept
+    {
+        BOOST_ASSERT(n > 0);
+        return strided_quantity_view(reinterpret_cast<T*>(first_), (size_ + n - 1) / n, stride_ * static_cast<difference_type>(n));
+    }
+    strided_quantity_view subview(size_type offset, size_type count) const noexcept
+    {
+        BOOST_ASSERT(offset + count <= size_);
+        return strided_quantity_view(reinterpret_cast<T*>(first_ + static_cast<difference_type>(offset) * stride_), count, stride_);
+    }
+private:
+    template<auto, class> friend class strided_quantity_view;
+    byte_type* first_ = nullptr;
+    size_type size_ = 0;
+    difference_type stride_ = sizeof(T);
+};
+
+/**
+ * Views the member M of each element of records as a quantity in Unit.
+ * \code
+ * struct sample { double time; float x; float y; };
+ * auto x = strided_member<si::meter>(std::span(samples), &sample::x);
+ * \endcode
+ */
+template<auto Unit, class Record, class T, std::size_t Extent>
+auto strided_member(std::span<Record, Extent> records, T std::remove_const_t<Record>::* member) noexcept
+{
+    using value_type = std::conditional_t<std::is_const<Record>::value, const T, T>;
+    value_type* first = records.empty()? nullptr : &(records.data()->*member);
+    return strided_quantity_view<Unit, value_type>(first, records.size(), sizeof(Record));
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,155 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_QUANTITY_VECTOR_HPP_INCLUDED
+#define BOOST_UNITS2_QUANTITY_VECTOR_HPP_INCLUDED
+
+#include <boost/units2/quantity.hpp>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace units2 {
+
+/**
+ * A sequence container of quantities that all have the same unit.
+ * The values are stored as a contiguous array of T, which is exposed
+ * by values() for use with code that works on raw arrays.  Elements
+ * are accessed as quantity<Unit, T>.
+ *
+ * The allocator allocates T, not quantity<Unit, T>, so the same
+ * allocator can be shared with plain containers of T.
+ */
+template<auto Unit, class T = double, class Alloc = std::allocator<T>>
+class quantity_vector {
+public:
+    using value_type = quantity<Unit, T>;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // The raw array is viewed as an array of quantities.
+    static_assert(detail::has_value_layout<value_type> && std::is_standard_layout<value_type>::value,
+        "quantity<Unit, T> must have the same layout as T");
+
+    quantity_vector() = default;
+    explicit quantity_vector(const Alloc& alloc) : values_(alloc) {}
+    /// Creates n value-initialized elements.
+    explicit quantity_vector(size_type n, const Alloc& alloc = Alloc()) : values_(n, alloc) {}
+    quantity_vector(size_type n, const value_type& x, const Alloc& alloc = Alloc()) : values_(n, x.value(), alloc) {}
+    quantity_vector(std::initializer_list<value_type> init, const Alloc& alloc = Alloc()) : values_(alloc)
+    {
+        values_.reserve(init.size());
+        for(const value_type& x : init) values_.push_back(x.value());
+    }
+    template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+    quantity_vector(InputIt first, InputIt last, const Alloc& alloc = Alloc()) : values_(alloc)
+    {
+        for(; first != last; ++first) push_back(*first);
+    }
+
+    /// Takes ownership of an array of raw values, which are in Unit.
+    static quantity_vector from_values(std::vector<T, Alloc> values)
+    {
+        quantity_vector result(values.get_allocator());
+        result.values_ = std::move(values);
+        return result;
+    }
+    /// Releases the raw values.  The container is left empty.
+    std::vector<T, Alloc> release_values() { return std::exchange(values_, std::vector<T, Alloc>(values_.get_allocator())); }
+
+    static constexpr auto unit() -> decltype(Unit) { return {}; }
+    allocator_type get_allocator() const { return values_.get_allocator(); }
+
+    /// A view of the raw values, which are in Unit.
+    std::span<T> values() noexcept { return std::span<T>(values_.data(), values_.size()); }
+    std::span<const T> values() const noexcept { return std::span<const T>(values_.data(), values_.size()); }
+
+    // element access
+    pointer data() noexcept { return reinterpret_cast<pointer>(values_.data()); }
+    const_pointer data() const noexcept { return reinterpret_cast<const_pointer>(values_.data()); }
+    reference operator[](size_type i) { return data()[i]; }
+    const_reference operator[](size_type i) const { return data()[i]; }
+    reference at(size_type i) { check_index(i); return data()[i]; }
+    const_reference at(size_type i) const { check_index(i); return data()[i]; }
+    reference front() { return data()[0]; }
+    const_reference front() const { return data()[0]; }
+    reference back() { return data()[size() - 1]; }
+    const_reference back() const { return data()[size() - 1]; }
+
+    // iterators
+    iterator begin() noexcept { return data(); }
+    const_iterator begin() const noexcept { return data(); }
+    const_iterator cbegin() const noexcept { return data(); }
+    iterator end() noexcept { return data() + size(); }
+    const_iterator end() const noexcept { return data() + size(); }
+    const_iterator cend() const noexcept { return data() + size(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // capacity
+    bool empty() const noexcept { return values_.empty(); }
+    size_type size() const noexcept { return values_.size(); }
+    size_type max_size() const noexcept { return values_.max_size(); }
+    size_type capacity() const noexcept { return values_.capacity(); }
+    void reserve(size_type n) { values_.reserve(n); }
+    void shrink_to_fit() { values_.shrink_to_fit(); }
+
+    // modifiers
+    void clear() noexcept { values_.clear(); }
+    void push_back(const value_type& x) { values_.push_back(x.value()); }
+    void push_back(value_type&& x) { values_.push_back(std::move(x).value()); }
+    void pop_back() { values_.pop_back(); }
+    iterator insert(const_iterator pos, const value_type& x)
+    { return data() + (values_.insert(values_.begin() + (pos - cbegin()), x.value()) - values_.begin()); }
+    iterator erase(const_iterator pos)
+    { return data() + (values_.erase(values_.begin() + (pos - cbegin())) - values_.begin()); }
+    iterator erase(const_iterator first, const_iterator last)
+    { return data() + (values_.erase(values_.begin() + (first - cbegin()), values_.begin() + (last - cbegin())) - values_.begin()); }
+    void resize(size_type n) { values_.resize(n); }
+    void resize(size_type n, const value_type& x) { values_.resize(n, x.value()); }
+    void swap(quantity_vector& other) noexcept(noexcept(std::declval<std::vector<T, Alloc>&>().swap(std::declval<std::vector<T, Alloc>&>())))
+    { values_.swap(other.values_); }
+
+    friend bool operator==(const quantity_vector& lhs, const quantity_vector& rhs) { return lhs.values_ == rhs.values_; }
+    friend void swap(quantity_vector& lhs, quantity_vector& rhs) noexcept(noexcept(lhs.swap(rhs))) { lhs.swap(rhs); }
+private:
+    void check_index(size_type i) const
+    {
+        if(i >= size()) throw std::out_of_range("boost::units2::quantity_vector: index out of range");
+    }
+    std::vector<T, Alloc> values_;
+};
+
+namespace pmr {
+
+template<auto Unit, class T = double>
+using quantity_vector = ::boost::units2::quantity_vector<Unit, T, std::pmr::polymorphic_allocator<T>>;
+
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,57 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_ROUNDING_HPP_INCLUDED
+#define BOOST_UNITS2_ROUNDING_HPP_INCLUDED
+
+// Conversions of integral quantities that detect overflow.  The rounding
+// policies (rounding::toward_zero, down, up, to_nearest, to_nearest_even)
+// are declared in detail/integer_convert.hpp, which quantity.hpp includes,
+// so that the core does not pay for <stdexcept>.
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/detail/integer_convert.hpp>
+#include <stdexcept>
+#include <type_traits>
+
+namespace boost {
+namespace units2 {
+
+/// Thrown by checked_quantity_cast when the converted value
+/// does not fit in the value_type.
+class conversion_overflow : public std::overflow_error {
+public:
+    using std::overflow_error::overflow_error;
+};
+
+/**
+ * Converts an integral q to Unit exactly, and rounds the result by R.
+ * Throws conversion_overflow if the result does not fit in T.  The
+ * conversion factor must be rational.
+ */
+template<auto Unit, class R, auto Unit2, class T>
+constexpr quantity<Unit, T> checked_quantity_cast(const quantity<Unit2, T>& q)
+{
+    static_assert(detail::is_rounding<R>::value, "R must be a rounding policy.");
+    using factor = detail::conversion_ratio<std::remove_cv_t<decltype(Unit2)>, std::remove_cv_t<decltype(Unit)>>;
+    static_assert(detail::has_integer_conversion<T, T, factor>,
+        "checked_quantity_cast requires an integral value_type and a rational conversion factor.");
+    detail::check_conversion<detail::dimension_check<decltype(Unit2)>, detail::dimension_check<decltype(Unit)>>();
+    auto result = detail::integer_convert<T, R>(factor(), q.value());
+    if(result.overflow) throw conversion_overflow("boost::units2::checked_quantity_cast: overflow");
+    return quantity<Unit, T>::from_value(result.value);
+}
+/// R defaults to rounding::toward_zero.
+template<auto Unit, auto Unit2, class T>
+constexpr quantity<Unit, T> checked_quantity_cast(const quantity<Unit2, T>& q)
+{
+    return ::boost::units2::checked_quantity_cast<Unit, rounding::toward_zero>(q);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,539 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_RUNTIME_UNIT_HPP_INCLUDED
+#define BOOST_UNITS2_RUNTIME_UNIT_HPP_INCLUDED
+
+#include <boost/units2/unit.hpp>
+#include <boost/units2/si.hpp>
+#include <boost/units2/base_dimension.hpp>
+#include <boost/units2/detail/rational.hpp>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+// Units whose identity is only known at run time, for example
+// from a configuration file.  A runtime_unit is a product of powers
+// of the base dimensions with a scale relative to the base unit of
+// each dimension (the unit that BOOST_UNITS2_DEF defines directly
+// in terms of the dimension, e.g. si::meter or si::gram).
+//
+// The scale is kept as an exact rational times a floating point
+// factor.  The floating point factor is exactly 1 unless the unit
+// involves an irrational scale or the rational part overflowed.
+
+namespace boost {
+namespace units2 {
+
+/// Thrown when a run time conversion is between different dimensions.
+class runtime_unit_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/// Thrown when a unit string cannot be parsed.
+class unit_parse_error : public runtime_unit_error {
+public:
+    unit_parse_error(const std::string& what, std::size_t position)
+      : runtime_unit_error(what + " at position " + std::to_string(position)), position_(position) {}
+    /// The offset in the input where the error was detected.
+    std::size_t position() const noexcept { return position_; }
+private:
+    std::size_t position_;
+};
+
+class runtime_unit {
+public:
+    using rational = detail::rational;
+    using exponent_array = detail::dimension_exponents;
+
+    /// Creates the dimensionless unit 1.
+    runtime_unit() = default;
+    runtime_unit(const exponent_array& exponents, rational scale, double irrational_scale = 1)
+      : exponents_(exponents), scale_(scale), irrational_scale_(irrational_scale) { fold_overflow(); }
+    /// Creates the run time equivalent of a static unit.
+    template<class U, class = detail::requires_unit<U>>
+    explicit runtime_unit(U)
+      : exponents_(detail::exponents_of<U>())
+    {
+        using factor = typename detail::fold_conversion<detail::flatten_scale<std::remove_cv_t<U>>>::type;
+        if constexpr(is_ratio<factor>::value)
+            scale_ = rational(factor());
+        else
+            irrational_scale_ = detail::get_value<double>(factor());
+    }
+
+    const exponent_array& exponents() const noexcept { return exponents_; }
+    rational exponent(base_dimension d) const noexcept { return exponents_[static_cast<std::size_t>(d)]; }
+    /// The exact part of the scale.
+    rational scale() const noexcept { return scale_; }
+    /// The part of the scale that is not rational.
+    double irrational_scale() const noexcept { return irrational_scale_; }
+    /// The factor that converts a value in this unit to the base units.
+    double factor() const noexcept { return scale_.value() * irrational_scale_; }
+    bool is_dimensionless() const noexcept
+    {
+        for(const rational& e : exponents_)
+            if(e.num != 0) return false;
+        return true;
+    }
+
+    friend runtime_unit operator*(const runtime_unit& lhs, const runtime_unit& rhs)
+    {
+        exponent_array exponents;
+        for(std::size_t i = 0; i < base_dimension_count; ++i)
+            exponents[i] = checked_exponent(lhs.exponents_[i] + rhs.exponents_[i]);
+        return runtime_unit(exponents, lhs.scale_, lhs.irrational_scale_ * rhs.irrational_scale_).times(rhs.scale_);
+    }
+    friend runtime_unit operator/(const runtime_unit& lhs, const runtime_unit& rhs)
+    {
+        return lhs * pow(rhs, rational(-1));
+    }
+    /// Raises u to a rational power.  The scale stays exact when
+    /// the necessary roots are exact.
+    friend runtime_unit pow(const runtime_unit& u, rational e)
+    {
+        exponent_array exponents;
+        for(std::size_t i = 0; i < base_dimension_count; ++i)
+            exponents[i] = checked_exponent(u.exponents_[i] * e);
+        double irrational = std::pow(u.irrational_scale_, e.value());
+        rational scale = u.scale_.num == 0? rational(0) : rational_power(u.scale_, e);
+        if(!scale.valid())
+        {
+            irrational *= std::pow(u.scale_.value(), e.value());
+            scale = 1;
+        }
+        return runtime_unit(exponents, scale, irrational);
+    }
+    friend bool operator==(const runtime_unit& lhs, const runtime_unit& rhs)
+    {
+        return lhs.exponents_ == rhs.exponents_ && lhs.scale_ == rhs.scale_ && lhs.irrational_scale_ == rhs.irrational_scale_;
+    }
+private:
+    template<class T>
+    struct is_ratio : std::false_type {};
+    template<std::intmax_t N, std::intmax_t D>
+    struct is_ratio<std::ratio<N, D>> : std::true_type {};
+
+    static rational checked_exponent(rational e)
+    {
+        if(!e.valid()) throw runtime_unit_error("boost::units2::runtime_unit: exponent overflow");
+        return e;
+    }
+    // b^e, or an invalid rational if it is not exactly representable.
+    static rational rational_power(rational b, rational e)
+    {
+        if(e.num < 0) { b = rational(1) / b; e = -e; }
+        if(e.den != 1)
+        {
+            std::intmax_t num = b.num < 0? 0 : detail::exact_root(b.num, e.den);
+            std::intmax_t den = detail::exact_root(b.den, e.den);
+            if(num == 0 || den == 0) return rational::overflow();
+            b = rational(num, den);
+        }
+        rational result = 1;
+        for(std::intmax_t n = e.num; n != 0 && result.valid(); n /= 2)
+        {
+            if(n % 2) result *= b;
+            if(n != 1) b *= b;
+        }
+        return result;
+    }
+    runtime_unit times(rational r) const
+    {
+        runtime_unit result = *this;
+        result.scale_ = scale_ * r;
+        if(!result.scale_.valid())
+            result.irrational_scale_ *= scale_.value() * r.value();
+        result.fold_overflow();
+        return result;
+    }
+    void fold_overflow()
+    {
+        if(!scale_.valid()) scale_ = 1;
+    }
+
+    exponent_array exponents_;
+    rational scale_ = 1;
+    double irrational_scale_ = 1;
+};
+
+inline bool has_same_dimension(const runtime_unit& lhs, const runtime_unit& rhs)
+{
+    return lhs.exponents() == rhs.exponents();
+}
+
+/// Returns the factor that converts a value in from to a value in to.
+/// Throws runtime_unit_error if the dimensions differ.
+inline double conversion_factor(const runtime_unit& from, const runtime_unit& to)
+{
+    if(!has_same_dimension(from, to))
+        throw runtime_unit_error("boost::units2::conversion_factor: units have different dimensions");
+    detail::rational exact = from.scale() / to.scale();
+    double irrational = from.irrational_scale() / to.irrational_scale();
+    return exact.valid()? exact.value() * irrational : from.factor() / to.factor();
+}
+
+namespace detail {
+
+struct string_hash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>()(s); }
+};
+
+}
+
+/**
+ * Maps unit symbols to units for parse_unit.  A symbol may be
+ * prefixable, in which case the SI prefixes (k, m, u, µ, etc.) may
+ * be applied to it.  A symbol that is defined exactly always wins
+ * over a prefixed interpretation, so "cd" is a candela, not a centiday.
+ */
+class unit_symbol_table {
+public:
+    /// Creates an empty table.
+    unit_symbol_table() = default;
+
+    /// The table for si.hpp, with the SI prefixes and the
+    /// non-SI units min, h and d.
+    static const unit_symbol_table& si();
+
+    void add(std::string symbol, const runtime_unit& u, bool prefixable = true)
+    {
+        symbols_.insert_or_assign(std::move(symbol), entry{ u, prefixable });
+    }
+    template<class U, class = detail::requires_unit<U>>
+    void add(std::string symbol, U u, bool prefixable = true)
+    {
+        add(std::move(symbol), runtime_unit(u), prefixable);
+    }
+
+    /// Looks up a single symbol, possibly with a prefix.
+    std::optional<runtime_unit> find(std::string_view symbol) const
+    {
+        if(auto pos = symbols_.find(symbol); pos != symbols_.end())
+            return pos->second.unit;
+        for(const prefix& p : prefixes)
+        {
+            if(symbol.size() > p.symbol.size() && symbol.substr(0, p.symbol.size()) == p.symbol)
+            {
+                auto pos = symbols_.find(symbol.substr(p.symbol.size()));
+                if(pos != symbols_.end() && pos->second.prefixable)
+                    return pos->second.unit * runtime_unit({}, p.scale);
+            }
+        }
+        return std::nullopt;
+    }
+private:
+    struct entry {
+        runtime_unit unit;
+        bool prefixable;
+    };
+    struct prefix {
+        std::string_view symbol;
+        detail::rational scale;
+    };
+    // The two byte prefix comes first, so that it is preferred.
+    // Yotta, zetta, zepto and yocto are omitted, because like
+    // std::ratio, the scale is limited to std::intmax_t.
+    static constexpr prefix prefixes[] = {
+        { "da", std::deca() }, { "E", std::exa() }, { "P", std::peta() }, { "T", std::tera() },
+        { "G", std::giga() }, { "M", std::mega() }, { "k", std::kilo() }, { "h", std::hecto() },
+        { "d", std::deci() }, { "c", std::centi() }, { "m", std::milli() }, { "u", std::micro() },
+        { "µ", std::micro() }, { "μ", std::micro() }, { "n", std::nano() }, { "p", std::pico() },
+        { "f", std::femto() }, { "a", std::atto() }
+    };
+    std::unordered_map<std::string, entry, detail::string_hash, std::equal_to<>> symbols_;
+};
+
+namespace detail {
+
+// unit   := factor (("*" | "/" | "·" | " ") factor)*
+// factor := primary ("^" exponent)?
+// primary := symbol | number | "(" unit ")"
+// exponent := integer | "(" integer ("/" integer)? ")"
+class unit_parser {
+public:
+    unit_parser(std::string_view text, const unit_symbol_table& table) : text_(text), table_(table) {}
+    runtime_unit parse()
+    {
+        skip_space();
+        runtime_unit result = parse_product();
+        if(pos_ != text_.size()) fail("unexpected character");
+        return result;
+    }
+private:
+    [[noreturn]] void fail(const char* what) const
+    {
+        throw unit_parse_error(std::string("boost::units2::parse_unit: ") + what + " in \"" + std::string(text_) + "\"", pos_);
+    }
+    bool at_end() const { return pos_ == text_.size(); }
+    char peek() const { return at_end()? '\0' : text_[pos_]; }
+    bool at_middle_dot() const { return text_.substr(pos_, 2) == "·"; }
+    bool at_symbol_char() const
+    {
+        if(at_end() || at_middle_dot()) return false;
+        unsigned char c = static_cast<unsigned char>(text_[pos_]);
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '%' || c >= 0x80;
+    }
+    bool at_digit() const { return peek() >= '0' && peek() <= '9'; }
+    void skip_space() { while(peek() == ' ' || peek() == '\t') ++pos_; }
+
+    runtime_unit parse_product()
+    {
+        runtime_unit result = parse_factor();
+        while(true)
+        {
+            std::size_t before = pos_;
+            skip_space();
+            if(peek() == '*') { ++pos_; skip_space(); result = result * parse_factor(); }
+            else if(at_middle_dot()) { pos_ += 2; skip_space(); result = result * parse_factor(); }
+            else if(peek() == '/') { ++pos_; skip_space(); result = result / parse_factor(); }
+            else if(pos_ != before && (at_symbol_char() || at_digit() || peek() == '(')) result = result * parse_factor();
+            else { pos_ = before; break; }
+        }
+        return result;
+    }
+    runtime_unit parse_factor()
+    {
+        runtime_unit base = parse_primary();
+        std::size_t before = pos_;
+        skip_space();
+        if(peek() != '^') { pos_ = before; return base; }
+        ++pos_;
+        skip_space();
+        return pow(base, parse_exponent());
+    }
+    rational parse_exponent()
+    {
+        if(peek() != '(') return parse_signed_integer();
+        ++pos_;
+        skip_space();
+        rational result = parse_signed_integer();
+        skip_space();
+        if(peek() == '/')
+        {
+            ++pos_;
+            skip_space();
+            rational den = parse_signed_integer();
+            if(den.num == 0) fail("zero denominator");
+            result /= den;
+            skip_space();
+        }
+        if(peek() != ')') fail("expected )");
+        ++pos_;
+        return result;
+    }
+    rational parse_signed_integer()
+    {
+        bool negative = false;
+        if(peek() == '-' || peek() == '+') { negative = peek() == '-'; ++pos_; }
+        if(!at_digit()) fail("expected an integer");
+        rational result = parse_digits();
+        return negative? -result : result;
+    }
+    rational parse_digits()
+    {
+        rational result = 0;
+        while(at_digit())
+        {
+            result = result * rational(10) + rational(text_[pos_] - '0');
+            ++pos_;
+        }
+        if(!result.valid()) fail("number too large");
+        return result;
+    }
+    runtime_unit parse_primary()
+    {
+        if(peek() == '(')
+        {
+            ++pos_;
+            skip_space();
+            runtime_unit result = parse_product();
+            skip_space();
+            if(peek() != ')') fail("expected )");
+            ++pos_;
+            return result;
+        }
+        if(at_digit())
+        {
+            rational value = parse_digits();
+            if(peek() == '.')
+            {
+                ++pos_;
+                rational scale = 1;
+                while(at_digit())
+                {
+                    scale /= rational(10);
+                    value += rational(text_[pos_] - '0') * scale;
+                    ++pos_;
+                }
+                if(!value.valid()) fail("number too precise");
+            }
+            if(value.num == 0) fail("zero scale");
+            return runtime_unit({}, value);
+        }
+        std::size_t start = pos_;
+        while(at_symbol_char()) ++pos_;
+        if(start == pos_) fail(at_end()? "unexpected end" : "unexpected character");
+        std::optional<runtime_unit> result = table_.find(text_.substr(start, pos_ - start));
+        if(!result) { pos_ = start; fail("unknown unit symbol"); }
+        return *result;
+    }
+
+    std::string_view text_;
+    const unit_symbol_table& table_;
+    std::size_t pos_ = 0;
+};
+
+}
+
+/**
+ * Parses a unit such as "kg*m/s^2", "km/h" or "m^(1/2)".  Symbols are
+ * looked up in table.  Products may be written with *, a middle dot or
+ * a space, and / applies to the single factor that follows it, so
+ * "m/s/s" is m/s^2.  Throws unit_parse_error on failure.
+ */
+inline runtime_unit parse_unit(std::string_view text, const unit_symbol_table& table = unit_symbol_table::si())
+{
+    return detail::unit_parser(text, table).parse();
+}
+
+inline const unit_symbol_table& unit_symbol_table::si()
+{
+    static const unit_symbol_table result = [] {
+        namespace s = ::boost::units2::si;
+        unit_symbol_table table;
+        table.add("m", s::meter);
+        table.add("g", s::gram);
+        table.add("s", s::second);
+        table.add("K", s::kelvin);
+        table.add("mol", s::mole);
+        table.add("A", s::ampere);
+        table.add("cd", s::candela);
+        table.add("rad", s::radian);
+        table.add("sr", s::steradian);
+        table.add("Hz", s::hertz);
+        table.add("N", s::newton);
+        table.add("Pa", s::pascal);
+        table.add("J", s::joule);
+        table.add("W", s::watt);
+        table.add("C", s::couloumb);
+        table.add("V", s::volt);
+        table.add("F", s::farad);
+        table.add("ohm", s::ohm);
+        table.add("Ω", s::ohm);
+        table.add("S", s::siemens);
+        table.add("Wb", s::weber);
+        table.add("T", s::tesla);
+        table.add("H", s::henry);
+        table.add("lm", s::lumen);
+        table.add("lx", s::lux);
+        table.add("Bq", s::becquerel);
+        table.add("Gy", s::gray);
+        table.add("Sv", s::sievert);
+        table.add("kat", s::katal);
+        table.add("min", std::ratio<60>() * s::second, false);
+        table.add("h", std::ratio<3600>() * s::second, false);
+        table.add("d", std::ratio<86400>() * s::second, false);
+        return table;
+    }();
+    return result;
+}
+
+/**
+ * Memoizes parsed units and the conversion factors between them, so
+ * that after the first use of a pair of strings, looking up the factor
+ * costs one hash lookup under a shared lock.  Safe to use from many
+ * threads at once.  The symbol table must outlive the cache.
+ */
+class conversion_cache {
+public:
+    explicit conversion_cache(const unit_symbol_table& table = unit_symbol_table::si()) : table_(&table) {}
+    conversion_cache(const conversion_cache&) = delete;
+    conversion_cache& operator=(const conversion_cache&) = delete;
+
+    /// The factor that converts a value in from to a value in to.
+    /// Throws unit_parse_error or runtime_unit_error.  Failures are
+    /// not cached.
+    double factor(std::string_view from, std::string_view to)
+    {
+        const key_view key{ from, to };
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto pos = factors_.find(key);
+            if(pos != factors_.end()) return pos->second;
+        }
+        double result = conversion_factor(unit(from), unit(to));
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        factors_.try_emplace(key_type(std::string(from), std::string(to)), result);
+        return result;
+    }
+
+    /// The parsed unit.  It is returned by value, so that it
+    /// is not invalidated by clear() in another thread.
+    runtime_unit unit(std::string_view text)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto pos = units_.find(text);
+            if(pos != units_.end()) return pos->second;
+        }
+        // Parse without holding the lock.  If another thread wins
+        // the race, its result is kept and ours is discarded.
+        runtime_unit result = parse_unit(text, *table_);
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        return units_.try_emplace(std::string(text), result).first->second;
+    }
+
+    /// Discards all cached units and factors.
+    void clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        factors_.clear();
+        units_.clear();
+    }
+private:
+    using key_type = std::pair<std::string, std::string>;
+    using key_view = std::pair<std::string_view, std::string_view>;
+    struct key_hash {
+        using is_transparent = void;
+        std::size_t operator()(const key_view& k) const noexcept
+        {
+            std::size_t h = std::hash<std::string_view>()(k.first);
+            return h ^ (std::hash<std::string_view>()(k.second) + 0x9e3779b97f4a7c15u + (h << 6) + (h >> 2));
+        }
+        std::size_t operator()(const key_type& k) const noexcept { return (*this)(key_view(k.first, k.second)); }
+    };
+    struct key_equal {
+        using is_transparent = void;
+        template<class K1, class K2>
+        bool operator()(const K1& lhs, const K2& rhs) const noexcept
+        {
+            return std::string_view(lhs.first) == std::string_view(rhs.first) &&
+                std::string_view(lhs.second) == std::string_view(rhs.second);
+        }
+    };
+
+    const unit_symbol_table* table_;
+    std::shared_mutex mutex_;
+    std::unordered_map<key_type, double, key_hash, key_equal> factors_;
+    std::unordered_map<std::string, runtime_unit, detail::string_hash, std::equal_to<>> units_;
+};
+
+}
+}
+
+#endif
@@ -4,8 +4,8 @@
 // accompanying file LICENSE_1_0.txt or copy at
 // http://www.boost.org/LICENSE_1_0.txt)
 
-#ifndef BOOST_UNITS2_DIMENSIONS_HPP_INCLUDED
-#define BOOST_UNITS2_DIMENSIONS_HPP_INCLUDED
+#ifndef BOOST_UNITS2_SI_HPP_INCLUDED
+#define BOOST_UNITS2_SI_HPP_INCLUDED
 
 #include <boost/units2/unit.hpp>
 #include <boost/units2/def.hpp>
@@ -55,6 +55,16 @@ inline constexpr const auto sievert = joule/kilogram;
 inline constexpr const auto katal = mole/second;
 
 }
+
+template<> struct unit_symbol<si::meter_t> { static constexpr const char* value = "m"; };
+template<> struct unit_symbol<si::gram_t> { static constexpr const char* value = "g"; };
+template<> struct unit_symbol<si::second_t> { static constexpr const char* value = "s"; };
+template<> struct unit_symbol<si::kelvin_t> { static constexpr const char* value = "K"; };
+template<> struct unit_symbol<si::mole_t> { static constexpr const char* value = "mol"; };
+template<> struct unit_symbol<si::ampere_t> { static constexpr const char* value = "A"; };
+template<> struct unit_symbol<si::candela_t> { static constexpr const char* value = "cd"; };
+template<> struct unit_symbol<si::radian_t> { static constexpr const char* value = "rad"; };
+template<> struct unit_symbol<si::steradian_t> { static constexpr const char* value = "sr"; };
 }
 }
 
@@ -0,0 +1,45 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_SIMD_HPP_INCLUDED
+#define BOOST_UNITS2_SIMD_HPP_INCLUDED
+
+// Support for std::experimental::simd as the value_type of a quantity.
+//
+// quantity<Unit, simd<T>> holds one value per lane, all in Unit.  The
+// arithmetic and comparison operators work lane by lane, and return
+// simd_masks for comparisons.  Conversion factors are applied as a
+// single T, which the pack broadcasts.  Packs of integers are converted
+// with integer arithmetic when the factor is rational, and truncated
+// toward zero.  For other vector types, specialize numeric_traits in
+// the same way.
+
+#include <boost/units2/quantity.hpp>
+
+#if defined(__has_include)
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#endif
+#endif
+
+#ifdef __cpp_lib_experimental_parallel_simd
+
+namespace boost {
+namespace units2 {
+
+template<class T, class Abi>
+struct numeric_traits<std::experimental::simd<T, Abi>>
+{
+    static constexpr bool is_numeric = true;
+    using scalar_type = T;
+};
+
+}
+}
+
+#endif
+
+#endif
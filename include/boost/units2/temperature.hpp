@@ -12,13 +12,17 @@
 
 namespace boost {
 namespace units2 {
-namespace temperature {
+namespace temperatures {
 
-constexpr auto kelvin = absolute_unit(si::kelvin);
-constexpr auto celsius = absolute_unit(kelvin, std::ratio<27315,100>());
-constexpr auto fahrenheit = absolute_unit(celsius * std::ratio<5,9>(), std::ratio<-32>());
+inline constexpr auto kelvin = absolute_unit(si::kelvin);
+inline constexpr auto celsius = absolute_unit(kelvin, std::ratio<27315,100>());
+inline constexpr auto fahrenheit = absolute_unit(celsius * std::ratio<5,9>(), std::ratio<-32>());
 
 }
+
+template<> struct unit_symbol<std::remove_cv_t<decltype(temperatures::celsius)>> { static constexpr const char* value = "\xC2\xB0" "C"; };
+template<> struct unit_symbol<std::remove_cv_t<decltype(temperatures::fahrenheit)>> { static constexpr const char* value = "\xC2\xB0" "F"; };
+
 }
 }
 
@@ -8,13 +8,12 @@
 #define BOOST_UNITS2_UNIT_HPP_INCLUDED
 
 #include <boost/units2/detail/merge.hpp>
-#include <boost/mp11/algorithm.hpp>
+#include <boost/mp11/list.hpp>
 #include <boost/mp11/utility.hpp>
-#include <boost/integer/common_factor_ct.hpp>
 #include <type_traits>
 #include <limits>
 #include <cstdint>
-#include <cmath>
+#include <ratio>
 
 // Design goals:
 // - Can represent any unit.
@@ -41,10 +40,12 @@
 // - All units are reduced to normalized form after every operation.
 // - The different types of units can be processed using a visitor via the
 //   alias _boost_units2_apply.
-//
-// Possible improvements:
-// - Allow floating point scaling to have greater precision than double.
-//   This also means passing the value_type through all the conversion logic.
+// - dense_unit (dense_unit.hpp) is an alternative normalized form that
+//   stores the dimension and scale as a value, for the dimensions in
+//   dimensions.hpp.  It is also unique: the scale is factored into primes.
+// - Conversion factors are evaluated in the type requested by the caller
+//   (at least double).  A scale can provide more precision than double
+//   by making value a template on the result type.
 
 namespace boost {
 namespace units2 {
@@ -79,6 +80,7 @@ struct unit_base {
  * Represents a unit that is a scaled version of another unit.
  * \pre Base is a Unit
  * \pre Scale is either a std::ratio or a type with a nested static constexpr double value();
+ *      value may also be a template taking the result type as its first parameter.
  */
 template<class Base, class Scale>
 struct scaled_unit : unit_base<scaled_unit<Base, Scale> > {
@@ -121,10 +123,24 @@ struct compound_unit<P0, P...> : unit_base<compound_unit<P0,P...>> {
     auto operator<=>(const compound_unit&) const = default;
 };
 
+/**
+ * The symbol that is printed for the unit T (see format.hpp), as a
+ * static constexpr const char* value.  Defaults to the name of units
+ * defined by BOOST_UNITS2_DEF.  Specialize it to give a unit a shorter
+ * symbol, or to print a derived unit as a single symbol.  Units that
+ * have no symbol are printed by combining the symbols of their parts.
+ */
+template<class T, class = void>
+struct unit_symbol {};
+template<class T>
+struct unit_symbol<T, std::void_t<decltype(T::name)>> {
+    static constexpr const char* value = T::name;
+};
+
 namespace detail {
 
 template<class F, class T>
-using visit = typename T::template _boost_units_apply2<F, T>;
+using visit = typename T::template _boost_units2_apply<F, T>;
 
 constexpr int const_strcmp(const char * lhs, const char * rhs)
 {
@@ -135,19 +151,19 @@ constexpr int const_strcmp(const char * lhs, const char * rhs)
 
 template<class T, class U>
 struct scale_compare {
-    static constexpr const int value = T::value() < U::value?-1:(T::value()>U::value()?1:0);
+    static constexpr const int value = T::value() < U::value()?-1:(T::value()>U::value()?1:0);
 };
-template<class T, long long N, long long D>
+template<class T, std::intmax_t N, std::intmax_t D>
 struct scale_compare<T,std::ratio<N,D>>
 {
     static const constexpr int value = 1;
 };
-template<class T, long long N, long long D>
+template<class T, std::intmax_t N, std::intmax_t D>
 struct scale_compare<std::ratio<N,D>,T>
 {
     static const constexpr int value = -1;
 };
-template<long long N1, long long D1, long long N2, long long D2>
+template<std::intmax_t N1, std::intmax_t D1, std::intmax_t N2, std::intmax_t D2>
 struct scale_compare<std::ratio<N1,D1>,std::ratio<N2,D2>>
 {
     static const constexpr int value = std::ratio_less<std::ratio<N1,D1>,std::ratio<N2,D2>>::value?-1:
@@ -195,7 +211,7 @@ template<class B1, class E1, class B2, class E2>
 struct unit_compare_impl<scaled_unit<B1, E1>, scaled_unit<B2, E2> >
 {
     static const constexpr int value = (unit_compare_impl<B1, B2>::value != 0)?
-        (unit_compare_impl<B1, B2>::value != 0):
+        unit_compare_impl<B1, B2>::value:
         scale_compare<E1, E2>::value;
 };
 
@@ -274,13 +290,11 @@ using unit_multiply = simplify_unit<compound_unit_multiply<as_compound_unit<T>,
 
 template<class T, class E>
 struct unit_pow_impl;
+// A separate partial specialization for std::ratio<0> is
+// ambiguous with this one on some compilers.
 template<class... T, class... E, class R>
 struct unit_pow_impl<compound_unit<dim<T, E>...>, R> {
-    using type = compound_unit<dim<T, std::ratio_multiply<E, R> >...>;
-};
-template<class... T, class... E>
-struct unit_pow_impl<compound_unit<dim<T, E>...>, std::ratio<0>> {
-    using type = compound_unit<>;
+    using type = ::boost::mp11::mp_if_c<R::num == 0, compound_unit<>, compound_unit<dim<T, std::ratio_multiply<E, R> >...>>;
 };
 template<class T, class E>
 using unit_pow = simplify_unit<typename unit_pow_impl<as_compound_unit<T>, E>::type>;
@@ -292,6 +306,16 @@ using unit_divide = unit_multiply<T, unit_pow<U, std::ratio<-1>>>;
 template<class T>
 using requires_unit = typename T::_boost_units2_is_unit;
 
+// Units that define their own arithmetic, such as dense_unit,
+// mark themselves with _boost_units2_own_arithmetic.  The generic
+// operators below do not apply to them.
+template<class T, class = void>
+struct has_own_arithmetic : std::false_type {};
+template<class T>
+struct has_own_arithmetic<T, typename T::_boost_units2_own_arithmetic> : std::true_type {};
+template<class T>
+using requires_generic_unit = std::enable_if_t<!has_own_arithmetic<T>::value, requires_unit<T>>;
+
 template<class T, class E = void>
 struct is_unit_impl {
     using type = std::false_type;
@@ -308,35 +332,35 @@ using requires_scale = typename T::_boost_units2_is_scale;
 
 } // namespace detail
 
-template<class T, class U, class = detail::requires_unit<T>, class = detail::requires_unit<U> >
+template<class T, class U, class = detail::requires_generic_unit<T>, class = detail::requires_generic_unit<U> >
 constexpr auto operator*(T, U) -> detail::unit_multiply<T, U>
 { return {}; }
 
-template<class T, class U, class = detail::requires_unit<T>, class = detail::requires_unit<U> >
+template<class T, class U, class = detail::requires_generic_unit<T>, class = detail::requires_generic_unit<U> >
 constexpr auto operator/(T, U) -> detail::unit_divide<T, U>
 { return {}; }
 
 // multiplying a unit by a std::ratio creates a scaled_unit
-template<class T, long long N, long long D, class = detail::requires_unit<T>>
+template<class T, std::intmax_t N, std::intmax_t D, class = detail::requires_generic_unit<T>>
 constexpr auto operator*(T, std::ratio<N,D>) -> detail::simplify_unit<scaled_unit<T, typename std::ratio<N,D>::type>>
 { return {}; }
-template<class T, long long N, long long D, class = detail::requires_unit<T>>
+template<class T, std::intmax_t N, std::intmax_t D, class = detail::requires_generic_unit<T>>
 constexpr auto operator*(std::ratio<N,D>, T) -> detail::simplify_unit<scaled_unit<T, typename std::ratio<N,D>::type>>
 { return {}; }
 
 // multiplying a unit by any scale gives a scaled unit
-template<class T, class U, class = detail::requires_unit<T>, class = detail::requires_scale<U> >
+template<class T, class U, class = detail::requires_generic_unit<T>, class = detail::requires_scale<U> >
 constexpr auto operator*(T, U) -> detail::simplify_unit<scaled_unit<T, U>>
 { return {}; }
-template<class T, class U, class = detail::requires_scale<T>, class = detail::requires_unit<U> >
+template<class T, class U, class = detail::requires_scale<T>, class = detail::requires_generic_unit<U> >
 constexpr auto operator*(T, U) -> detail::simplify_unit<scaled_unit<U,T>>
 { return {}; }
 
-template<std::intmax_t N, class T, class = detail::requires_unit<T>>
+template<std::intmax_t N, class T, class = detail::requires_generic_unit<T>>
 constexpr auto pow(T) -> detail::unit_pow<T, std::ratio<N>>
 { return {}; }
 
-    template<class T, std::intmax_t N, std::intmax_t D, class = detail::requires_unit<T>>
+    template<class T, std::intmax_t N, std::intmax_t D, class = detail::requires_generic_unit<T>>
 constexpr auto pow(T, std::ratio<N,D>) -> detail::unit_pow<T, std::ratio<N,D>>
 { return {}; }
 
@@ -383,7 +407,7 @@ struct flatten_scale_impl
     using apply_scaled = scale_list_multiply<flatten_scale<Base>, scale_list<dim<Scale, std::ratio<1>>>>;
 
     template<class... T>
-    using apply_compound = boost::mp11::mp_fold<boost::mp11::mp_list<scale_list_pow<flatten_scale<typename T::base>, typename T::exponent>...>, scale_list<>, scale_list_multiply>;
+    using apply_compound = merge_all<scale_compare, scale_list, scale_list_pow<flatten_scale<typename T::base>, typename T::exponent>...>;
 };
 
 struct dimension_check_impl;
@@ -398,22 +422,103 @@ struct dimension_check_impl
     using apply_scaled = dimension_check<Base>;
 
     template<class... T>
-    using apply_compound = ::boost::mp11::mp_fold< boost::mp11::mp_list<unit_pow<dimension_check<typename T::base>, typename T::exponent>...>, compound_unit<>, unit_multiply>;
+    using apply_compound = simplify_unit<merge_all<unit_compare_impl, compound_unit, as_compound_unit<unit_pow<dimension_check<typename T::base>, typename T::exponent>>...>>;
+
+    template<class Unit, class Offset>
+    using apply_absolute = dimension_check<Unit>;
 };
 
-template<class T>
-constexpr double get_value(T) { return T::value(); }
-template<long long N, long long D>
-constexpr double get_value(std::ratio<N, D>) { return static_cast<double>(N)/D; }
+// The type used to evaluate a scale whose result is R.
+// Computing in at least double means that a float result is
+// only rounded once.
+template<class R>
+using scale_compute_t = std::common_type_t<R, double>;
+
+// A scale may define value as a template on the result type
+// to provide more precision than double.
+template<class R, class T>
+constexpr auto get_scale_value(T, int) -> decltype(T::template value<R>()) { return T::template value<R>(); }
+template<class R, class T>
+constexpr auto get_scale_value(T, long) -> decltype(T::value()) { return T::value(); }
+
+template<class R = double, class T>
+constexpr R get_value(T t) { return static_cast<R>(::boost::units2::detail::get_scale_value<R>(t, 0)); }
+template<class R = double, std::intmax_t N, std::intmax_t D>
+constexpr R get_value(std::ratio<N, D>) { return static_cast<R>(N)/static_cast<R>(D); }
 
 template<class T, class U>
 struct multiplier {
-    static constexpr double value() { return ::boost::units2::detail::get_value(T()) * ::boost::units2::detail::get_value(U()); }
+    template<class R = double>
+    static constexpr R value() { return ::boost::units2::detail::get_value<R>(T()) * ::boost::units2::detail::get_value<R>(U()); }
 };
 
+// x^n for integer n, by repeated squaring.
+template<class T>
+constexpr T integer_power(T base, std::intmax_t exponent)
+{
+    if(exponent < 0) return T(1) / ::boost::units2::detail::integer_power(base, -exponent);
+    T result = 1;
+    while(exponent != 0)
+    {
+        if(exponent % 2) result *= base;
+        exponent /= 2;
+        // Don't square past the last bit, as it might overflow
+        if(exponent != 0) base *= base;
+    }
+    return result;
+}
+
+// The positive n-th root of x, using Newton's method.
+// precondition: x > 0, n > 0
+template<class T>
+constexpr T integer_root(T x, std::intmax_t n)
+{
+    if(n == 1) return x;
+    // Scale x into [1, 2^n) by exact powers of two, so that the
+    // root lies in [1, 2).
+    const T step = ::boost::units2::detail::integer_power(T(2), n);
+    T scale = 1;
+    while(x >= step) { x /= step; scale *= 2; }
+    while(x < 1) { x *= step; scale /= 2; }
+    // Starting above the root, Newton's method decreases monotonically
+    // until it hits the limit of precision.
+    T y = 2;
+    while(true)
+    {
+        T next = ((n - 1) * y + x / ::boost::units2::detail::integer_power(y, n - 1)) / n;
+        if(!(next < y)) break;
+        y = next;
+    }
+    return y * scale;
+}
+
+// x^(num/den).  The root is taken first, because it moves
+// the value toward 1 and therefore cannot overflow.
+template<class T>
+constexpr T rational_power(T base, std::intmax_t num, std::intmax_t den)
+{
+    return ::boost::units2::detail::integer_power(::boost::units2::detail::integer_root(base, den), num);
+}
+
 template<class B, class E>
 struct power {
-    static /*constexpr*/ double value() { return ::std::pow(::boost::units2::detail::get_value(B()), ::boost::units2::detail::get_value(E())); }
+    template<class R = double>
+    static constexpr R value() { return ::boost::units2::detail::rational_power(::boost::units2::detail::get_value<R>(B()), E::num, E::den); }
+};
+
+// For a ratio, raise the numerator and denominator separately, which
+// keeps integer powers exact for as long as the result fits in a double.
+template<std::intmax_t N, std::intmax_t D, class E>
+struct power<std::ratio<N, D>, E> {
+    template<class R = double>
+    static constexpr R value()
+    {
+        return E::num < 0?
+            ::boost::units2::detail::rational_power(static_cast<R>(D), -E::num, E::den) /
+                ::boost::units2::detail::rational_power(static_cast<R>(N), -E::num, E::den) :
+            ::boost::units2::detail::rational_power(static_cast<R>(N), E::num, E::den) /
+                ::boost::units2::detail::rational_power(static_cast<R>(D), E::num, E::den);
+    }
 };
 
 // Returns 0 if overflow would happen
@@ -421,33 +526,49 @@ struct power {
 template<class T, class U>
 struct safe_ratio_multiply
 {
-    static const constexpr long long gcd1 = ::boost::integer::static_gcd<T::num, U::den>::value;
-    static const constexpr long long gcd2 = ::boost::integer::static_gcd<U::num, T::den>::value;
+    static const constexpr std::intmax_t gcd1 = ::boost::units2::detail::merge_gcd(T::num, U::den);
+    static const constexpr std::intmax_t gcd2 = ::boost::units2::detail::merge_gcd(U::num, T::den);
     static const constexpr bool overflow =
-        (std::numeric_limits<long long>::max()/(T::num/gcd1) > (U::num/gcd2)) ||
-        (std::numeric_limits<long long>::max()/(T::den/gcd1) > (U::den/gcd1));
+        (std::numeric_limits<std::intmax_t>::max()/(T::num/gcd1) < (U::num/gcd2)) ||
+        (std::numeric_limits<std::intmax_t>::max()/(T::den/gcd2) < (U::den/gcd1));
     using type = std::ratio<
         overflow?0:(T::num/gcd1)*(U::num/gcd2),
-        overflow?1:(T::den/gcd1)*(U::den/gcd1)>;
+        overflow?1:(T::den/gcd2)*(U::den/gcd1)>;
 };
 
-constexpr long long safe_multiply(long long lhs, long long rhs)
+constexpr std::intmax_t safe_multiply(std::intmax_t lhs, std::intmax_t rhs)
 {
-    return (std::numeric_limits<long long>::max)()/lhs >= rhs? lhs*rhs : 0;
+    return (lhs != 0 && (std::numeric_limits<std::intmax_t>::max)()/lhs >= rhs)? lhs*rhs : 0;
 }
-constexpr long long safe_square(long long arg)
+constexpr std::intmax_t safe_square(std::intmax_t arg)
 {
     return safe_multiply(arg, arg);
 }
-constexpr long long safe_power(long long base, long long exponent) {
+constexpr std::intmax_t safe_power(std::intmax_t base, std::intmax_t exponent) {
     return exponent == 1? base : safe_multiply(safe_square(safe_power(base, exponent/2)), (exponent%2?base:1));
 }
 
-template<class B, long long E>
+// Returns r such that r^n == arg, or 0 if there is no such integer.
+constexpr std::intmax_t exact_root(std::intmax_t arg, std::intmax_t n)
+{
+    std::intmax_t lo = 1, hi = arg;
+    while(lo <= hi)
+    {
+        std::intmax_t mid = lo + (hi - lo) / 2;
+        // safe_power returns 0 on overflow, which is certainly too large.
+        std::intmax_t p = safe_power(mid, n);
+        if(p == arg) return mid;
+        else if(p != 0 && p < arg) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return 0;
+}
+
+template<class B, std::intmax_t E>
 struct safe_ratio_pow {
-    static const constexpr long long abs_exponent = E < 0? -E : E;
-    static const constexpr long long num = safe_power(E<0?B::den:B::num, abs_exponent);
-    static const constexpr long long den = safe_power(E<0?B::num:B::den, abs_exponent);
+    static const constexpr std::intmax_t abs_exponent = E < 0? -E : E;
+    static const constexpr std::intmax_t num = safe_power(E<0?B::den:B::num, abs_exponent);
+    static const constexpr std::intmax_t den = safe_power(E<0?B::num:B::den, abs_exponent);
     static const constexpr bool overflow = num==0||den==0;
     using type = std::ratio<overflow?0:num,overflow?1:den>;
 };
@@ -455,7 +576,7 @@ struct safe_ratio_pow {
 template<class T, class U>
 struct fold_conversion_impl { using type = multiplier<T, U>; };
 
-template<long long N1, long long D1, long long N2, long long D2>
+template<std::intmax_t N1, std::intmax_t D1, std::intmax_t N2, std::intmax_t D2>
 struct fold_conversion_impl<std::ratio<N1,D1>,std::ratio<N2,D2>>
 {
     using result1 = typename safe_ratio_multiply<std::ratio<N1, D1>, std::ratio<N2, D2> >::type;
@@ -469,25 +590,72 @@ struct evaluate_power<dim<Base, Exponent> >
 {
     using type = power<Base, Exponent>;
 };
-template<long long N, long long D, long long E>
-struct evaluate_power<dim<std::ratio<N,D>, std::ratio<E> > >
+// Stays exact as long as the root is rational and the power does not overflow.
+template<std::intmax_t N, std::intmax_t D, std::intmax_t E, std::intmax_t R>
+struct evaluate_power<dim<std::ratio<N,D>, std::ratio<E, R> > >
 {
-    using result1 = typename safe_ratio_pow<std::ratio<N,D>, E>::type;
-    using type = ::boost::mp11::mp_if_c<result1::num!=0, result1, power<std::ratio<N,D>, std::ratio<E> > >;
+    static const constexpr std::intmax_t root_num = exact_root(N, R);
+    static const constexpr std::intmax_t root_den = exact_root(D, R);
+    static const constexpr bool is_exact = root_num != 0 && root_den != 0;
+    using result1 = typename safe_ratio_pow<std::ratio<is_exact?root_num:1, is_exact?root_den:1>, E>::type;
+    using type = ::boost::mp11::mp_if_c<is_exact && result1::num!=0, result1, power<std::ratio<N,D>, std::ratio<E, R> > >;
 };
 
 template<class T, class U>
 using conversion_fold_op = typename fold_conversion_impl<T,U>::type;
 
+// The fold is a fold expression over this operator, so that it
+// does not need a recursive template.
+template<class T>
+struct conversion_fold_wrap { using type = T; };
+template<class T, class U>
+conversion_fold_wrap<conversion_fold_op<T, U>> operator%(conversion_fold_wrap<T>, conversion_fold_wrap<U>);
+
 template<class... T>
 struct fold_conversion;
 template<class... T>
 struct fold_conversion<scale_list<T...>> {
-    using type = boost::mp11::mp_fold<boost::mp11::mp_list<typename evaluate_power<T>::type...>,std::ratio<1>,conversion_fold_op>;
+    using type = typename decltype((conversion_fold_wrap<std::ratio<1>>() % ... % conversion_fold_wrap<typename evaluate_power<T>::type>()))::type;
+};
+
+template<class T>
+struct is_std_ratio : std::false_type {};
+template<std::intmax_t N, std::intmax_t D>
+struct is_std_ratio<std::ratio<N, D>> : std::true_type {};
+
+// The factor that converts T to U.  This is a std::ratio
+// whenever the factor is rational and does not overflow.
+template<class T, class U>
+using conversion_ratio = typename fold_conversion<flatten_scale<unit_divide<T, U>>>::type;
+
+// Chooses the unit that T and U are converted to when they are
+// combined, so that as few values as possible are scaled.  F is
+// conversion_ratio<T, U>.
+template<class T, class U, class F, bool Integral>
+struct common_unit_impl
+{
+    // Only the coarser unit is scaled.
+    using type = mp11::mp_if_c<(get_value<double>(F()) > 1), U, T>;
+};
+template<class T, class U, std::intmax_t N, std::intmax_t D>
+struct common_unit_impl<T, U, std::ratio<N, D>, false>
+{
+    using type = mp11::mp_if_c<(N > D), U, T>;
+};
+// Integers are only scaled by integers.  If neither unit is a
+// multiple of the other, then both are scaled to a unit that
+// divides them.
+template<class T, class U, std::intmax_t N, std::intmax_t D>
+struct common_unit_impl<T, U, std::ratio<N, D>, true>
+{
+    using type = mp11::mp_if_c<N == 1, T, mp11::mp_if_c<D == 1, U, decltype(std::ratio<1, D>() * U())>>;
 };
 
+template<class T, class U, bool Integral>
+using common_unit_t = typename common_unit_impl<T, U, conversion_ratio<T, U>, Integral>::type;
+
 template<class T, class U>
-void check_conversion() {
+constexpr void check_conversion() {
     static_assert(std::is_same<T, U>::value,
         "Cannot convert units with different dimensions.");
 }
@@ -500,13 +668,47 @@ constexpr bool has_same_dimension(T, U)
     return std::is_same<detail::dimension_check<T>, detail::dimension_check<U>>::value;
 }
 
-template<class T, class U, class = detail::requires_unit<T>, class = detail::requires_unit<U>>
-constexpr double conversion_factor(T, U)
+/**
+ * Returns the factor that converts a value in T to a value in U.
+ * The factor is evaluated in R, or in double if R has less
+ * precision, and then converted to R.
+ */
+template<class R, class T, class U, class = detail::requires_unit<T>, class = detail::requires_unit<U>>
+constexpr R conversion_factor(T, U)
 {
     // Indirection to make sure that the reduced dimensions appear
     // in the template backtrace.
     detail::check_conversion<detail::dimension_check<T>, detail::dimension_check<U>>();
-    return ::boost::units2::detail::get_value(typename detail::fold_conversion<detail::flatten_scale<detail::unit_divide<T, U>>>::type());
+    return static_cast<R>(::boost::units2::detail::get_value<detail::scale_compute_t<R>>(
+        typename detail::fold_conversion<detail::flatten_scale<detail::unit_divide<T, U>>>::type()));
+}
+// R defaults to double.  This is an overload rather than a default
+// template argument, because gcc 12 drops default arguments that precede
+// deduced parameters when the declaration is imported from a module.
+template<class T, class U, class = detail::requires_unit<T>, class = detail::requires_unit<U>>
+constexpr double conversion_factor(T t, U u)
+{
+    return ::boost::units2::conversion_factor<double>(t, u);
+}
+
+/**
+ * Returns the unit that values in T and U are converted to when they
+ * are added, subtracted or compared.  Only the coarser of the two
+ * units is scaled.  When V is an integral type, the units are only
+ * scaled by integers, so that the conversion is exact, which may
+ * require scaling both.
+ */
+template<class V, class T, class U, class = detail::requires_unit<T>, class = detail::requires_unit<U>>
+constexpr auto common_unit(T, U) -> detail::common_unit_t<T, U, !std::is_floating_point<V>::value>
+{
+    detail::check_conversion<detail::dimension_check<T>, detail::dimension_check<U>>();
+    return {};
+}
+/// V defaults to double.
+template<class T, class U, class = detail::requires_unit<T>, class = detail::requires_unit<U>>
+constexpr auto common_unit(T t, U u)
+{
+    return ::boost::units2::common_unit<double>(t, u);
 }
 
 }
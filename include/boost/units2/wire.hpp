@@ -0,0 +1,314 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_UNITS2_WIRE_HPP_INCLUDED
+#define BOOST_UNITS2_WIRE_HPP_INCLUDED
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/quantity_span.hpp>
+#include <boost/units2/quantity_vector.hpp>
+#include <boost/units2/converted_column.hpp>
+#include <boost/units2/conversion_table.hpp>
+#include <boost/units2/fingerprint.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// A binary format for sending quantities between processes.  Each
+// message carries a 64 bit tag in place of the unit, so that the
+// receiver can check the unit with a single comparison.
+//
+// Layout (all integers and values are little endian):
+//
+//   quantity:  u64 tag, value
+//   array:     u64 tag, u64 number of elements, values
+//
+// The tag is the fingerprint of the unit (see fingerprint.hpp),
+// combined with the value type, so that a message with the right unit
+// but the wrong value type is also rejected.  Units with the same
+// canonical spelling, such as units that BOOST_UNITS2_DEF defines with
+// the same name in different namespaces, have the same tag and are
+// accepted for each other (see fingerprint.hpp).  Values are not padded,
+// so an array can only be viewed in place if the buffer is aligned.
+
+namespace boost {
+namespace units2 {
+
+/// Thrown when a message is truncated or in an unexpected unit.
+class wire_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+
+// Mixed into the fingerprint of the unit.  double uses 0, so that the
+// tag of a quantity<Unit> is just the fingerprint of Unit.
+template<class T>
+inline constexpr std::uint64_t wire_value_salt =
+    column_value_type_of<T>::value == column_value_type::float64? 0 :
+    static_cast<std::uint64_t>(column_value_type_of<T>::value) * 0x9e3779b97f4a7c15u;
+
+template<class T>
+T reverse_bytes(const T& x) noexcept
+{
+    auto bytes = std::bit_cast<std::array<unsigned char, sizeof(T)>>(x);
+    std::reverse(bytes.begin(), bytes.end());
+    return std::bit_cast<T>(bytes);
+}
+
+template<class T>
+T load_little_endian(const std::byte* p) noexcept
+{
+    T result;
+    std::memcpy(&result, p, sizeof(T));
+    if constexpr(std::endian::native == std::endian::little) return result;
+    else return ::boost::units2::detail::reverse_bytes(result);
+}
+
+template<class T>
+void store_little_endian(std::byte* p, const T& x) noexcept
+{
+    if constexpr(std::endian::native == std::endian::little) std::memcpy(p, &x, sizeof(T));
+    else
+    {
+        T swapped = ::boost::units2::detail::reverse_bytes(x);
+        std::memcpy(p, &swapped, sizeof(T));
+    }
+}
+
+inline void check_wire_size(std::size_t available, std::size_t required, const char* function)
+{
+    if(available < required)
+        throw wire_error(std::string("boost::units2::") + function + ": buffer too small");
+}
+
+[[noreturn]] inline void wire_unit_mismatch()
+{
+    throw wire_error("boost::units2::read_wire: no conversion from the unit of the message");
+}
+
+// Only accepts messages in the unit being read.
+struct exact_wire_conversion {};
+
+// Returns the conversion of a value with the tag key to Unit, which
+// is not the tag of Unit.  The sender's fingerprint is recovered by
+// removing the salt of T.  If the sender used a different value type,
+// this gives an unrelated value, which is not found.
+
+template<auto Unit, class T>
+affine_factors<double> wire_conversion(std::uint64_t, exact_wire_conversion)
+{
+    ::boost::units2::detail::wire_unit_mismatch();
+}
+
+template<auto Unit, class T, auto... Units>
+affine_factors<double> wire_conversion(std::uint64_t key, conversion_table<Units...>)
+{
+    using table = conversion_table<Units...>;
+    constexpr std::size_t to = table::index_of(fingerprint_v<decltype(Unit)>);
+    static_assert(to != table::npos, "The unit being read must be in the conversion_table.");
+    std::size_t from = table::index_of(key ^ wire_value_salt<T>);
+    if(from == table::npos || table::dimensions[from] != table::dimensions[to])
+        ::boost::units2::detail::wire_unit_mismatch();
+    return table::affine_at(from, to);
+}
+
+template<auto Unit, class T>
+affine_factors<double> wire_conversion(std::uint64_t key, const unit_registry& registry)
+{
+    if(std::optional<affine_factors<double>> result = registry.find_affine(key ^ wire_value_salt<T>, fingerprint_v<decltype(Unit)>))
+        return *result;
+    ::boost::units2::detail::wire_unit_mismatch();
+}
+
+// As wire_conversion, but the exact factor, for integers.  There is
+// none if the factor is irrational or has an offset.
+
+template<auto Unit, class T>
+rational wire_ratio(std::uint64_t, exact_wire_conversion)
+{
+    ::boost::units2::detail::wire_unit_mismatch();
+}
+
+template<auto Unit, class T, auto... Units>
+rational wire_ratio(std::uint64_t key, conversion_table<Units...>)
+{
+    using table = conversion_table<Units...>;
+    constexpr std::size_t to = table::index_of(fingerprint_v<decltype(Unit)>);
+    static_assert(to != table::npos, "The unit being read must be in the conversion_table.");
+    std::size_t from = table::index_of(key ^ wire_value_salt<T>);
+    if(from == table::npos || table::dimensions[from] != table::dimensions[to] || !table::ratio_at(from, to).valid())
+        ::boost::units2::detail::wire_unit_mismatch();
+    return table::ratio_at(from, to);
+}
+
+template<auto Unit, class T>
+rational wire_ratio(std::uint64_t key, const unit_registry& registry)
+{
+    if(std::optional<rational> result = registry.find_ratio(key ^ wire_value_salt<T>, fingerprint_v<decltype(Unit)>))
+        return *result;
+    ::boost::units2::detail::wire_unit_mismatch();
+}
+
+}
+
+/// The tag that identifies quantity<Unit, T> in a message.
+template<auto Unit, class T = double>
+inline constexpr std::uint64_t wire_tag_v = fingerprint_v<decltype(Unit)> ^ detail::wire_value_salt<T>;
+
+/// The size in bytes of a quantity with values of type T.
+template<class T>
+inline constexpr std::size_t wire_size = sizeof(std::uint64_t) + sizeof(T);
+
+/// The size in bytes of an array of n quantities with values of type T.
+template<class T>
+constexpr std::size_t wire_array_size(std::size_t n) noexcept
+{
+    return 2 * sizeof(std::uint64_t) + n * sizeof(T);
+}
+
+/// Writes q to out and returns the number of bytes written, which
+/// is wire_size<T>.  Throws wire_error if out is too small.
+template<auto Unit, class T>
+std::size_t write_wire(std::span<std::byte> out, const quantity<Unit, T>& q)
+{
+    ::boost::units2::detail::check_wire_size(out.size(), wire_size<T>, "write_wire");
+    ::boost::units2::detail::store_little_endian(out.data(), wire_tag_v<Unit, T>);
+    ::boost::units2::detail::store_little_endian(out.data() + sizeof(std::uint64_t), q.value());
+    return wire_size<T>;
+}
+
+/// Writes an array of quantities to out and returns the number of bytes
+/// written, which is wire_array_size<T>(q.size()).  Throws wire_error
+/// if out is too small.
+template<auto Unit, class T, std::size_t E>
+std::size_t write_wire(std::span<std::byte> out, std::span<const quantity<Unit, T>, E> q)
+{
+    const std::size_t size = wire_array_size<T>(q.size());
+    ::boost::units2::detail::check_wire_size(out.size(), size, "write_wire");
+    std::byte* p = out.data();
+    ::boost::units2::detail::store_little_endian(p, wire_tag_v<Unit, T>);
+    ::boost::units2::detail::store_little_endian(p + sizeof(std::uint64_t), static_cast<std::uint64_t>(q.size()));
+    p += 2 * sizeof(std::uint64_t);
+    if constexpr(std::endian::native == std::endian::little)
+    {
+        if(!q.empty()) std::memcpy(p, ::boost::units2::as_values(q).data(), q.size() * sizeof(T));
+    }
+    else
+    {
+        for(std::size_t i = 0; i < q.size(); ++i)
+            ::boost::units2::detail::store_little_endian(p + i * sizeof(T), q[i].value());
+    }
+    return size;
+}
+template<auto Unit, class T, std::size_t E>
+std::size_t write_wire(std::span<std::byte> out, std::span<quantity<Unit, T>, E> q)
+{
+    return ::boost::units2::write_wire(out, std::span<const quantity<Unit, T>, E>(q));
+}
+template<auto Unit, class T, class Alloc>
+std::size_t write_wire(std::span<std::byte> out, const quantity_vector<Unit, T, Alloc>& q)
+{
+    return ::boost::units2::write_wire(out, std::span<const quantity<Unit, T>>(q.data(), q.size()));
+}
+
+/**
+ * Reads a quantity in Unit with values of type T.  If the message is
+ * in Unit, this costs one comparison.  Otherwise, the message may be
+ * in any unit of the same dimension that is listed in conversions,
+ * which is either a conversion_table or a unit_registry, and the value
+ * is multiplied by the precomputed factor, and for absolute units, the
+ * offset is added.  Integers are instead converted exactly by the
+ * rational factor, rounding toward zero, and only between units whose
+ * factor is rational and has no offset.  Throws wire_error if the
+ * message is truncated or cannot be converted, or if a converted
+ * integer does not fit in T.
+ */
+template<auto Unit, class T = double, class Conversions>
+quantity<Unit, T> read_wire(std::span<const std::byte> in, const Conversions& conversions)
+{
+    using scale_type = detail::choose_scale_type<void, T>;
+    ::boost::units2::detail::check_wire_size(in.size(), wire_size<T>, "read_wire");
+    const std::uint64_t key = ::boost::units2::detail::load_little_endian<std::uint64_t>(in.data());
+    const T value = ::boost::units2::detail::load_little_endian<T>(in.data() + sizeof(std::uint64_t));
+    if(key == wire_tag_v<Unit, T>) [[likely]]
+        return quantity<Unit, T>::from_value(value);
+    if constexpr(detail::is_integer_value<T>)
+    {
+        const detail::rational ratio = ::boost::units2::detail::wire_ratio<Unit, T>(key, conversions);
+        const detail::integer_conversion_result<T> result = detail::integer_convert<T>(ratio.num, ratio.den, value);
+        if(result.overflow) throw wire_error("boost::units2::read_wire: the converted value is out of range");
+        return quantity<Unit, T>::from_value(result.value);
+    }
+    else
+    {
+        const affine_factors<double> conversion = ::boost::units2::detail::wire_conversion<Unit, T>(key, conversions);
+        const auto factor = static_cast<scale_type>(conversion.scale);
+        if(conversion.offset == 0) return quantity<Unit, T>::from_value(static_cast<T>(value * factor));
+        return quantity<Unit, T>::from_value(static_cast<T>(value * factor + static_cast<scale_type>(conversion.offset)));
+    }
+}
+template<auto Unit, class T = double>
+quantity<Unit, T> read_wire(std::span<const std::byte> in)
+{
+    return ::boost::units2::read_wire<Unit, T>(in, detail::exact_wire_conversion());
+}
+
+/**
+ * Views an array of quantities in place.  The result refers to in,
+ * and converts each element as it is read, as read_wire does, unless
+ * the message is already in Unit.  Throws wire_error if the message
+ * is truncated or cannot be converted, or if the values are not
+ * aligned for T.  Elements are not checked for overflow; an integer
+ * that does not fit in T after conversion wraps, as in quantity_cast.
+ */
+template<auto Unit, class T = double, class Conversions>
+converted_column<Unit, T> read_wire_array(std::span<const std::byte> in, const Conversions& conversions)
+{
+    static_assert(std::endian::native == std::endian::little,
+        "Arrays can only be viewed in place on little endian machines.");
+    using scale_type = typename converted_column<Unit, T>::scale_type;
+    ::boost::units2::detail::check_wire_size(in.size(), wire_array_size<T>(0), "read_wire_array");
+    const std::uint64_t key = ::boost::units2::detail::load_little_endian<std::uint64_t>(in.data());
+    const std::uint64_t size = ::boost::units2::detail::load_little_endian<std::uint64_t>(in.data() + sizeof(std::uint64_t));
+    if(size > (in.size() - wire_array_size<T>(0)) / sizeof(T))
+        throw wire_error("boost::units2::read_wire_array: buffer too small");
+    const std::byte* data = in.data() + wire_array_size<T>(0);
+    if(reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0)
+        throw wire_error("boost::units2::read_wire_array: misaligned values");
+    if constexpr(detail::is_integer_value<T>)
+    {
+        const detail::rational ratio = key == wire_tag_v<Unit, T>? detail::rational(1) :
+            ::boost::units2::detail::wire_ratio<Unit, T>(key, conversions);
+        return converted_column<Unit, T>(reinterpret_cast<const T*>(data), static_cast<std::size_t>(size), ratio);
+    }
+    else
+    {
+        const affine_factors<double> conversion = key == wire_tag_v<Unit, T>? affine_factors<double>{ 1, 0 } :
+            ::boost::units2::detail::wire_conversion<Unit, T>(key, conversions);
+        return converted_column<Unit, T>(reinterpret_cast<const T*>(data), static_cast<std::size_t>(size),
+            static_cast<scale_type>(conversion.scale), static_cast<scale_type>(conversion.offset));
+    }
+}
+template<auto Unit, class T = double>
+converted_column<Unit, T> read_wire_array(std::span<const std::byte> in)
+{
+    return ::boost::units2::read_wire_array<Unit, T>(in, detail::exact_wire_conversion());
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,53 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Interface of the boost.units2 module.
+//
+//   import boost.units2;
+//
+// is equivalent to including core.hpp, rounding.hpp, si.hpp and
+// temperature.hpp, except that the headers are only parsed once, when
+// the module is built, and the SI derived units are computed in the
+// module instead of in every translation unit that uses them.
+//
+// The library headers are included in the purview inside
+// export extern "C++", so that their declarations stay attached to
+// the global module, as if they had been included.  Third party
+// headers are included in the global module fragment, so that they
+// are not exported.
+//
+// Macros are not exported.  To use BOOST_UNITS2_DEF, include def.hpp
+// in addition to the import.  That relies on the compiler merging the
+// declarations from the header with the ones from the module, which
+// gcc 12 does not do.
+//
+// This is a single interface unit rather than separate core and si
+// partitions, because gcc 12 mishandles declarations that come from
+// headers shared between partitions.  gcc 12 also requires any
+// #includes to come before the import.
+
+module;
+
+#include <boost/mp11/list.hpp>
+#include <boost/mp11/utility.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <ratio>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+export module boost.units2;
+
+export extern "C++" {
+#include <boost/units2/core.hpp>
+#include <boost/units2/rounding.hpp>
+#include <boost/units2/si.hpp>
+#include <boost/units2/temperature.hpp>
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/temperature.hpp>
+#include <boost/units2/absolute.hpp>
+#include <boost/units2/batch.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <array>
+#include <span>
+#include <type_traits>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+using temperatures::kelvin;
+using temperatures::celsius;
+using temperatures::fahrenheit;
+
+template<class T, class U>
+constexpr bool same_unit = std::is_same<std::remove_cv_t<T>, std::remove_cv_t<U>>::value;
+
+BOOST_AUTO_TEST_CASE(test_normal_form)
+{
+    static_assert(same_unit<decltype(kelvin), absolute_unit<std::remove_cv_t<decltype(si::kelvin)>>>);
+    static_assert(same_unit<decltype(celsius), absolute_unit<std::remove_cv_t<decltype(si::kelvin)>, std::ratio<27315, 100>::type>>);
+    // 32 degrees Fahrenheit is 273.15 K, which is 459.67 steps of 5/9 K.
+    using unit = std::remove_cv_t<decltype(si::kelvin * std::ratio<5, 9>())>;
+    static_assert(same_unit<decltype(fahrenheit), absolute_unit<unit, std::ratio<45967, 100>>>);
+}
+
+BOOST_AUTO_TEST_CASE(test_affine_conversion)
+{
+    constexpr auto c_to_f = affine_conversion(celsius, fahrenheit);
+    static_assert(c_to_f.scale == 1.8);
+    static_assert(c_to_f.offset == 32.0);
+    constexpr auto f_to_k = affine_conversion<float>(fahrenheit, kelvin);
+    static_assert(std::is_same<decltype(f_to_k), const affine_factors<float>>::value);
+    BOOST_TEST(f_to_k.offset == 255.372222f, boost::test_tools::tolerance(1e-6f));
+    constexpr auto k_to_k = affine_conversion(kelvin, kelvin);
+    static_assert(k_to_k.scale == 1 && k_to_k.offset == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_convert)
+{
+    constexpr quantity<fahrenheit> boiling(100.0 * celsius);
+    BOOST_TEST(boiling.value() == 212.0, boost::test_tools::tolerance(1e-12));
+    constexpr quantity<kelvin> freezing(0.0 * celsius);
+    BOOST_TEST(freezing.value() == 273.15, boost::test_tools::tolerance(1e-12));
+    quantity<celsius> body(98.6 * fahrenheit);
+    BOOST_TEST(body.value() == 37.0, boost::test_tools::tolerance(1e-12));
+    quantity<fahrenheit> minus_forty(-40.0 * celsius);
+    BOOST_TEST(minus_forty.value() == -40.0, boost::test_tools::tolerance(1e-12));
+    // Integers go through the floating point conversion.
+    BOOST_TEST((quantity<celsius, int>(quantity<kelvin, int>::from_value(300)).value() == 26));
+    static_assert(sizeof(quantity<celsius>) == sizeof(double));
+}
+
+BOOST_AUTO_TEST_CASE(test_arithmetic)
+{
+    auto t1 = 20.0 * celsius;
+    auto t2 = 50.0 * fahrenheit;
+    // The difference is relative, in the unit of the first operand.
+    auto diff = t1 - t2;
+    static_assert(same_unit<decltype(diff.unit()), decltype(si::kelvin)>);
+    BOOST_TEST(diff.value() == 10.0, boost::test_tools::tolerance(1e-12));
+    auto diff_f = t2 - t1;
+    static_assert(same_unit<decltype(diff_f.unit()), decltype(si::kelvin * std::ratio<5, 9>())>);
+    BOOST_TEST(diff_f.value() == -18.0, boost::test_tools::tolerance(1e-12));
+
+    // absolute +- relative stays in the absolute unit.
+    auto warmer = t1 + 5.0 * si::kelvin;
+    static_assert(std::is_same<decltype(warmer), quantity<celsius, double>>::value);
+    BOOST_TEST(warmer.value() == 25.0);
+    BOOST_TEST((5.0 * si::kelvin + t1).value() == 25.0);
+    BOOST_TEST((t1 - 9.0 * (si::kelvin * std::ratio<5, 9>())).value() == 15.0, boost::test_tools::tolerance(1e-12));
+
+    // Comparisons convert to the unit of the first operand.
+    BOOST_TEST((t1 > t2));
+    BOOST_TEST((t2 < t1));
+    BOOST_TEST((quantity<kelvin>(t1) == t1));
+}
+
+BOOST_AUTO_TEST_CASE(test_batch)
+{
+    std::array<quantity<celsius>, 19> in;
+    std::array<quantity<fahrenheit>, 19> out;
+    for(std::size_t i = 0; i < in.size(); ++i)
+        in[i] = quantity<celsius>::from_value(10.0 * i - 40.0);
+    convert(std::span(in), std::span(out));
+    for(std::size_t i = 0; i < in.size(); ++i)
+        BOOST_TEST(out[i].value() == (10.0 * i - 40.0) * 1.8 + 32.0, boost::test_tools::tolerance(1e-12));
+}
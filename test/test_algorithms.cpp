@@ -0,0 +1,117 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/algorithms.hpp>
+#include <boost/units2/quantity_vector.hpp>
+#include <boost/units2/si.hpp>
+#include <cstddef>
+#include <execution>
+#include <ratio>
+#include <type_traits>
+#include <vector>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+
+constexpr auto kilometer = std::kilo() * si::meter;
+
+BOOST_AUTO_TEST_CASE(test_sum)
+{
+    std::vector<quantity<si::meter>> v;
+    for(int i = 1; i <= 100; ++i)
+        v.push_back(i * 1.0 * si::meter);
+    static_assert(std::is_same_v<decltype(sum(v)), quantity<si::meter>>);
+    BOOST_TEST(sum(v).value() == 5050.0);
+    BOOST_TEST(sum(std::execution::par, v).value() == 5050.0);
+    BOOST_TEST(sum(std::vector<quantity<si::meter>>()).value() == 0.0);
+
+    quantity_vector<kilometer, int> ints;
+    for(int i = 0; i < 10; ++i)
+        ints.push_back(quantity<kilometer, int>::from_value(i));
+    BOOST_TEST(sum(ints).value() == 45);
+}
+
+BOOST_AUTO_TEST_CASE(test_sum_compensated)
+{
+    // 1 followed by many values that are each lost when added to 1
+    // in plain summation.
+    const std::size_t n = 1000000;
+    std::vector<quantity<si::meter>> v(n + 1, 1e-16 * si::meter);
+    v[0] = 1.0 * si::meter;
+    double naive = 0;
+    for(const auto& x : v)
+        naive += x.value();
+    BOOST_TEST(naive == 1.0);
+    const double expected = 1.0 + n * 1e-16;
+    BOOST_TEST(sum(v).value() == expected, boost::test_tools::tolerance(1e-15));
+    BOOST_TEST(sum(std::execution::par, v).value() == expected, boost::test_tools::tolerance(1e-15));
+}
+
+BOOST_AUTO_TEST_CASE(test_deterministic)
+{
+    // The chunks are fixed, so every policy gives the same bits.
+    std::vector<quantity<si::meter>> v;
+    for(std::size_t i = 0; i < 300000; ++i)
+        v.push_back(1.0 / (i + 1) * si::meter);
+    const double expected = sum(v).value();
+    BOOST_TEST(sum(std::execution::par, v).value() == expected);
+    BOOST_TEST(sum(std::execution::par_unseq, v).value() == expected);
+    BOOST_TEST(sum(std::execution::unseq, v).value() == expected);
+}
+
+BOOST_AUTO_TEST_CASE(test_mean_variance)
+{
+    std::vector<quantity<si::second>> v;
+    for(double x : { 2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0 })
+        v.push_back(x * si::second);
+    BOOST_TEST(mean(v).value() == 5.0);
+    auto var = variance(std::execution::par, v);
+    static_assert(std::is_convertible_v<decltype(var), quantity<si::second * si::second>>);
+    BOOST_TEST(var.value() == 4.0);
+    BOOST_TEST(variance(v, 1).value() == 32.0 / 7);
+
+    // The mean of integers is not truncated.
+    std::vector<quantity<si::second, int>> ints = {
+        quantity<si::second, int>::from_value(1), quantity<si::second, int>::from_value(2) };
+    static_assert(std::is_same_v<decltype(mean(ints))::value_type, double>);
+    BOOST_TEST(mean(ints).value() == 1.5);
+}
+
+BOOST_AUTO_TEST_CASE(test_dot)
+{
+    std::vector<quantity<si::newton>> f;
+    std::vector<quantity<si::meter>> d;
+    for(int i = 0; i < 100000; ++i)
+    {
+        f.push_back(2.0 * si::newton);
+        d.push_back((i % 4) * 1.0 * si::meter);
+    }
+    auto work = dot(std::execution::par, f, d);
+    quantity<si::joule> joules = work;
+    BOOST_TEST(joules.value() == 300000.0);
+    BOOST_TEST(dot(f, d).value() == 300000.0);
+    quantity<std::kilo() * si::joule> kilojoules = inner_product(f, d, 1.0 * (std::kilo() * si::joule));
+    BOOST_TEST(kilojoules.value() == 301.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_trapezoid)
+{
+    // Power ramping linearly from 0 to 10 W over 10 s is 50 J.
+    std::vector<quantity<si::second>> t;
+    std::vector<quantity<si::watt>> p;
+    for(int i = 0; i <= 100; ++i)
+    {
+        t.push_back(i * 0.1 * si::second);
+        p.push_back(i * 0.1 * si::watt);
+    }
+    quantity<si::joule> energy = trapezoid_integrate(t, p);
+    BOOST_TEST(energy.value() == 50.0, boost::test_tools::tolerance(1e-12));
+    energy = trapezoid_integrate(std::execution::par, p, 0.1 * si::second);
+    BOOST_TEST(energy.value() == 50.0, boost::test_tools::tolerance(1e-12));
+    BOOST_TEST(trapezoid_integrate(std::vector<quantity<si::second>>(1), std::vector<quantity<si::watt>>(1)).value() == 0.0);
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/batch.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/def.hpp>
+#include <vector>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+BOOST_UNITS2_DEF(length);
+BOOST_UNITS2_DEF(meter, length);
+BOOST_UNITS2_DEF(xmeter, meter);
+
+inline constexpr auto millimeter = std::milli() * meter;
+
+using boost::units2::quantity;
+using boost::units2::convert;
+
+template<auto Unit, class T = double>
+std::vector<quantity<Unit, T>> make_data(std::size_t n)
+{
+    std::vector<quantity<Unit, T>> result;
+    for(std::size_t i = 0; i < n; ++i)
+        result.push_back(quantity<Unit, T>::from_value(static_cast<T>(i)));
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(test_convert)
+{
+    // 21 exercises both the blocks and the scalar tail.
+    auto in = make_data<millimeter>(21);
+    std::vector<quantity<meter>> out(in.size());
+    convert(std::span(in), std::span(out));
+    for(std::size_t i = 0; i < in.size(); ++i)
+        BOOST_TEST(out[i].value() == quantity<meter>(in[i]).value());
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_value_type)
+{
+    auto in = make_data<millimeter>(13);
+    std::vector<quantity<meter, float>> out(in.size());
+    convert(std::span(in), std::span(out));
+    for(std::size_t i = 0; i < in.size(); ++i)
+        BOOST_TEST(out[i].value() == static_cast<float>(in[i].value() * 0.001f));
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_identity)
+{
+    auto in = make_data<meter>(10);
+    std::vector<quantity<meter>> out(in.size());
+    convert(std::span(in), std::span(out));
+    for(std::size_t i = 0; i < in.size(); ++i)
+        BOOST_TEST(out[i].value() == in[i].value());
+
+    // A different unit with a factor of 1 is still copied exactly.
+    std::vector<quantity<xmeter>> xout(in.size());
+    convert(std::span(in), std::span(xout));
+    for(std::size_t i = 0; i < in.size(); ++i)
+        BOOST_TEST(xout[i].value() == in[i].value());
+
+    // Converting in place is a no-op.
+    convert(std::span(in), std::span(in));
+    for(std::size_t i = 0; i < in.size(); ++i)
+        BOOST_TEST(in[i].value() == static_cast<double>(i));
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_constexpr)
+{
+    constexpr double result = [] {
+        quantity<millimeter> in[3] = {
+            quantity<millimeter>::from_value(1000.0),
+            quantity<millimeter>::from_value(2000.0),
+            quantity<millimeter>::from_value(3000.0)
+        };
+        quantity<meter> out[3];
+        convert(std::span(in), std::span(out));
+        return out[0].value() + out[1].value() + out[2].value();
+    }();
+    BOOST_TEST(result == 6.0);
+}
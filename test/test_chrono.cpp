@@ -0,0 +1,63 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/chrono.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+using namespace std::chrono_literals;
+
+inline constexpr auto millisecond = std::milli() * si::second;
+inline constexpr auto nanosecond = std::nano() * si::second;
+inline constexpr auto minute = std::ratio<60>() * si::second;
+
+BOOST_AUTO_TEST_CASE(test_same_period)
+{
+    constexpr auto q = to_quantity(std::chrono::milliseconds(1500));
+    static_assert(std::is_same<std::remove_cv_t<decltype(q)>, quantity<millisecond, std::chrono::milliseconds::rep>>::value);
+    static_assert(q.value() == 1500);
+    static_assert(std::is_same<std::remove_cv_t<decltype(to_quantity(std::chrono::seconds(1)).unit())>,
+        std::remove_cv_t<decltype(si::second)>>::value);
+    static_assert(std::is_same<decltype(to_duration(q)), std::chrono::milliseconds>::value);
+    static_assert(to_duration(q) == 1500ms);
+    static_assert(std::is_same<decltype(to_duration(quantity<minute, int>::from_value(2))),
+        std::chrono::duration<int, std::ratio<60>>>::value);
+    static_assert(std::is_same<decltype(to_duration(quantity<si::second, double>::from_value(0.5))),
+        std::chrono::duration<double>>::value);
+    // Both sides hold just the count.
+    static_assert(sizeof(q) == sizeof(std::chrono::milliseconds));
+}
+
+BOOST_AUTO_TEST_CASE(test_conversion)
+{
+    static_assert(quantity_cast<si::second>(2min).value() == 120);
+    static_assert(quantity_cast<si::second>(1500ms).value() == 1);
+    static_assert(quantity_cast<si::second, rounding::to_nearest>(1500ms).value() == 2);
+    static_assert(quantity_cast<millisecond>(std::chrono::duration<double>(0.25)).value() == 250.0);
+    static_assert(duration_cast<std::chrono::seconds>(quantity<millisecond, std::int64_t>::from_value(-1500)) == -1s);
+    static_assert(duration_cast<std::chrono::seconds, rounding::down>(quantity<millisecond, std::int64_t>::from_value(-1500)) == -2s);
+    static_assert(duration_cast<std::chrono::duration<double>>(quantity<millisecond, int>::from_value(250)).count() == 0.25);
+    // The value_type of the quantity can differ from the rep.
+    static_assert(duration_cast<std::chrono::nanoseconds>(quantity<minute, int>::from_value(3)) == 180s);
+}
+
+BOOST_AUTO_TEST_CASE(test_exact)
+{
+    // std::chrono::duration_cast multiplies first and overflows here.
+    constexpr std::int64_t ns = 9000000000000000000;
+    constexpr auto q = quantity<nanosecond, std::int64_t>::from_value(ns);
+    constexpr auto d = duration_cast<std::chrono::duration<std::int64_t, std::ratio<1, 3>>>(q);
+    static_assert(d.count() == 27000000000);
+    BOOST_TEST((quantity_cast<nanosecond>(d).value() == ns));
+    BOOST_TEST((to_quantity(std::chrono::nanoseconds(ns)) == q));
+}
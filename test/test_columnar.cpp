@@ -0,0 +1,218 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/columnar.hpp>
+#include <boost/units2/quantity_vector.hpp>
+#include <boost/units2/def.hpp>
+#include <boost/units2/absolute.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <ratio>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+BOOST_UNITS2_DEF(length);
+BOOST_UNITS2_DEF(meter, length);
+BOOST_UNITS2_DEF(duration);
+BOOST_UNITS2_DEF(second, duration);
+BOOST_UNITS2_DEF(inch, std::ratio<254, 10000>() * meter);
+
+constexpr auto millimeter = std::milli() * meter;
+constexpr auto centimeter = std::centi() * meter;
+constexpr auto kilometer = std::kilo() * meter;
+constexpr auto velocity = meter / second;
+BOOST_UNITS2_DEF(temperature);
+BOOST_UNITS2_DEF(kelvin, temperature);
+constexpr auto absolute_kelvin = boost::units2::absolute_unit(kelvin);
+constexpr auto celsius = boost::units2::absolute_unit(absolute_kelvin, std::ratio<27315, 100>());
+
+using boost::units2::quantity;
+using boost::units2::quantity_vector;
+using boost::units2::columnar_writer;
+using boost::units2::columnar_file;
+using boost::units2::columnar_error;
+using boost::units2::column_value_type;
+using boost::units2::detail::unit_name;
+
+namespace {
+
+struct temp_file {
+    temp_file() : path((std::filesystem::temp_directory_path() / ("units2_columnar_" + std::to_string(counter++))).string()) {}
+    ~temp_file() { std::remove(path.c_str()); }
+    static inline int counter = 0;
+    std::string path;
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(test_unit_name)
+{
+    BOOST_TEST(unit_name<meter_t>() == "meter");
+    BOOST_TEST(unit_name<decltype(millimeter)>() == "[1/1000]*meter");
+    BOOST_TEST(unit_name<decltype(velocity)>() == unit_name<decltype(meter/second)>());
+    BOOST_TEST(unit_name<decltype(velocity)>() != unit_name<decltype(second/meter)>());
+    BOOST_TEST(unit_name<decltype(meter/meter)>() == "1");
+    // Named units are not expanded
+    BOOST_TEST(unit_name<inch_t>() == "inch");
+    BOOST_TEST(unit_name<decltype(boost::units2::pow<2>(inch))>() == "inch^2");
+    BOOST_TEST(unit_name<decltype(boost::units2::pow(meter, std::ratio<1, 2>()))>() == "meter^(1/2)");
+}
+
+BOOST_AUTO_TEST_CASE(test_round_trip)
+{
+    temp_file file;
+    quantity_vector<millimeter> x = { quantity<millimeter>::from_value(1), quantity<millimeter>::from_value(2500) };
+    std::vector<quantity<velocity, float>> v(100);
+    for(std::size_t i = 0; i < v.size(); ++i)
+        v[i] = quantity<velocity, float>::from_value(static_cast<float>(i));
+    {
+        columnar_writer writer;
+        writer.add("x", x);
+        writer.add("v", std::span(v));
+        BOOST_CHECK_THROW(writer.add("x", x), columnar_error);
+        writer.write(file.path);
+    }
+
+    columnar_file f(file.path);
+    BOOST_TEST(f.columns().size() == 2u);
+    BOOST_TEST(f.contains("x"));
+    BOOST_TEST(!f.contains("y"));
+    BOOST_TEST(f.info("x").unit == unit_name<decltype(millimeter)>());
+    BOOST_TEST((f.info("v").type == column_value_type::float32));
+    BOOST_TEST(f.info("v").size == 100u);
+
+    auto xs = f.column<millimeter>("x");
+    BOOST_TEST(xs.size() == 2u);
+    BOOST_TEST(xs[1].value() == 2500);
+    BOOST_TEST(reinterpret_cast<std::uintptr_t>(xs.data()) % boost::units2::column_alignment == 0);
+    auto vs = f.column<velocity, float>("v");
+    BOOST_TEST(vs[42].value() == 42.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_mismatch)
+{
+    temp_file file;
+    quantity_vector<millimeter> x(3);
+    columnar_writer writer;
+    writer.add("x", x);
+    writer.write(file.path);
+
+    columnar_file f(file.path);
+    BOOST_CHECK_THROW(f.column<meter>("x"), columnar_error);
+    BOOST_CHECK_THROW((f.column<millimeter, float>("x")), columnar_error);
+    BOOST_CHECK_THROW(f.column<millimeter>("y"), columnar_error);
+    BOOST_CHECK_THROW(f.column_as<meter>("x", kilometer), columnar_error);
+    BOOST_CHECK_THROW(columnar_file(file.path + ".missing"), columnar_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_converted)
+{
+    temp_file file;
+    quantity_vector<millimeter> x;
+    for(int i = 0; i < 1000; ++i)
+        x.push_back(quantity<millimeter>::from_value(i));
+    columnar_writer writer;
+    writer.add("x", x);
+    writer.write(file.path);
+
+    columnar_file f(file.path);
+    auto col = f.column_as<meter>("x", kilometer, millimeter);
+    BOOST_TEST(col.size() == 1000u);
+    BOOST_TEST(!col.is_identity());
+    BOOST_TEST(col.factor() == 0.001);
+    BOOST_TEST(col[500].value() == 0.5);
+    BOOST_TEST(col.stored_values()[500] == 500);
+
+    std::vector<quantity<meter>> buffer(64);
+    std::size_t seen = 0;
+    double total = 0;
+    col.for_each_chunk(std::span(buffer), [&](std::span<const quantity<meter>> chunk) {
+        BOOST_TEST(chunk.size() <= 64u);
+        for(auto q : chunk) total += q.value();
+        seen += chunk.size();
+    });
+    BOOST_TEST(seen == 1000u);
+    BOOST_TEST(total == 499.5, boost::test_tools::tolerance(1e-12));
+
+    // The stored unit needs no conversion, so the chunk is the mapped data.
+    auto same = f.column_as<millimeter>("x", meter);
+    BOOST_TEST(same.is_identity());
+    same.for_each_chunk(std::span<quantity<millimeter>>(), [&](std::span<const quantity<millimeter>> chunk) {
+        BOOST_TEST(chunk.size() == 1000u);
+        BOOST_TEST(static_cast<const void*>(chunk.data()) == static_cast<const void*>(same.stored_values().data()));
+    });
+}
+
+BOOST_AUTO_TEST_CASE(test_converted_integer)
+{
+    temp_file file;
+    std::vector<quantity<kilometer, std::int64_t>> x = {
+        quantity<kilometer, std::int64_t>::from_value(9007199254740993),
+        quantity<kilometer, std::int64_t>::from_value(-3) };
+    std::vector<quantity<inch, std::int32_t>> y = { quantity<inch, std::int32_t>::from_value(7) };
+    columnar_writer writer;
+    writer.add("x", std::span(x));
+    writer.add("y", std::span(y));
+    writer.write(file.path);
+
+    // Integers are converted by the exact factor, not through double.
+    columnar_file f(file.path);
+    auto xs = f.column_as<meter, std::int64_t>("x", kilometer);
+    BOOST_TEST(!xs.is_identity());
+    BOOST_TEST(xs.numerator() == 1000);
+    BOOST_TEST(xs[0].value() == 9007199254740993000);
+    quantity<meter, std::int64_t> out[2];
+    xs.read(0, out);
+    BOOST_TEST(out[1].value() == -3000);
+    // 7 inches is 17.78 cm, truncated.
+    auto ys = f.column_as<centimeter, std::int32_t>("y", inch);
+    BOOST_TEST(ys[0].value() == 17);
+    BOOST_TEST((f.column_as<inch, std::int32_t>("y", meter).is_identity()));
+}
+
+BOOST_AUTO_TEST_CASE(test_absolute)
+{
+    BOOST_TEST(unit_name<decltype(celsius)>() == "abs(kelvin;5463/20)");
+    BOOST_TEST(unit_name<decltype(absolute_kelvin)>() != unit_name<kelvin_t>());
+
+    temp_file file;
+    quantity_vector<celsius> t = { quantity<celsius>::from_value(0), quantity<celsius>::from_value(100) };
+    columnar_writer writer;
+    writer.add("t", t);
+    writer.write(file.path);
+
+    columnar_file f(file.path);
+    BOOST_TEST(f.column<celsius>("t")[1].value() == 100.0);
+    // The offset is applied, not only the scale.
+    auto col = f.column_as<absolute_kelvin>("t", celsius);
+    BOOST_TEST(!col.is_identity());
+    BOOST_TEST(col.factor() == 1.0);
+    BOOST_TEST(col[0].value() == 273.15, boost::test_tools::tolerance(1e-12));
+    BOOST_TEST(col[1].value() == 373.15, boost::test_tools::tolerance(1e-12));
+    BOOST_CHECK_THROW(f.column_as<absolute_kelvin>("t", absolute_kelvin), columnar_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_malformed)
+{
+    temp_file file;
+    {
+        std::ofstream os(file.path, std::ios::binary);
+        os << "not a columnar file, but long enough to have a header";
+    }
+    BOOST_CHECK_THROW(columnar_file f(file.path), columnar_error);
+
+    quantity_vector<meter> x(16);
+    columnar_writer writer;
+    writer.add("x", x);
+    writer.write(file.path);
+    std::filesystem::resize_file(file.path, std::filesystem::file_size(file.path) - 8);
+    BOOST_CHECK_THROW(columnar_file f(file.path), columnar_error);
+}
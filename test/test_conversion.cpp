@@ -0,0 +1,78 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/conversion.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <cstdint>
+#include <ratio>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+
+struct pi_scale : scale_base {
+    static constexpr double value() { return 3.14159265358979323846; }
+};
+
+constexpr auto radian_per_second = si::radian / si::second;
+constexpr auto revolution = pi_scale() * (std::ratio<2>() * si::radian);
+constexpr auto speed_of_light = std::ratio<299792458>() * si::meter / si::second;
+
+BOOST_AUTO_TEST_CASE(test_dimensionless_angle)
+{
+    constexpr auto no_angle = equivalent(si::radian, dimensionless());
+    static_assert(conversion_factor(radian_per_second, si::hertz, no_angle) == 1.0);
+    static_assert(conversion_factor(si::hertz, radian_per_second, no_angle) == 1.0);
+    static_assert(conversion_factor(si::radian, dimensionless(), no_angle) == 1.0);
+    static_assert(conversion_factor(std::kilo() * si::radian, si::radian, no_angle) == 1000.0);
+    // Units with the same dimension do not need the equivalence.
+    static_assert(conversion_factor(si::meter, std::milli() * si::meter, no_angle) == 1000.0);
+    BOOST_TEST(conversion_factor(revolution / si::second, si::hertz, no_angle) == 2 * 3.14159265358979323846,
+        boost::test_tools::tolerance(1e-15));
+    // Redundant equivalences
+    static_assert(conversion_factor(pow<2>(si::radian) / si::second, si::hertz,
+        no_angle, equivalent(si::radian * si::radian, dimensionless())) == 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_physical_constants)
+{
+    constexpr auto c = equivalent(speed_of_light, dimensionless());
+    // E = mc^2 requires squaring the equivalence.
+    static_assert(conversion_factor(si::kilogram, si::joule, equivalent(si::second, speed_of_light * si::second))
+        == 89875517873681764.0);
+    static_assert(conversion_factor(si::meter / si::second, dimensionless(), c) == 1 / 299792458.0);
+    static_assert(conversion_factor(si::second, si::meter, equivalent(dimensionless(), speed_of_light)) == 299792458.0);
+    // Two equivalences used together
+    constexpr auto m_per_kg = equivalent(si::kilogram, std::ratio<3>() * si::meter);
+    static_assert(conversion_factor(si::kilogram * si::second, si::meter * si::meter, m_per_kg,
+        equivalent(si::second, speed_of_light * si::second)) == 3 * 299792458.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_quantity_cast)
+{
+    constexpr auto no_angle = equivalent(si::radian, dimensionless());
+    constexpr auto w = quantity<radian_per_second>::from_value(4.0);
+    constexpr auto f = quantity_cast<si::hertz>(w, no_angle);
+    static_assert(f.value() == 4.0);
+    constexpr auto kf = quantity_cast<std::kilo() * si::hertz>(w, no_angle);
+    static_assert(kf.value() == 0.004);
+}
+
+BOOST_AUTO_TEST_CASE(test_quantity_cast_integer)
+{
+    // The factor is rational, so integers are converted exactly.
+    constexpr auto c = equivalent(dimensionless(), speed_of_light);
+    constexpr auto t = quantity<si::second, std::int64_t>::from_value(30000000123);
+    static_assert(quantity_cast<si::meter>(t, c).value() == 8993773776874472334);
+    constexpr auto d = quantity<si::meter, int>::from_value(449896229);
+    static_assert(quantity_cast<si::second>(d, c).value() == 1);
+    static_assert(quantity_cast<si::second, rounding::to_nearest>(d, c).value() == 2);
+    static_assert(quantity_cast<si::second, rounding::up>(quantity<si::meter, int>::from_value(1), c).value() == 1);
+    // An explicit scale type selects the floating point factor.
+    static_assert(quantity_cast<si::second, double>(quantity<si::meter, int>::from_value(299792458), c).value() == 1);
+}
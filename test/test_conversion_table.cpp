@@ -0,0 +1,160 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/conversion_table.hpp>
+#include <boost/units2/def.hpp>
+#include <boost/units2/fingerprint.hpp>
+#include <boost/units2/si.hpp>
+#include <boost/units2/temperature.hpp>
+#include <optional>
+#include <ratio>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+
+constexpr auto kilometer = std::kilo() * si::meter;
+constexpr auto millimeter = std::milli() * si::meter;
+constexpr auto hour = std::ratio<3600>() * si::second;
+constexpr auto kilometer_per_hour = kilometer / hour;
+constexpr auto meter_per_second = si::meter / si::second;
+
+namespace other {
+BOOST_UNITS2_DEF(length);
+BOOST_UNITS2_DEF(meter, length);
+}
+
+BOOST_AUTO_TEST_CASE(test_fingerprint)
+{
+    // The same unit spelled differently
+    static_assert(fingerprint(si::meter * si::second / si::second) == fingerprint(si::meter));
+    static_assert(fingerprint(si::second * si::meter) == fingerprint(si::meter * si::second));
+    static_assert(fingerprint(si::hertz) == fingerprint(si::becquerel));
+    static_assert(fingerprint_v<const decltype(si::meter)> == fingerprint(si::meter));
+    // Different units
+    static_assert(fingerprint(si::meter) != fingerprint(si::second));
+    static_assert(fingerprint(kilometer) != fingerprint(millimeter));
+    static_assert(fingerprint(kilometer) != fingerprint(si::meter));
+    static_assert(fingerprint(si::joule) != fingerprint(si::newton));
+    // Names are not qualified, so these cannot be told apart, and
+    // conversion_table<si::meter, other::meter> does not compile.
+    static_assert(!std::is_same<std::remove_cv_t<decltype(other::meter)>, std::remove_cv_t<decltype(si::meter)>>::value);
+    static_assert(fingerprint(other::meter) == fingerprint(si::meter));
+}
+
+BOOST_AUTO_TEST_CASE(test_table)
+{
+    using table = conversion_table<si::meter, kilometer, millimeter, si::second, hour, meter_per_second, kilometer_per_hour>;
+    static_assert(table::find(fingerprint(kilometer), fingerprint(millimeter)) == 1e6);
+    static_assert(table::find(fingerprint(hour), fingerprint(si::second)) == 3600.0);
+    static_assert(!table::find(fingerprint(si::meter), fingerprint(si::second)));
+    static_assert(!table::find(fingerprint(si::meter), fingerprint(si::newton)));
+    static_assert(table::contains(fingerprint(si::meter)));
+    static_assert(!table::contains(fingerprint(si::gram)));
+    static_assert(table::index_of(fingerprint(hour)) == 4);
+    BOOST_TEST(table::factor(fingerprint(kilometer_per_hour), fingerprint(meter_per_second)) == 1 / 3.6,
+        boost::test_tools::tolerance(1e-15));
+    BOOST_CHECK_THROW(table::factor(fingerprint(si::meter), fingerprint(si::second)), std::out_of_range);
+    // The exact factors
+    static_assert(table::find_ratio(fingerprint(kilometer_per_hour), fingerprint(meter_per_second)) == detail::rational(5, 18));
+    static_assert(!table::find_ratio(fingerprint(si::meter), fingerprint(si::second)));
+
+    static_assert(si_conversion_table::find(fingerprint(si::kilogram), fingerprint(si::gram)) == 1000.0);
+    static_assert(si_conversion_table::find(fingerprint(si::gray), fingerprint(si::sievert)) == 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_registry)
+{
+    unit_registry registry;
+    BOOST_TEST(!registry.find(fingerprint(si::meter), fingerprint(si::meter)));
+    registry.add(si_conversion_table());
+    registry.add(conversion_table<kilometer, millimeter, hour, kilometer_per_hour>());
+    // Within one table
+    BOOST_TEST(registry.factor(fingerprint(si::kilogram), fingerprint(si::gram)) == 1000.0);
+    BOOST_TEST(registry.factor(fingerprint(kilometer), fingerprint(millimeter)) == 1e6);
+    // Across tables
+    BOOST_TEST(registry.factor(fingerprint(kilometer), fingerprint(si::meter)) == 1000.0);
+    BOOST_TEST(registry.factor(fingerprint(si::second), fingerprint(hour)) == 1 / 3600.0, boost::test_tools::tolerance(1e-15));
+    BOOST_CHECK_THROW(registry.factor(fingerprint(kilometer), fingerprint(hour)), std::out_of_range);
+    BOOST_TEST((registry.find_ratio(fingerprint(si::second), fingerprint(hour)) == detail::rational(1, 3600)));
+    BOOST_TEST((registry.find_ratio(fingerprint(kilometer), fingerprint(si::meter)) == detail::rational(1000)));
+    BOOST_TEST(!registry.contains(fingerprint(kilometer * kilometer)));
+
+    // Readers do not block while another table is added.
+    std::vector<std::thread> readers;
+    std::atomic<int> failures(0);
+    for(int i = 0; i < 4; ++i)
+    {
+        readers.emplace_back([&] {
+            for(int j = 0; j < 100000; ++j)
+                if(registry.find(fingerprint(millimeter), fingerprint(kilometer)) != 1e-6) ++failures;
+        });
+    }
+    registry.add(conversion_table<kilometer * kilometer, si::meter * si::meter>());
+    for(std::thread& t : readers) t.join();
+    BOOST_TEST(failures == 0);
+    BOOST_TEST(registry.factor(fingerprint(kilometer * kilometer), fingerprint(si::meter * si::meter)) == 1e6);
+}
+
+BOOST_AUTO_TEST_CASE(test_registry_add_twice)
+{
+    unit_registry registry;
+    BOOST_TEST(registry.size() == 0u);
+    registry.add(si_conversion_table());
+    const std::size_t size = registry.size();
+    // hertz and becquerel, and gray and sievert, are the same units.
+    BOOST_TEST(size == si_conversion_table::size - 2);
+    // Adding the same units again does not grow the registry.
+    registry.add(si_conversion_table());
+    registry.add(conversion_table<si::meter, si::second>());
+    BOOST_TEST(registry.size() == size);
+    BOOST_TEST(registry.factor(fingerprint(si::kilogram), fingerprint(si::gram)) == 1000.0);
+    // Only the new units are added.
+    registry.add(conversion_table<si::meter, kilometer, kilometer>());
+    BOOST_TEST(registry.size() == size + 1);
+    BOOST_TEST(registry.factor(fingerprint(kilometer), fingerprint(si::meter)) == 1000.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_absolute)
+{
+    using temperatures::celsius;
+    using temperatures::fahrenheit;
+    using temperatures::kelvin;
+    static_assert(fingerprint(celsius) != fingerprint(kelvin));
+    static_assert(fingerprint(kelvin) != fingerprint(si::kelvin));
+
+    // Absolute and relative kelvin are not convertible.
+    using table = conversion_table<kelvin, celsius, fahrenheit, si::kelvin>;
+    static_assert(table::dimensions[0] == table::dimensions[2]);
+    static_assert(table::dimensions[0] != table::dimensions[3]);
+    static_assert(!table::find_affine(fingerprint(si::kelvin), fingerprint(celsius)));
+    // The offset is applied, not only the scale.
+    constexpr std::optional<affine_factors<double>> c_to_f = table::find_affine(fingerprint(celsius), fingerprint(fahrenheit));
+    static_assert(c_to_f);
+    BOOST_TEST(c_to_f->scale == 1.8, boost::test_tools::tolerance(1e-15));
+    BOOST_TEST(c_to_f->offset == 32.0, boost::test_tools::tolerance(1e-15));
+    // find only gives pure scale factors.
+    static_assert(!table::find(fingerprint(celsius), fingerprint(fahrenheit)));
+    static_assert(!table::find_ratio(fingerprint(celsius), fingerprint(fahrenheit)));
+    static_assert(table::find(fingerprint(si::kelvin), fingerprint(si::kelvin)) == 1.0);
+
+    // Across tables, through absolute kelvin.
+    unit_registry registry;
+    registry.add(conversion_table<kelvin>());
+    registry.add(conversion_table<celsius, fahrenheit>());
+    std::optional<affine_factors<double>> k_to_c = registry.find_affine(fingerprint(kelvin), fingerprint(celsius));
+    BOOST_TEST_REQUIRE(k_to_c.has_value());
+    BOOST_TEST(k_to_c->scale == 1.0);
+    BOOST_TEST(k_to_c->offset == -273.15, boost::test_tools::tolerance(1e-12));
+    std::optional<affine_factors<double>> k_to_f = registry.find_affine(fingerprint(kelvin), fingerprint(fahrenheit));
+    BOOST_TEST_REQUIRE(k_to_f.has_value());
+    BOOST_TEST(300.0 * k_to_f->scale + k_to_f->offset == 80.33, boost::test_tools::tolerance(1e-12));
+    BOOST_TEST(!registry.find(fingerprint(kelvin), fingerprint(celsius)));
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/dense_unit.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <ratio>
+#include <type_traits>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+
+constexpr auto meter = to_dense(si::meter);
+constexpr auto second = to_dense(si::second);
+constexpr auto kilometer = to_dense(std::kilo() * si::meter);
+constexpr auto millimeter = std::milli() * meter;
+
+template<class T, class U>
+constexpr bool same(T, U) { return std::is_same<T, U>::value; }
+
+BOOST_AUTO_TEST_CASE(test_representation)
+{
+    constexpr auto newton = to_dense(si::newton);
+    static_assert(newton.dimension.exponents[static_cast<std::size_t>(base_dimension::mass)] == 1);
+    static_assert(newton.dimension.exponents[static_cast<std::size_t>(base_dimension::length)] == 1);
+    static_assert(newton.dimension.exponents[static_cast<std::size_t>(base_dimension::time)] == -2);
+    // newton is defined with kilograms, but the base unit is the gram.
+    static_assert(newton.scale == dense_scale::from_ratio(1000, 1));
+    static_assert(newton.scale.size == 2);
+    static_assert(newton.scale.factors[0].prime == 2 && newton.scale.factors[0].exponent == 3);
+    static_assert(newton.scale.factors[1].prime == 5 && newton.scale.factors[1].exponent == 3);
+    static_assert(to_dense(si::meter / si::meter).dimension.is_dimensionless());
+    static_assert(to_dense(si::meter / si::meter).scale.is_one());
+
+    // Factors that are too large for trial division
+    constexpr dense_scale big = dense_scale::from_ratio(std::intmax_t(1000000007) * 998244353, 1000000007);
+    static_assert(big.size == 1 && big.factors[0].prime == 998244353);
+    static_assert(dense_scale::from_ratio(std::intmax_t(2147483647) * 2147483629, 1).size == 2);
+}
+
+// Every unit has exactly one dense type, no matter how it is spelled.
+BOOST_AUTO_TEST_CASE(test_one_type)
+{
+    static_assert(same(kilometer * millimeter, meter * meter));
+    static_assert(same(kilometer, std::ratio<1000>() * meter));
+    static_assert(same(kilometer / second, to_dense(std::kilo() * si::meter / si::second)));
+    static_assert(same(to_dense(si::joule), to_dense(si::newton) * meter));
+    static_assert(same(to_dense(si::joule), to_dense(si::newton) * si::meter));
+    static_assert(same(si::meter * to_dense(si::newton), to_dense(si::joule)));
+    static_assert(same(pow<2>(kilometer), std::mega() * pow<2>(meter)));
+    static_assert(same(pow(std::ratio<100>() * meter, std::ratio<1, 2>()), std::ratio<10>() * pow(meter, std::ratio<1, 2>())));
+    static_assert(same(pow<-1>(kilometer) * kilometer, to_dense(dimensionless())));
+    static_assert(same(std::ratio<6>() * meter, std::ratio<2>() * (std::ratio<3>() * meter)));
+    static_assert(same(to_dense(kilometer), kilometer));
+    static_assert(!same(kilometer, meter));
+}
+
+BOOST_AUTO_TEST_CASE(test_conversion)
+{
+    static_assert(conversion_factor(kilometer, meter) == 1000);
+    static_assert(conversion_factor(kilometer, si::meter) == 1000);
+    static_assert(conversion_factor(si::kilogram, to_dense(si::gram)) == 1000);
+    static_assert(conversion_factor(to_dense(si::newton), si::newton) == 1);
+    static_assert(has_same_dimension(to_dense(si::joule), si::newton * si::meter));
+    static_assert(conversion_factor(pow(std::ratio<100>() * meter, std::ratio<1, 2>()), pow(meter, std::ratio<1, 2>())) == 10);
+
+    quantity<kilometer> d = 3.0 * kilometer;
+    quantity<pow<-1>(second)> f = 0.5 * pow<-1>(second);
+    auto v = d * f;
+    static_assert(same(v.unit(), kilometer / second));
+    BOOST_TEST(v.value() == 1.5);
+    quantity<meter / second> v2(v);
+    BOOST_TEST(v2.value() == 1500);
+    quantity<si::meter / si::second> v3(v);
+    BOOST_TEST(v3.value() == 1500);
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/dynamic_quantity.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <ratio>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+
+constexpr auto millimeter = std::milli() * si::meter;
+constexpr auto meter_per_second = si::meter / si::second;
+
+BOOST_AUTO_TEST_CASE(test_packed_dimension)
+{
+    constexpr packed_dimension force = packed_dimension_of<decltype(si::newton)>;
+    static_assert(force.exponent(base_dimension::mass) == 1);
+    static_assert(force.exponent(base_dimension::length) == 1);
+    static_assert(force.exponent(base_dimension::time) == -2);
+    static_assert(force.exponent(base_dimension::current) == 0);
+    constexpr packed_dimension area = packed_dimension_of<decltype(si::meter * si::meter)>;
+    static_assert(force / area == packed_dimension_of<decltype(si::pascal)>);
+    static_assert(force * packed_dimension_of<decltype(si::meter)> == packed_dimension_of<decltype(si::joule)>);
+    static_assert(pow(area, -1) * area == packed_dimension());
+    static_assert(packed_dimension_of<decltype(si::meter / si::meter)>.is_dimensionless());
+    static_assert(packed_dimension::from_bits(force.bits()) == force);
+
+    // Every lane, checked against the scalar definition.
+    for(int a = packed_dimension::min_exponent; a <= packed_dimension::max_exponent; a += 3)
+    {
+        for(int b = packed_dimension::min_exponent; b <= packed_dimension::max_exponent; b += 5)
+        {
+            detail::dimension_exponents ea, eb;
+            for(std::size_t i = 0; i < base_dimension_count; ++i)
+            {
+                ea[i] = (a + static_cast<int>(i)) % 64;
+                eb[i] = b;
+            }
+            packed_dimension pa = packed_dimension::from_exponents(ea);
+            packed_dimension pb = packed_dimension::from_exponents(eb);
+            packed_dimension product, quotient;
+            bool product_ok = packed_dimension::multiply(pa, pb, product);
+            bool quotient_ok = packed_dimension::divide(pa, pb, quotient);
+            bool expected_product_ok = true, expected_quotient_ok = true;
+            for(std::size_t i = 0; i < base_dimension_count; ++i)
+            {
+                auto d = static_cast<base_dimension>(i);
+                auto sum = ea[i].num + eb[i].num;
+                auto diff = ea[i].num - eb[i].num;
+                if(sum < packed_dimension::min_exponent || sum > packed_dimension::max_exponent) expected_product_ok = false;
+                else if(product.exponent(d) != sum) BOOST_ERROR("wrong product");
+                if(diff < packed_dimension::min_exponent || diff > packed_dimension::max_exponent) expected_quotient_ok = false;
+                else if(quotient.exponent(d) != diff) BOOST_ERROR("wrong quotient");
+            }
+            BOOST_TEST(product_ok == expected_product_ok);
+            BOOST_TEST(quotient_ok == expected_quotient_ok);
+        }
+    }
+
+    detail::dimension_exponents half;
+    half[0] = detail::rational(1, 2);
+    BOOST_CHECK_THROW(packed_dimension::from_exponents(half), runtime_unit_error);
+    BOOST_CHECK_THROW(pow(force, 64), runtime_unit_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_static_bridge)
+{
+    constexpr auto d = quantity<millimeter>::from_value(1500);
+    constexpr dynamic_quantity<> dq = d;
+    static_assert(dq.value() == 1.5);
+    static_assert(dq.dimension() == packed_dimension_of<decltype(si::meter)>);
+    constexpr auto back = quantity_cast<millimeter>(dq);
+    static_assert(back.value() == 1500);
+    BOOST_TEST(quantity_cast<si::meter>(dq).value() == 1.5);
+    BOOST_CHECK_THROW(quantity_cast<si::second>(dq), runtime_unit_error);
+
+    // kilogram is not the base unit of mass
+    dynamic_quantity<> m = quantity<std::kilo() * si::gram>::from_value(2.0);
+    BOOST_TEST(m.value() == 2000.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_arithmetic)
+{
+    dynamic_quantity<> distance = quantity<si::meter>::from_value(10.0);
+    dynamic_quantity<> time = quantity<si::second>::from_value(4.0);
+    dynamic_quantity<> v = distance / time;
+    BOOST_TEST(quantity_cast<meter_per_second>(v).value() == 2.5);
+    BOOST_TEST((v.dimension() == packed_dimension_of<decltype(meter_per_second)>));
+    BOOST_CHECK_THROW(distance + time, runtime_unit_error);
+    BOOST_CHECK_THROW((void)(distance < time), runtime_unit_error);
+    dynamic_quantity<> twice = distance + distance * 1.0;
+    BOOST_TEST(twice.value() == 20.0);
+    BOOST_TEST((distance < twice));
+    BOOST_TEST((-distance).value() == -10.0);
+    BOOST_TEST((distance * time / time == distance));
+}
+
+BOOST_AUTO_TEST_CASE(test_runtime_unit_bridge)
+{
+    dynamic_quantity<> v(36.0, parse_unit("km/h"));
+    BOOST_TEST(v.value() == 10.0, boost::test_tools::tolerance(1e-15));
+    BOOST_TEST(v.value_in(parse_unit("m/s")) == 10.0, boost::test_tools::tolerance(1e-15));
+    BOOST_TEST(quantity_cast<meter_per_second>(v).value() == 10.0, boost::test_tools::tolerance(1e-15));
+    BOOST_CHECK_THROW(v.value_in(parse_unit("m")), runtime_unit_error);
+}
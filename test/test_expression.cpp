@@ -0,0 +1,94 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/expression.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <ratio>
+#include <type_traits>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+
+inline constexpr auto kilometer = std::kilo() * si::meter;
+inline constexpr auto millimeter = std::milli() * si::meter;
+inline constexpr auto hour = std::ratio<3600>() * si::second;
+inline constexpr auto square_meter = si::meter * si::meter;
+
+// The number of multiplications by a conversion factor
+// needed to evaluate an expression in Unit.
+template<auto Unit, class E>
+constexpr int conversions(const quantity_expression<E>&) { return E::template cost<std::remove_cv_t<decltype(Unit)>>; }
+
+BOOST_AUTO_TEST_CASE(test_fused_factors)
+{
+    constexpr auto a = 2.0 * kilometer;
+    constexpr auto b = 3.0 * millimeter;
+    constexpr auto c = 5.0 * square_meter;
+
+    // km * mm is exactly m^2, so there is nothing to convert.
+    constexpr auto area = lazy(a) * b + c;
+    static_assert(conversions<square_meter>(area) == 0);
+    constexpr quantity<square_meter> x(area);
+    static_assert(x.value() == 11.0);
+
+    // The sum is converted once, instead of once per operand.
+    constexpr auto length = lazy(a) + 3.0 * kilometer;
+    static_assert(conversions<si::meter>(length) == 1);
+    static_assert(evaluate<si::meter>(length).value() == 5000.0);
+    // In its own unit it needs no conversion at all.
+    static_assert(conversions<kilometer>(length) == 0);
+    static_assert(std::is_same<decltype(evaluate(length)), quantity<kilometer>>::value);
+
+    // km -> m and h -> s are folded into a single factor.
+    constexpr auto speed = (lazy(a) + 3.0 * kilometer) / (0.5 * hour);
+    static_assert(conversions<si::meter / si::second>(speed) == 1);
+    BOOST_TEST(evaluate<si::meter / si::second>(speed).value() == 5000.0 / 1800.0);
+    BOOST_TEST(evaluate<kilometer / hour>(speed).value() == 10.0);
+
+    // One factor for the meters in the sum, and one for everything else.
+    constexpr auto mixed = (lazy(a) + 500.0 * si::meter) / (0.5 * hour);
+    static_assert(conversions<si::meter / si::second>(mixed) == 2);
+    BOOST_TEST(evaluate<si::meter / si::second>(mixed).value() == 2500.0 / 1800.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_operands)
+{
+    constexpr auto a = 2.0 * kilometer;
+    constexpr auto t = 4.0 * si::second;
+    // Quantities and numbers mix with expressions on either side.
+    static_assert(evaluate<si::meter>(2.0 * lazy(a)).value() == 4000.0);
+    static_assert(evaluate<si::meter>(lazy(a) * 2.0).value() == 4000.0);
+    static_assert(evaluate<si::meter / si::second>(lazy(a) / t).value() == 500.0);
+    static_assert(evaluate<si::second / si::meter>(t / lazy(a)).value() == 0.002);
+    static_assert(evaluate<si::meter>(a - lazy(500.0 * si::meter)).value() == 1500.0);
+    static_assert(evaluate<si::meter>(-lazy(a)).value() == -2000.0);
+    static_assert(evaluate(lazy(a) / lazy(a)).value() == 1.0);
+    // Sums are in the common_unit of the operands.
+    static_assert(std::is_same<decltype(evaluate(lazy(a) + 500.0 * si::meter)), quantity<si::meter>>::value);
+
+    // Conversion to the natural unit is implicit, and to others explicit.
+    constexpr quantity<kilometer * si::second> implicit = lazy(a) * t;
+    static_assert(implicit.value() == 8.0);
+    static_assert(std::is_convertible<decltype(lazy(a) * t), quantity<kilometer * si::second>>::value);
+    static_assert(!std::is_convertible<decltype(lazy(a) * t), quantity<si::meter * si::second>>::value);
+    static_assert(std::is_constructible<quantity<si::meter * si::second>, decltype(lazy(a) * t)>::value);
+}
+
+BOOST_AUTO_TEST_CASE(test_value_types)
+{
+    constexpr auto a = quantity<kilometer, int>::from_value(3);
+    constexpr auto b = quantity<si::meter, int>::from_value(250);
+    constexpr quantity<si::meter, int> sum(lazy(a) + b);
+    static_assert(sum.value() == 3250);
+    static_assert(std::is_same<decltype(evaluate(lazy(a) * b))::value_type, int>::value);
+
+    const auto f = quantity<kilometer, float>::from_value(1.5f);
+    quantity<si::meter, float> m(lazy(f) + f);
+    BOOST_TEST(m.value() == 3000.0f);
+}
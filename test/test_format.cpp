@@ -0,0 +1,97 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/format.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <boost/units2/temperature.hpp>
+#include <charconv>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+
+inline constexpr auto kilometer = std::kilo() * si::meter;
+inline constexpr auto hour = std::ratio<3600>() * si::second;
+inline constexpr auto minute = std::ratio<60>() * si::second;
+
+struct degree_scale : scale_base {
+    static constexpr double value() { return 3.14159265358979323846 / 180; }
+};
+
+// A symbol for a derived unit.
+template<>
+struct boost::units2::unit_symbol<std::remove_cv_t<decltype(minute)>> {
+    static constexpr const char* value = "min";
+};
+
+BOOST_AUTO_TEST_CASE(test_symbol)
+{
+    static_assert(symbol_v<decltype(si::meter)> == "m");
+    static_assert(symbol(si::kilogram) == "kg");
+    static_assert(symbol(std::milli() * si::second) == "ms");
+    static_assert(symbol(std::micro() * si::meter) == "\xC2\xB5m");
+    static_assert(symbol(si::newton) == "m\xC2\xB7kg/s\xC2\xB2");
+    static_assert(symbol(si::hertz) == "s\xE2\x81\xBB\xC2\xB9");
+    static_assert(symbol(si::ohm) == "m\xC2\xB2\xC2\xB7kg/(A\xC2\xB2\xC2\xB7s\xC2\xB3)");
+    static_assert(symbol(pow(si::meter, std::ratio<1, 2>())) == "m^(1/2)");
+    static_assert(symbol(kilometer / hour) == "km/([3600]\xC2\xB7s)");
+    static_assert(symbol(kilometer / minute) == "km/min");
+    static_assert(symbol(degree_scale() * si::radian) == "[0.0174533]\xC2\xB7rad");
+    static_assert(symbol(si::meter / si::meter).empty());
+    // Units defined by BOOST_UNITS2_DEF default to their name.
+    static_assert(symbol(length) == "length");
+}
+
+BOOST_AUTO_TEST_CASE(test_absolute_symbol)
+{
+    static_assert(symbol(temperatures::kelvin) == "K");
+    static_assert(symbol(temperatures::celsius) == "\xC2\xB0" "C");
+    static_assert(symbol(temperatures::fahrenheit) == "\xC2\xB0" "F");
+    static_assert(symbol(absolute_unit(si::meter, std::ratio<-1, 2>())) == "m[-1/2]");
+}
+
+BOOST_AUTO_TEST_CASE(test_to_chars)
+{
+    char buf[32];
+    auto result = to_chars(buf, buf + sizeof(buf), 9.81 * si::meter / (1.0 * si::second * si::second));
+    BOOST_TEST((result.ec == std::errc()));
+    BOOST_TEST(std::string_view(buf, result.ptr) == "9.81 m/s\xC2\xB2");
+    result = to_chars(buf, buf + sizeof(buf), 1.5 * kilometer, std::chars_format::fixed, 3);
+    BOOST_TEST(std::string_view(buf, result.ptr) == "1.500 km");
+    result = to_chars(buf, buf + sizeof(buf), quantity<si::second, int>::from_value(-42));
+    BOOST_TEST(std::string_view(buf, result.ptr) == "-42 s");
+    result = to_chars(buf, buf + sizeof(buf), 0.5 * (si::meter / si::meter));
+    BOOST_TEST(std::string_view(buf, result.ptr) == "0.5");
+    // The value fits, but the symbol does not.
+    result = to_chars(buf, buf + 4, 1.5 * kilometer);
+    BOOST_TEST((result.ec == std::errc::value_too_large));
+    BOOST_TEST(result.ptr == buf + 4);
+    result = to_chars(buf, buf + 2, 100.0 * kilometer);
+    BOOST_TEST((result.ec == std::errc::value_too_large));
+}
+
+BOOST_AUTO_TEST_CASE(test_ostream)
+{
+    std::ostringstream os;
+    os << 2.5 * si::newton << ';' << 20.0 * temperatures::celsius;
+    BOOST_TEST(os.str() == "2.5 m\xC2\xB7kg/s\xC2\xB2;20 \xC2\xB0" "C");
+}
+
+#ifdef __cpp_lib_format
+
+BOOST_AUTO_TEST_CASE(test_format)
+{
+    BOOST_TEST(std::format("{}", 1.5 * kilometer) == "1.5 km");
+    BOOST_TEST(std::format("{:.2f}", 1.5 * kilometer) == "1.50 km");
+    BOOST_TEST(std::format("{:>6}|", quantity<si::second, int>::from_value(7)) == "     7 s|");
+}
+
+#endif
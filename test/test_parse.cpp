@@ -0,0 +1,220 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/parse.hpp>
+#include <boost/units2/format.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <boost/units2/temperature.hpp>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+
+inline constexpr auto kilometer = std::kilo() * si::meter;
+inline constexpr auto hour = std::ratio<3600>() * si::second;
+
+using speed_symbols = symbol_table<
+    prefixed<si::meter / si::second>,
+    spelled<"km/h", kilometer / hour>,
+    spelled<"kph", kilometer / hour>>;
+
+template<auto Unit, class T, class... Table>
+std::from_chars_result parse(std::string_view text, quantity<Unit, T>& q, Table... table)
+{
+    return from_chars(text.data(), text.data() + text.size(), q, table...);
+}
+
+BOOST_AUTO_TEST_CASE(test_symbol_table)
+{
+    static_assert(speed_symbols::size == 21);
+    static_assert(speed_symbols::find("m/s") == 0);
+    static_assert(speed_symbols::find("km/h") == 19);
+    static_assert(speed_symbols::contains("mm/s"));
+    static_assert(speed_symbols::contains("um/s") && speed_symbols::contains("\xC2\xB5m/s"));
+    static_assert(!speed_symbols::contains("mph"));
+    static_assert(!speed_symbols::contains(""));
+    static_assert(std::is_same<speed_symbols::unit_at<20>, std::remove_cv_t<decltype(kilometer / hour)>>::value);
+    // Every symbol is found at its own index.
+    for(std::size_t i = 0; i < si_symbol_table::size; ++i)
+        BOOST_TEST(si_symbol_table::find(si_symbol_table::symbols[i]) == i);
+    BOOST_TEST(si_symbol_table::contains("kPa"));
+    BOOST_TEST(si_symbol_table::contains("M\xCE\xA9"));
+    BOOST_TEST(si_symbol_table::contains("mohm"));
+    BOOST_TEST(si_symbol_table::contains("cd"));
+    BOOST_TEST(!si_symbol_table::contains("kmin"));
+    BOOST_TEST(!si_symbol_table::contains("kkm"));
+}
+
+BOOST_AUTO_TEST_CASE(test_from_chars)
+{
+    quantity<si::meter / si::second> v;
+    std::string_view text = "12.5 km/h";
+    auto result = parse(text, v, speed_symbols());
+    BOOST_TEST((result.ec == std::errc()));
+    BOOST_TEST(result.ptr == text.data() + text.size());
+    BOOST_TEST(v.value() == 12.5 / 3.6, boost::test_tools::tolerance(1e-15));
+    BOOST_TEST((parse("36kph", v, speed_symbols()).ec == std::errc()));
+    BOOST_TEST(v.value() == 10.0);
+
+    quantity<si::meter> m;
+    text = "3.5 km  rest";
+    result = parse(text, m);
+    BOOST_TEST((result.ec == std::errc()));
+    BOOST_TEST(result.ptr == text.data() + 6);
+    BOOST_TEST(m.value() == 3500.0);
+    BOOST_TEST((parse("-2e3 mm", m).ec == std::errc()));
+    BOOST_TEST(m.value() == -2.0);
+
+    quantity<si::second> s;
+    BOOST_TEST((parse("5 min", s).ec == std::errc()));
+    BOOST_TEST(s.value() == 300.0);
+    BOOST_TEST((parse("250 \xCE\xBCs", s).ec == std::errc()));
+    BOOST_TEST(s.value() == 250e-6, boost::test_tools::tolerance(1e-15));
+
+    quantity<si::newton> f;
+    BOOST_TEST((parse("1.5 kN", f).ec == std::errc()));
+    BOOST_TEST(f.value() == 1500.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_from_chars_compound)
+{
+    // Products of the symbols in si_symbol_table
+    quantity<si::meter / si::second> v;
+    std::string_view text = "12.5 km/h";
+    auto result = parse(text, v);
+    BOOST_TEST((result.ec == std::errc()));
+    BOOST_TEST(result.ptr == text.data() + text.size());
+    BOOST_TEST(v.value() == 12.5 / 3.6, boost::test_tools::tolerance(1e-15));
+    BOOST_TEST((parse("12.5 m/s", v).ec == std::errc()));
+    BOOST_TEST(v.value() == 12.5);
+    BOOST_TEST((parse("3 m\xC2\xB7s\xE2\x81\xBB\xC2\xB9", v).ec == std::errc()));
+    BOOST_TEST(v.value() == 3.0);
+    BOOST_TEST((parse("2 m*h^-1", v).ec == std::errc()));
+    BOOST_TEST(v.value() == 2 / 3600.0, boost::test_tools::tolerance(1e-15));
+
+    quantity<si::newton> f;
+    BOOST_TEST((parse("2 kg\xC2\xB7m/s\xC2\xB2", f).ec == std::errc()));
+    BOOST_TEST(f.value() == 2.0);
+    BOOST_TEST((parse("2 g*km/s^2", f).ec == std::errc()));
+    BOOST_TEST(f.value() == 2.0);
+    // / applies to the next factor only.
+    BOOST_TEST((parse("2 kg*m/s/s", f).ec == std::errc()));
+    BOOST_TEST(f.value() == 2.0);
+    BOOST_TEST((parse("3 [1000]\xC2\xB7g\xC2\xB7(m/s^(2))", f).ec == std::errc()));
+    BOOST_TEST(f.value() == 3.0);
+
+    quantity<si::volt> u;
+    BOOST_TEST((parse("6 W/A", u).ec == std::errc()));
+    BOOST_TEST(u.value() == 6.0);
+    BOOST_TEST((parse("6 mW/(mA\xC2\xB7s)", u).ec == std::errc::invalid_argument));
+
+    // Integers are converted exactly.
+    quantity<si::meter, long> m;
+    BOOST_TEST((parse("7 km*s/s", m).ec == std::errc()));
+    BOOST_TEST(m.value() == 7000);
+    BOOST_TEST((parse("2500 mm/s*s", m).ec == std::errc()));
+    BOOST_TEST(m.value() == 2);
+    quantity<si::meter, int> small;
+    BOOST_TEST((parse("3000000 km*m/m", small).ec == std::errc::result_out_of_range));
+}
+
+BOOST_AUTO_TEST_CASE(test_from_chars_compound_errors)
+{
+    quantity<si::meter / si::second> v = 1.0 * (si::meter / si::second);
+    for(std::string_view text : { "5 N", "3 m/s/s", "2 m/", "2 /s", "2 (m/s", "2 m/s)", "2 m^", "2 m^0", "2 m^(1/2)",
+            "2 m//s", "2 m**s", "2 [0]*m/s", "2 [1/0]*m/s", "2 furlong/s", "2 m/s\xE2\x81\xBB", "2 m^99999999999" })
+    {
+        std::from_chars_result result = parse(text, v);
+        BOOST_TEST((result.ec == std::errc::invalid_argument), text);
+        BOOST_TEST(result.ptr == text.data());
+    }
+    BOOST_TEST(v.value() == 1.0);
+
+    // Absolute units are only accepted alone.
+    using temperature_symbols = symbol_table<temperatures::kelvin, si::second>;
+    quantity<si::kelvin / si::second> rate;
+    BOOST_TEST((parse("1 K/s", rate, temperature_symbols()).ec == std::errc::invalid_argument));
+}
+
+BOOST_AUTO_TEST_CASE(test_from_chars_integer)
+{
+    // Integers are converted exactly, as by the constructor.
+    quantity<si::meter, long> m;
+    BOOST_TEST((parse("3 km", m).ec == std::errc()));
+    BOOST_TEST(m.value() == 3000);
+    BOOST_TEST((parse("2500 mm", m).ec == std::errc()));
+    BOOST_TEST(m.value() == 2);
+    quantity<std::milli() * si::second, int> ms;
+    BOOST_TEST((parse("2 h", ms).ec == std::errc()));
+    BOOST_TEST(ms.value() == 7200000);
+}
+
+BOOST_AUTO_TEST_CASE(test_from_chars_absolute)
+{
+    using temperature_symbols = symbol_table<temperatures::kelvin, temperatures::celsius, temperatures::fahrenheit>;
+    quantity<temperatures::celsius> t;
+    BOOST_TEST((parse("212 \xC2\xB0" "F", t, temperature_symbols()).ec == std::errc()));
+    BOOST_TEST(t.value() == 100.0, boost::test_tools::tolerance(1e-12));
+    BOOST_TEST((parse("0 K", t, temperature_symbols()).ec == std::errc()));
+    BOOST_TEST(t.value() == -273.15, boost::test_tools::tolerance(1e-12));
+    // Absolute and relative units do not mix.
+    BOOST_TEST((parse("1 K", t).ec == std::errc::invalid_argument));
+}
+
+BOOST_AUTO_TEST_CASE(test_from_chars_errors)
+{
+    quantity<si::meter> m = 1.0 * si::meter;
+    std::string_view text = "3 furlong";
+    auto result = parse(text, m);
+    BOOST_TEST((result.ec == std::errc::invalid_argument));
+    BOOST_TEST(result.ptr == text.data());
+    // Known symbols with the wrong dimension are rejected.
+    BOOST_TEST((parse("3 s", m).ec == std::errc::invalid_argument));
+    BOOST_TEST((parse("3", m).ec == std::errc::invalid_argument));
+    BOOST_TEST((parse("3 km,", m).ec == std::errc::invalid_argument));
+    BOOST_TEST((parse("km", m).ec == std::errc::invalid_argument));
+    BOOST_TEST((parse("1e999 m", m).ec == std::errc::result_out_of_range));
+    BOOST_TEST(m.value() == 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_round_trip)
+{
+    using table = symbol_table<si::newton, prefixed<si::meter>, si::meter / pow<2>(si::second)>;
+    char buf[64];
+    const auto a = 9.80665 * (si::meter / pow<2>(si::second));
+    char* end = to_chars(buf, buf + sizeof(buf), a).ptr;
+    quantity<si::meter / pow<2>(si::second)> b;
+    BOOST_TEST((from_chars(buf, end, b, table()).ec == std::errc()));
+    BOOST_TEST((a == b));
+    const auto f = 0.1 * si::newton;
+    end = to_chars(buf, buf + sizeof(buf), f).ptr;
+    quantity<si::newton> g;
+    BOOST_TEST((from_chars(buf, end, g, table()).ec == std::errc()));
+    BOOST_TEST((f == g));
+
+    // Compound units are read back with the default table.
+    const auto p = 2.5 * (si::meter * si::kilogram / pow<2>(si::second));
+    end = to_chars(buf, buf + sizeof(buf), p).ptr;
+    BOOST_TEST(std::string_view(buf, end) == "2.5 m\xC2\xB7kg/s\xC2\xB2");
+    BOOST_TEST((from_chars(buf, end, g).ec == std::errc()));
+    BOOST_TEST(g.value() == 2.5);
+    const auto w = 4.0 * (si::meter / (si::second * si::ampere));
+    end = to_chars(buf, buf + sizeof(buf), w).ptr;
+    quantity<si::meter / (si::second * si::ampere)> x;
+    BOOST_TEST((from_chars(buf, end, x).ec == std::errc()));
+    BOOST_TEST((w == x));
+    const auto h = 3.0 * (std::ratio<3600>() * si::second / si::meter);
+    end = to_chars(buf, buf + sizeof(buf), h).ptr;
+    quantity<si::second / si::meter> y;
+    BOOST_TEST((from_chars(buf, end, y).ec == std::errc()));
+    BOOST_TEST(y.value() == 10800.0);
+}
@@ -7,16 +7,124 @@
 #include <boost/units2/quantity.hpp>
 #include <boost/units2/unit.hpp>
 #include <boost/units2/def.hpp>
+#include <type_traits>
 
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 
 BOOST_UNITS2_DEF(length);
 BOOST_UNITS2_DEF(meter, length);
+BOOST_UNITS2_DEF(inch, std::ratio<254,10000>() * meter);
+
+inline constexpr auto centimeter = std::centi() * meter;
+
+// A scale that provides its value in any precision.
+struct third : boost::units2::scale_base {
+    template<class R = double>
+    static constexpr R value() { return R(1)/R(3); }
+};
+BOOST_UNITS2_DEF(thirdmeter, third() * meter);
 
 using boost::units2::quantity;
+using boost::units2::quantity_cast;
+using boost::units2::conversion_factor;
 
 BOOST_AUTO_TEST_CASE(test_quantity)
 {
-    quantity<meter> x{1.0};
+    quantity<meter> x = quantity<meter>::from_value(1.0);
+    BOOST_TEST(x.value() == 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_conversion)
+{
+    constexpr auto m = quantity<meter>::from_value(2.0);
+    constexpr quantity<centimeter> cm(m);
+    static_assert(cm.value() == 200.0);
+    static_assert(quantity_cast<centimeter>(m).value() == 200.0);
+
+    // The value_type may change at the same time.
+    constexpr quantity<centimeter, float> cmf(m);
+    static_assert(cmf.value() == 200.0f);
+    constexpr quantity<meter, double> from_int(quantity<meter, int>::from_value(3));
+    static_assert(from_int.value() == 3.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_value_type_precision)
+{
+    // The conversion factor is produced in the requested type...
+    static_assert(std::is_same<decltype(conversion_factor<float>(inch, meter)), float>::value);
+    static_assert(std::is_same<decltype(conversion_factor<long double>(inch, meter)), long double>::value);
+    // ...but a float factor is only rounded once.
+    static_assert(conversion_factor<float>(inch, meter) == static_cast<float>(conversion_factor(inch, meter)));
+
+    // float quantities are scaled in float.
+    auto f = quantity<inch, float>::from_value(10.0f);
+    static_assert(std::is_same<decltype(quantity_cast<meter>(f))::value_type, float>::value);
+    BOOST_TEST(quantity_cast<meter>(f).value() == 10.0f * conversion_factor<float>(inch, meter));
+
+    // Scales and ratios keep the full precision of long double.
+    BOOST_TEST(conversion_factor<long double>(thirdmeter, meter) == 1.0L/3);
+    BOOST_TEST(conversion_factor<long double>(inch, meter) == 254.0L/10000);
+    auto l = quantity<thirdmeter, long double>::from_value(1.0L);
+    BOOST_TEST(quantity_cast<meter>(l).value() == 1.0L/3);
+    // A compute type can be chosen explicitly.
+    auto d = quantity<thirdmeter>::from_value(3.0);
+    BOOST_TEST((quantity_cast<meter, long double>(d).value() == static_cast<double>(3.0L * (1.0L/3))));
+}
+
+BOOST_AUTO_TEST_CASE(test_common_unit)
+{
+    using boost::units2::common_unit;
+    // Only the coarser unit is scaled.
+    static_assert(std::is_same<decltype(common_unit(meter, centimeter)), std::remove_cv_t<decltype(centimeter)>>::value);
+    static_assert(std::is_same<decltype(common_unit(centimeter, meter)), std::remove_cv_t<decltype(centimeter)>>::value);
+    static_assert(std::is_same<decltype(common_unit(inch, meter)), inch_t>::value);
+    static_assert(std::is_same<decltype(common_unit(meter, meter)), meter_t>::value);
+    // Integers are only scaled by integers.  An inch is 127/5000 meters.
+    constexpr auto common = common_unit<int>(inch, meter);
+    static_assert(conversion_factor(inch, common) == 127);
+    static_assert(conversion_factor(meter, common) == 5000);
+    static_assert(std::is_same<decltype(common_unit<int>(meter, centimeter)), std::remove_cv_t<decltype(centimeter)>>::value);
+}
+
+BOOST_AUTO_TEST_CASE(test_mixed_addition)
+{
+    constexpr auto m = quantity<meter>::from_value(2.0);
+    constexpr auto cm = quantity<centimeter>::from_value(50.0);
+    constexpr auto sum = m + cm;
+    static_assert(std::is_same<decltype(sum), const quantity<centimeter>>::value);
+    static_assert(sum.value() == 250.0);
+    static_assert((cm - m).value() == -150.0);
+    static_assert((m + m).value() == 4.0);
+
+    // Exact for integers, even when neither unit divides the other.
+    constexpr auto i = quantity<inch, int>::from_value(1);
+    constexpr auto im = quantity<meter, int>::from_value(1);
+    constexpr auto isum = i + im;
+    static_assert(std::is_same<decltype(isum)::value_type, int>::value);
+    static_assert(isum.value() == 5127);
+    static_assert(conversion_factor(meter, isum.unit()) == 5000);
+    static_assert((quantity<meter, long long>::from_value(3) - quantity<centimeter, long long>::from_value(1)).value() == 299);
+
+    // A kilometer is 10^12 nanometers, which does not fit in an int.
+    constexpr auto kilometer = std::kilo() * meter;
+    constexpr auto nanometer = std::nano() * meter;
+    using to_nanometers = boost::units2::detail::conversion_ratio<std::remove_cv_t<decltype(kilometer)>, std::remove_cv_t<decltype(nanometer)>>;
+    static_assert(!boost::units2::detail::integer_factor_fits<int, to_nanometers>);
+    static_assert(boost::units2::detail::integer_factor_fits<long long, to_nanometers>);
+    static_assert((quantity<kilometer, long long>::from_value(1) + quantity<nanometer, long long>::from_value(1)).value() == 1000000000001);
+    static_assert(quantity<kilometer, long long>::from_value(1) == quantity<nanometer, long long>::from_value(1000000000000));
+}
+
+BOOST_AUTO_TEST_CASE(test_mixed_comparison)
+{
+    constexpr auto m = quantity<meter>::from_value(1.0);
+    static_assert(m == quantity<centimeter>::from_value(100.0));
+    static_assert(m != quantity<centimeter>::from_value(99.0));
+    static_assert(m > quantity<centimeter>::from_value(99.0));
+    static_assert(quantity<inch>::from_value(1.0) < quantity<centimeter>::from_value(2.55));
+    static_assert(quantity<inch>::from_value(1.0) > quantity<centimeter>::from_value(2.53));
+    static_assert(quantity<inch, int>::from_value(100) == quantity<centimeter, int>::from_value(254));
+    static_assert(quantity<inch, int>::from_value(100) < quantity<meter, int>::from_value(3));
+    static_assert((quantity<meter>::from_value(1.0) <=> quantity<meter>::from_value(2.0)) < 0);
 }
@@ -0,0 +1,143 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/quantity_span.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/def.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+BOOST_UNITS2_DEF(length);
+BOOST_UNITS2_DEF(meter, length);
+BOOST_UNITS2_DEF(duration);
+BOOST_UNITS2_DEF(second, duration);
+
+using boost::units2::quantity;
+using boost::units2::quantity_span;
+using boost::units2::as_quantities;
+using boost::units2::as_values;
+using boost::units2::strided_quantity_view;
+
+// The layout guarantee
+template<class T>
+constexpr bool same_layout()
+{
+    using Q = quantity<meter, T>;
+    return sizeof(Q) == sizeof(T) && alignof(Q) == alignof(T) &&
+        std::is_standard_layout<Q>::value &&
+        std::is_trivially_copyable<Q>::value;
+}
+static_assert(same_layout<double>());
+static_assert(same_layout<float>());
+static_assert(same_layout<long double>());
+static_assert(same_layout<std::int64_t>());
+static_assert(same_layout<std::int8_t>());
+struct alignas(32) vec4 { double x[4]; };
+static_assert(same_layout<vec4>());
+// Types that are not trivially copyable keep the size guarantee.
+static_assert(sizeof(quantity<meter, std::string>) == sizeof(std::string));
+static_assert(!std::is_trivially_copyable<quantity<meter, std::string>>::value);
+
+static_assert(std::random_access_iterator<strided_quantity_view<meter, float>::iterator>);
+static_assert(std::random_access_iterator<strided_quantity_view<meter, const float>::iterator>);
+
+BOOST_AUTO_TEST_CASE(test_as_quantities)
+{
+    std::vector<double> raw = { 1.0, 2.0, 3.0 };
+    quantity_span<meter, double> q = as_quantities<meter>(std::span(raw));
+    BOOST_TEST(q.size() == 3u);
+    BOOST_TEST(q[1].value() == 2.0);
+    // Writes go straight to the underlying buffer.
+    q[2] = quantity<meter>::from_value(5.0);
+    BOOST_TEST(raw[2] == 5.0);
+
+    const std::vector<double>& craw = raw;
+    quantity_span<meter, const double> cq = as_quantities<meter>(std::span(craw));
+    static_assert(std::is_same<decltype(cq)::element_type, const quantity<meter>>::value);
+    BOOST_TEST(cq[0].value() == 1.0);
+
+    std::span<double> back = as_values(q);
+    BOOST_TEST(back.data() == raw.data());
+    std::span<const double> cback = as_values(cq);
+    BOOST_TEST(cback.data() == raw.data());
+
+    // Fixed extents are preserved.
+    double arr[4] = {};
+    auto fixed = as_quantities<meter>(std::span(arr));
+    static_assert(decltype(fixed)::extent == 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_foreign_buffer)
+{
+    // Simulates a buffer received from a file or the network.
+    alignas(double) unsigned char buffer[3 * sizeof(double)];
+    const double values[3] = { 0.5, 1.5, 2.5 };
+    std::memcpy(buffer, values, sizeof(values));
+    auto q = as_quantities<second>(reinterpret_cast<const double*>(buffer), 3);
+    BOOST_TEST(q[2].value() == 2.5);
+}
+
+struct sample {
+    double time;
+    float x;
+    float y;
+};
+
+BOOST_AUTO_TEST_CASE(test_strided)
+{
+    std::vector<sample> samples = { { 0.0, 1.0f, 2.0f }, { 0.1, 3.0f, 4.0f }, { 0.2, 5.0f, 6.0f } };
+    auto t = boost::units2::strided_member<second>(std::span(samples), &sample::time);
+    auto y = boost::units2::strided_member<meter>(std::span(samples), &sample::y);
+    static_assert(std::is_same<decltype(y)::value_type, quantity<meter, float>>::value);
+    BOOST_TEST(t.size() == 3u);
+    BOOST_TEST(t[1].value() == 0.1);
+    BOOST_TEST(y[2].value() == 6.0f);
+    y[0] = quantity<meter, float>::from_value(-1.0f);
+    BOOST_TEST(samples[0].y == -1.0f);
+
+    float sum = 0;
+    for(const auto& q : y) sum += q.value();
+    BOOST_TEST(sum == 9.0f);
+    BOOST_TEST((y.end() - y.begin()) == 3);
+    BOOST_TEST(std::distance(y.begin(), y.end()) == 3);
+
+    strided_quantity_view<meter, const float> cy = y;
+    BOOST_TEST(cy.every(2).size() == 2u);
+    BOOST_TEST(cy.every(2)[1].value() == 6.0f);
+    BOOST_TEST(cy.subview(1, 2)[0].value() == 4.0f);
+
+    // A contiguous view has a stride equal to the element size.
+    std::vector<double> raw = { 1.0, 2.0 };
+    strided_quantity_view<meter, double> contiguous = as_quantities<meter>(std::span(raw));
+    BOOST_TEST(contiguous.is_contiguous());
+    BOOST_TEST(contiguous[1].value() == 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_strided_reverse)
+{
+    // A negative stride walks backwards.  The first element is
+    // padding, so that end() stays within the array.
+    std::vector<double> raw = { 0.0, 1.0, 2.0, 3.0, 4.0 };
+    strided_quantity_view<meter, double> reversed(&raw[4], 4, -static_cast<std::ptrdiff_t>(sizeof(double)));
+    BOOST_TEST(reversed.stride() == -8);
+    BOOST_TEST(reversed[0].value() == 4.0);
+    BOOST_TEST(reversed[3].value() == 1.0);
+    BOOST_TEST((reversed.end() - reversed.begin()) == 4);
+    BOOST_TEST((reversed.begin() < reversed.end()));
+    double expected = 4.0;
+    for(const auto& q : reversed)
+        BOOST_TEST(q.value() == expected--);
+    BOOST_TEST(reversed.subview(1, 2)[1].value() == 2.0);
+    BOOST_TEST(reversed.every(2).size() == 2u);
+    BOOST_TEST(reversed.every(2)[1].value() == 2.0);
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/quantity_vector.hpp>
+#include <boost/units2/batch.hpp>
+#include <boost/units2/def.hpp>
+#include <memory_resource>
+#include <numeric>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+BOOST_UNITS2_DEF(length);
+BOOST_UNITS2_DEF(meter, length);
+
+inline constexpr auto millimeter = std::milli() * meter;
+
+using boost::units2::quantity;
+using boost::units2::quantity_vector;
+
+template<class T>
+struct counting_allocator {
+    using value_type = T;
+    int* count;
+    explicit counting_allocator(int* c) : count(c) {}
+    template<class U>
+    counting_allocator(const counting_allocator<U>& other) : count(other.count) {}
+    T* allocate(std::size_t n) { ++*count; return std::allocator<T>().allocate(n); }
+    void deallocate(T* p, std::size_t n) { std::allocator<T>().deallocate(p, n); }
+    friend bool operator==(const counting_allocator& lhs, const counting_allocator& rhs) { return lhs.count == rhs.count; }
+};
+
+BOOST_AUTO_TEST_CASE(test_element_access)
+{
+    quantity_vector<meter> v;
+    BOOST_TEST(v.empty());
+    for(int i = 0; i < 5; ++i)
+        v.push_back(quantity<meter>::from_value(i * 1.5));
+    BOOST_TEST(v.size() == 5u);
+    BOOST_TEST(v[2].value() == 3.0);
+    BOOST_TEST(v.front().value() == 0.0);
+    BOOST_TEST(v.back().value() == 6.0);
+    BOOST_TEST(v.at(1).value() == 1.5);
+    BOOST_CHECK_THROW(v.at(5), std::out_of_range);
+
+    v[0] = quantity<meter>::from_value(10.0);
+    BOOST_TEST(v.values()[0] == 10.0);
+
+    v.erase(v.begin() + 1);
+    BOOST_TEST(v.size() == 4u);
+    BOOST_TEST(v[1].value() == 3.0);
+    v.insert(v.begin(), quantity<meter>::from_value(-1.0));
+    BOOST_TEST(v[0].value() == -1.0);
+    BOOST_TEST(v[1].value() == 10.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_raw_values)
+{
+    quantity_vector<meter> v(4);
+    // The raw view aliases the elements without copying.
+    auto raw = v.values();
+    BOOST_TEST(static_cast<void*>(raw.data()) == static_cast<void*>(v.data()));
+    std::iota(raw.begin(), raw.end(), 1.0);
+    BOOST_TEST(v[3].value() == 4.0);
+
+    // Ownership of a raw array can be transferred in both directions.
+    std::vector<double> values = { 1.0, 2.0, 3.0 };
+    const double* p = values.data();
+    auto w = quantity_vector<meter>::from_values(std::move(values));
+    BOOST_TEST(w.values().data() == p);
+    BOOST_TEST(w[2].value() == 3.0);
+    std::vector<double> back = w.release_values();
+    BOOST_TEST(back.data() == p);
+    BOOST_TEST(w.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_batch_convert)
+{
+    quantity_vector<millimeter> mm = { quantity<millimeter>::from_value(1500.0), quantity<millimeter>::from_value(20.0) };
+    quantity_vector<meter> m(mm.size());
+    boost::units2::convert(std::span(mm), std::span(m));
+    BOOST_TEST(m[0].value() == 1.5);
+    BOOST_TEST(m[1].value() == 0.02);
+}
+
+BOOST_AUTO_TEST_CASE(test_allocators)
+{
+    int count = 0;
+    quantity_vector<meter, float, counting_allocator<float>> v{counting_allocator<float>(&count)};
+    v.reserve(16);
+    BOOST_TEST(count == 1);
+    v.resize(16, quantity<meter, float>::from_value(2.0f));
+    BOOST_TEST(count == 1);
+    BOOST_TEST(v[15].value() == 2.0f);
+
+    char buffer[1024];
+    std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    boost::units2::pmr::quantity_vector<meter> p(&resource);
+    p.resize(64);
+    BOOST_TEST(static_cast<void*>(p.data()) >= static_cast<void*>(buffer));
+    BOOST_TEST(static_cast<void*>(p.data() + p.size()) <= static_cast<void*>(buffer + sizeof(buffer)));
+}
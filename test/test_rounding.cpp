@@ -0,0 +1,116 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/rounding.hpp>
+#include <boost/units2/unit.hpp>
+#include <boost/units2/def.hpp>
+#include <cstdint>
+#include <type_traits>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+BOOST_UNITS2_DEF(length);
+BOOST_UNITS2_DEF(meter, length);
+BOOST_UNITS2_DEF(inch, std::ratio<254,10000>() * meter);
+
+inline constexpr auto centimeter = std::centi() * meter;
+inline constexpr auto millimeter = std::milli() * meter;
+inline constexpr auto micrometer = std::micro() * meter;
+inline constexpr auto nanometer = std::nano() * meter;
+// A factor whose numerator and denominator multiply to more than 64 bits.
+inline constexpr auto odd_meter = std::ratio<10000000019, 9999999967>() * meter;
+
+using boost::units2::quantity;
+using boost::units2::quantity_cast;
+using boost::units2::checked_quantity_cast;
+using boost::units2::conversion_overflow;
+namespace rounding = boost::units2::rounding;
+
+template<auto Unit, class R, auto Unit2, class T>
+constexpr T cast(T x)
+{
+    return quantity_cast<Unit, R>(quantity<Unit2, T>::from_value(x)).value();
+}
+
+BOOST_AUTO_TEST_CASE(test_exact)
+{
+    // 2^53 + 1 is not representable in double.
+    constexpr std::int64_t big = (std::int64_t(1) << 53) + 1;
+    constexpr quantity<nanometer, std::int64_t> nm(quantity<micrometer, std::int64_t>::from_value(big));
+    static_assert(nm.value() == big * 1000);
+    BOOST_TEST((quantity_cast<nanometer, double>(quantity<micrometer, std::int64_t>::from_value(big)).value() != big * 1000));
+    // A factor of 127/50, applied without going through double.
+    static_assert(quantity_cast<centimeter>(quantity<inch, std::int64_t>::from_value(big)).value() == big / 50 * 127 + big % 50 * 127 / 50);
+    static_assert(quantity_cast<micrometer>(quantity<meter, std::uint64_t>::from_value(18000000000000ull)).value() == 18000000000000000000ull);
+    // Narrower value types are widened for the computation.
+    static_assert(quantity<micrometer, std::int16_t>(quantity<millimeter, std::int16_t>::from_value(30)).value() == 30000);
+    static_assert(quantity<millimeter, int>(quantity<meter, short>::from_value(-30000)).value() == -30000000);
+}
+
+BOOST_AUTO_TEST_CASE(test_rounding)
+{
+    // 7mm == 0.7cm
+    static_assert(cast<centimeter, rounding::toward_zero, millimeter>(7) == 0);
+    static_assert(cast<centimeter, rounding::down, millimeter>(7) == 0);
+    static_assert(cast<centimeter, rounding::up, millimeter>(7) == 1);
+    static_assert(cast<centimeter, rounding::to_nearest, millimeter>(7) == 1);
+    static_assert(cast<centimeter, rounding::toward_zero, millimeter>(-7) == 0);
+    static_assert(cast<centimeter, rounding::down, millimeter>(-7) == -1);
+    static_assert(cast<centimeter, rounding::up, millimeter>(-7) == 0);
+    static_assert(cast<centimeter, rounding::to_nearest, millimeter>(-7) == -1);
+    // Halfway cases
+    static_assert(cast<centimeter, rounding::to_nearest, millimeter>(15) == 2);
+    static_assert(cast<centimeter, rounding::to_nearest_even, millimeter>(15) == 2);
+    static_assert(cast<centimeter, rounding::to_nearest, millimeter>(25) == 3);
+    static_assert(cast<centimeter, rounding::to_nearest_even, millimeter>(25) == 2);
+    static_assert(cast<centimeter, rounding::to_nearest, millimeter>(-25) == -3);
+    static_assert(cast<centimeter, rounding::to_nearest_even, millimeter>(-25) == -2);
+    static_assert(cast<centimeter, rounding::to_nearest_even, millimeter>(-35) == -4);
+    // 3in == 7.62cm
+    static_assert(cast<centimeter, rounding::toward_zero, inch>(3) == 7);
+    static_assert(cast<centimeter, rounding::to_nearest, inch>(3) == 8);
+    static_assert(cast<centimeter, rounding::down, inch>(-3) == -8);
+    static_assert(cast<centimeter, rounding::up, inch>(-3) == -7);
+    // Unsigned values
+    static_assert(cast<centimeter, rounding::up, millimeter>(7u) == 1u);
+    static_assert(cast<centimeter, rounding::to_nearest, millimeter>(14u) == 1u);
+    // The default truncates, like the conversion through double did.
+    static_assert(quantity<centimeter, int>(quantity<millimeter, int>::from_value(-7)).value() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_wide_factor)
+{
+    constexpr std::int64_t x = 123456789012345678;
+    static_assert(cast<meter, rounding::toward_zero, odd_meter>(x) == 123456789654320982);
+    static_assert(cast<meter, rounding::to_nearest, odd_meter>(x) == 123456789654320983);
+    static_assert(cast<meter, rounding::toward_zero, odd_meter>(-x) == -123456789654320982);
+    static_assert(cast<meter, rounding::down, odd_meter>(-x) == -123456789654320983);
+    static_assert(cast<meter, rounding::up, odd_meter>(-x) == -123456789654320982);
+}
+
+BOOST_AUTO_TEST_CASE(test_overflow)
+{
+    static_assert(checked_quantity_cast<micrometer>(quantity<meter, int>::from_value(2000)).value() == 2000000000);
+    BOOST_CHECK_THROW(checked_quantity_cast<micrometer>(quantity<meter, int>::from_value(3000)), conversion_overflow);
+    BOOST_CHECK_THROW(checked_quantity_cast<micrometer>(quantity<meter, int>::from_value(-3000)), conversion_overflow);
+    BOOST_CHECK_THROW(checked_quantity_cast<nanometer>(quantity<meter, std::uint64_t>::from_value(20000000000ull)), conversion_overflow);
+    BOOST_TEST(checked_quantity_cast<nanometer>(quantity<meter, std::uint64_t>::from_value(18000000000ull)).value() == 18000000000000000000ull);
+    // Rounding up can overflow too.
+    constexpr std::int8_t max = 127;
+    BOOST_TEST((checked_quantity_cast<meter, rounding::down>(quantity<odd_meter, std::int8_t>::from_value(max)).value() == max));
+    BOOST_CHECK_THROW((checked_quantity_cast<meter, rounding::up>(quantity<odd_meter, std::int8_t>::from_value(max))), conversion_overflow);
+}
+
+BOOST_AUTO_TEST_CASE(test_floating_point)
+{
+    // Floating point values are unaffected.
+    static_assert(quantity<centimeter, double>(quantity<millimeter, double>::from_value(7)).value() == 7 * 0.1);
+    // An explicit scale type selects the floating point factor.
+    static_assert(std::is_same<decltype(quantity_cast<centimeter, double>(quantity<millimeter, int>::from_value(7)))::value_type, int>::value);
+    BOOST_TEST((quantity_cast<centimeter, double>(quantity<millimeter, int>::from_value(19)).value() == 1));
+}
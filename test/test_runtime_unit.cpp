@@ -0,0 +1,136 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/runtime_unit.hpp>
+#include <boost/units2/si.hpp>
+#include <cmath>
+#include <ratio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+using boost::units2::detail::rational;
+
+namespace {
+
+struct pi_scale : scale_base { static constexpr double value() { return 3.14159265358979323846; } };
+
+}
+
+BOOST_AUTO_TEST_CASE(test_rational)
+{
+    constexpr rational half(2, 4);
+    static_assert(half.num == 1 && half.den == 2);
+    static_assert(half * rational(4) == rational(2));
+    static_assert(half + rational(1, 3) == rational(5, 6));
+    static_assert(rational(1, -2) == -half);
+    constexpr rational big = rational(INTMAX_MAX / 2) * rational(3);
+    static_assert(!big.valid());
+    static_assert(!(big == big));
+}
+
+BOOST_AUTO_TEST_CASE(test_from_static)
+{
+    runtime_unit newton(si::newton);
+    BOOST_TEST((newton.exponent(base_dimension::mass) == 1));
+    BOOST_TEST((newton.exponent(base_dimension::length) == 1));
+    BOOST_TEST((newton.exponent(base_dimension::time) == -2));
+    // gram is the base unit of mass
+    BOOST_TEST((newton.scale() == 1000));
+    BOOST_TEST(newton.irrational_scale() == 1.0);
+    BOOST_TEST((runtime_unit(si::hertz) == runtime_unit(si::becquerel)));
+    BOOST_TEST((!(runtime_unit(si::hertz) == runtime_unit(si::second))));
+    runtime_unit degree(pi_scale() * (std::ratio<1, 180>() * si::radian));
+    BOOST_TEST(degree.factor() == 3.14159265358979323846 / 180, boost::test_tools::tolerance(1e-15));
+    BOOST_TEST(std::string(dimension_name(base_dimension::luminous_intensity)) == "luminous_intensity");
+}
+
+BOOST_AUTO_TEST_CASE(test_parse)
+{
+    BOOST_TEST((parse_unit("kg*m/s^2") == runtime_unit(si::newton)));
+    BOOST_TEST((parse_unit("kg m s^-2") == runtime_unit(si::newton)));
+    BOOST_TEST((parse_unit("kg·m/s/s") == runtime_unit(si::newton)));
+    BOOST_TEST((parse_unit("N*m") == runtime_unit(si::joule)));
+    BOOST_TEST((parse_unit("(m/s)^2") == runtime_unit(pow<2>(si::meter / si::second))));
+    BOOST_TEST((parse_unit("mm") == runtime_unit(std::milli() * si::meter)));
+    BOOST_TEST((parse_unit("µs") == runtime_unit(std::micro() * si::second)));
+    BOOST_TEST((parse_unit("us") == runtime_unit(std::micro() * si::second)));
+    BOOST_TEST((parse_unit("dam") == runtime_unit(std::deca() * si::meter)));
+    BOOST_TEST((parse_unit("cd") == runtime_unit(si::candela)));
+    BOOST_TEST((parse_unit("hPa") == runtime_unit(std::hecto() * si::pascal)));
+    BOOST_TEST((parse_unit("1") == runtime_unit()));
+    BOOST_TEST((parse_unit("0.3048*m") == runtime_unit(std::ratio<3048, 10000>() * si::meter)));
+    BOOST_TEST((parse_unit("m^(1/2)") == runtime_unit(pow(si::meter, std::ratio<1, 2>()))));
+    // An exact root keeps the scale exact
+    BOOST_TEST((parse_unit("(100*m)^(1/2)").scale() == 10));
+    BOOST_TEST((parse_unit("(2*m)^(1/2)").scale() == 1));
+    BOOST_TEST(parse_unit("(2*m)^(1/2)").irrational_scale() == std::sqrt(2.0));
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_errors)
+{
+    BOOST_CHECK_THROW(parse_unit(""), unit_parse_error);
+    BOOST_CHECK_THROW(parse_unit("m/"), unit_parse_error);
+    BOOST_CHECK_THROW(parse_unit("(m"), unit_parse_error);
+    BOOST_CHECK_THROW(parse_unit("m^x"), unit_parse_error);
+    BOOST_CHECK_THROW(parse_unit("kmin"), unit_parse_error);
+    try
+    {
+        parse_unit("kg*furlong");
+        BOOST_ERROR("expected unit_parse_error");
+    }
+    catch(const unit_parse_error& e)
+    {
+        BOOST_TEST(e.position() == 3u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_conversion_factor)
+{
+    BOOST_TEST(conversion_factor(parse_unit("km/h"), parse_unit("m/s")) == 1.0 / 3.6, boost::test_tools::tolerance(1e-15));
+    BOOST_TEST(conversion_factor(parse_unit("mm"), parse_unit("m")) == 0.001);
+    BOOST_TEST(conversion_factor(parse_unit("kg"), runtime_unit(si::gram)) == 1000.0);
+    BOOST_CHECK_THROW(conversion_factor(parse_unit("m"), parse_unit("s")), runtime_unit_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_custom_table)
+{
+    unit_symbol_table table = unit_symbol_table::si();
+    table.add("ft", std::ratio<3048, 10000>() * si::meter, false);
+    BOOST_TEST(conversion_factor(parse_unit("ft^2", table), parse_unit("m^2")) == 0.09290304, boost::test_tools::tolerance(1e-15));
+    BOOST_CHECK_THROW(parse_unit("kft", table), unit_parse_error);
+    BOOST_CHECK_THROW(parse_unit("ft"), unit_parse_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_cache)
+{
+    conversion_cache cache;
+    BOOST_TEST(cache.factor("km/h", "m/s") == 1.0 / 3.6, boost::test_tools::tolerance(1e-15));
+    runtime_unit u = cache.unit("km/h");
+    BOOST_TEST((cache.unit("km/h") == u));
+    cache.clear();
+    BOOST_TEST((cache.unit("km/h") == u));
+    BOOST_TEST(cache.factor("km/h", "m/s") == 1.0 / 3.6, boost::test_tools::tolerance(1e-15));
+    BOOST_CHECK_THROW(cache.factor("m", "s"), runtime_unit_error);
+    BOOST_CHECK_THROW(cache.factor("m", "?"), unit_parse_error);
+
+    std::vector<std::thread> threads;
+    std::vector<double> results(8);
+    for(int i = 0; i < 8; ++i)
+        threads.emplace_back([&, i] {
+            double total = 0;
+            for(int j = 0; j < 1000; ++j)
+                total += cache.factor(j % 2? "mm" : "km", "m");
+            results[i] = total;
+        });
+    for(auto& t : threads) t.join();
+    for(double r : results)
+        BOOST_TEST(r == 500 * 1000.0 + 500 * 0.001, boost::test_tools::tolerance(1e-12));
+}
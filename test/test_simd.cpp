@@ -0,0 +1,132 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/simd.hpp>
+#include <boost/units2/quantity.hpp>
+#include <boost/units2/si.hpp>
+#include <type_traits>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+
+inline constexpr auto kilometer = std::kilo() * si::meter;
+inline constexpr auto centimeter = std::centi() * si::meter;
+
+// A minimal user defined vector type.
+struct float2 {
+    float x, y;
+    friend constexpr float2 operator+(float2 a, float2 b) { return { a.x + b.x, a.y + b.y }; }
+    friend constexpr float2 operator*(float2 a, float2 b) { return { a.x * b.x, a.y * b.y }; }
+    friend constexpr float2 operator*(float2 a, float b) { return { a.x * b, a.y * b }; }
+    friend constexpr float2 operator*(float a, float2 b) { return b * a; }
+};
+
+template<>
+struct boost::units2::numeric_traits<float2>
+{
+    static constexpr bool is_numeric = true;
+    using scalar_type = float;
+};
+
+BOOST_AUTO_TEST_CASE(test_custom_vector)
+{
+    constexpr float2 v = { 1.5f, 2.0f };
+    constexpr auto q = v * kilometer;
+    static_assert(std::is_same<std::remove_cv_t<decltype(q)>, quantity<kilometer, float2>>::value);
+    // Scaling by numbers
+    constexpr auto doubled = 2.0f * q;
+    static_assert(doubled.value().x == 3.0f && doubled.value().y == 4.0f);
+    // The factor is applied as a float.
+    constexpr quantity<si::meter, float2> m(q);
+    static_assert(m.value().x == 1500.0f && m.value().y == 2000.0f);
+    // Mixed units are added in the finer unit.
+    constexpr auto sum = q + m;
+    static_assert(std::is_same<std::remove_cv_t<decltype(sum.unit())>, std::remove_cv_t<decltype(si::meter)>>::value);
+    static_assert(sum.value().x == 3000.0f && sum.value().y == 4000.0f);
+    static_assert(sizeof(quantity<si::meter, float2>) == sizeof(float2));
+}
+
+#ifdef __cpp_lib_experimental_parallel_simd
+
+namespace stdx = std::experimental;
+
+template<class T, class Abi>
+bool lanes_equal(const stdx::simd<T, Abi>& x, std::initializer_list<T> expected)
+{
+    std::size_t i = 0;
+    for(T e : expected)
+        if(x[i++] != e) return false;
+    return true;
+}
+
+BOOST_AUTO_TEST_CASE(test_simd_arithmetic)
+{
+    using pack = stdx::fixed_size_simd<double, 4>;
+    using mask = pack::mask_type;
+    pack v([](int i) { return 1.0 + i; });
+    auto length = v * kilometer;
+    static_assert(std::is_same<decltype(length), quantity<kilometer, pack>>::value);
+    auto time = pack(2.0) * si::second;
+    auto speed = length / time;
+    static_assert(std::is_same<std::remove_cv_t<decltype(speed.unit())>, std::remove_cv_t<decltype(kilometer / si::second)>>::value);
+    BOOST_TEST(stdx::all_of(speed.value() == v / 2));
+    BOOST_TEST(stdx::all_of((length * 2.0).value() == v * 2));
+    BOOST_TEST(stdx::all_of((2.0 * length).value() == v * 2));
+    BOOST_TEST(stdx::all_of((length / 2.0).value() == v / 2));
+    BOOST_TEST(stdx::all_of((-length).value() == -v));
+    BOOST_TEST(stdx::all_of((length * length).value() == v * v));
+
+    // Conversions broadcast the factor.
+    quantity<si::meter, pack> m(length);
+    BOOST_TEST(stdx::all_of(m.value() == v * 1000));
+    auto sum = m + length;
+    static_assert(std::is_same<decltype(sum), quantity<si::meter, pack>>::value);
+    BOOST_TEST(stdx::all_of(sum.value() == v * 2000));
+
+    // Comparisons are lane by lane.
+    auto limit = pack(2500.0) * si::meter;
+    static_assert(std::is_same<decltype(length < limit), mask>::value);
+    BOOST_TEST(stdx::popcount(length < limit) == 2);
+    BOOST_TEST(stdx::popcount(length <= limit) == 2);
+    BOOST_TEST(stdx::popcount(length > limit) == 2);
+    BOOST_TEST(stdx::popcount(length >= limit) == 2);
+    BOOST_TEST(stdx::all_of(length == m));
+    BOOST_TEST(stdx::none_of(length != m));
+}
+
+BOOST_AUTO_TEST_CASE(test_simd_float)
+{
+    using pack = stdx::native_simd<float>;
+    // Packs of float are scaled as float.
+    quantity<si::meter, pack> m(pack(1.25f) * kilometer);
+    BOOST_TEST(stdx::all_of(m.value() == pack(1250.0f)));
+}
+
+BOOST_AUTO_TEST_CASE(test_simd_integer)
+{
+    using pack = stdx::fixed_size_simd<int, 4>;
+    pack v([](int i) { return 1 + i; });
+    // Integer elements select the integer common_unit.
+    auto sum = v * si::meter + v * centimeter;
+    static_assert(std::is_same<decltype(sum), quantity<centimeter, pack>>::value);
+    BOOST_TEST(lanes_equal(sum.value(), { 101, 202, 303, 404 }));
+
+    // Conversions are done in integer arithmetic, and truncate toward zero.
+    quantity<centimeter, pack> cm(v * si::meter);
+    BOOST_TEST(lanes_equal(cm.value(), { 100, 200, 300, 400 }));
+    pack mm([](int i) { return i * 1500 - 1999; });
+    quantity<si::meter, pack> m(mm * (std::milli() * si::meter));
+    BOOST_TEST(lanes_equal(m.value(), { -1, 0, 1, 2 }));
+    // 1 inch is 127/50 cm.
+    constexpr auto inch = std::ratio<254, 10000>() * si::meter;
+    quantity<centimeter, pack> in(v * inch);
+    BOOST_TEST(lanes_equal(in.value(), { 2, 5, 7, 10 }));
+    BOOST_TEST(lanes_equal(quantity_cast<si::meter>(sum).value(), { 1, 2, 3, 4 }));
+}
+
+#endif
@@ -6,6 +6,7 @@
 
 #include <boost/units2/unit.hpp>
 #include <boost/units2/def.hpp>
+#include <boost/mp11/algorithm.hpp>
 #include <boost/type_index.hpp>
 
 #define BOOST_TEST_MODULE test_unit
@@ -90,3 +91,75 @@ BOOST_AUTO_TEST_CASE(test_basic_conversion, * boost::unit_test::tolerance(std::n
     BOOST_TEST(conversion_factor(nm*nm*nm, meter*meter*meter) == 1e-27);
     BOOST_TEST(conversion_factor(meter*meter*meter, nm*nm*nm) == 1e+27);
 }
+
+// Every conversion factor is a constant expression.  Since these are
+// evaluated by the compiler, they cannot call into libm at run time.
+BOOST_AUTO_TEST_CASE(test_constexpr_conversion, * boost::unit_test::tolerance(2*std::numeric_limits<double>::epsilon()))
+{
+    constexpr auto nm = std::nano() * meter;
+    // ratios that overflow std::ratio
+    constexpr double cubic = conversion_factor(nm*nm*nm, meter*meter*meter);
+    BOOST_TEST(cubic == 1e-27);
+    constexpr double large = conversion_factor(pow<4>(meter), pow<4>(nm));
+    BOOST_TEST(large == 1e+36);
+
+    // non-ratio scales
+    constexpr double deg = conversion_factor(degree, radian);
+    BOOST_TEST(deg == 180/3.14159265358979323846);
+    constexpr double sq_deg = conversion_factor(pow<-2>(radian), pow<-2>(degree));
+    BOOST_TEST(sq_deg == (180/3.14159265358979323846)*(180/3.14159265358979323846));
+
+    // fractional exponents that have an exact rational result...
+    constexpr double root_cm = conversion_factor(pow(centimeter, std::ratio<1,2>()), pow(meter, std::ratio<1,2>()));
+    static_assert(root_cm == 0.1);
+    constexpr double root3 = conversion_factor(pow(std::ratio<8,27>() * meter, std::ratio<2,3>()), pow(meter, std::ratio<2,3>()));
+    static_assert(root3 == 4./9);
+    // ...and ones that don't
+    constexpr double root2 = conversion_factor(pow(std::ratio<2>() * meter, std::ratio<1,2>()), pow(meter, std::ratio<1,2>()));
+    BOOST_TEST(root2 == 1.41421356237309504880);
+    constexpr double root_deg = conversion_factor(pow(degree, std::ratio<1,3>()), pow(radian, std::ratio<1,3>()));
+    BOOST_TEST(root_deg == 3.85514642081409824);
+    constexpr double tiny = conversion_factor(pow(nm, std::ratio<-5,7>()), pow(meter, std::ratio<-5,7>()));
+    BOOST_TEST(tiny == 2.68269579527972595e6);
+}
+
+namespace merge_test {
+
+using namespace boost::units2;
+template<class I>
+using element = dim<std::ratio<1, I::value + 2>, std::ratio<static_cast<int>(I::value % 3) * 2 - 1>>;
+template<class I>
+using inverse = dim<std::ratio<1, I::value + 2>, std::ratio<1 - static_cast<int>(I::value % 3) * 2>>;
+template<class T, class U>
+using less = boost::mp11::mp_bool<(detail::scale_compare<typename T::base, typename U::base>::value < 0)>;
+template<std::size_t N, template<class> class F>
+using make_list = boost::mp11::mp_rename<boost::mp11::mp_sort<boost::mp11::mp_transform<F, boost::mp11::mp_iota_c<N>>, less>, detail::scale_list>;
+template<class T, class U>
+using pairwise = detail::merge_recurse<detail::scale_compare, detail::scale_list, T, U>;
+template<class T, class U>
+using merge = detail::merge<detail::scale_compare, detail::scale_list, T, U>;
+template<class... T>
+using merge_all = detail::merge_all<detail::scale_compare, detail::scale_list, T...>;
+
+}
+
+// Long sequences and merges of several sequences go through
+// a different algorithm, which must give the same types.
+BOOST_AUTO_TEST_CASE(test_merge_long)
+{
+    using namespace merge_test;
+    using a = make_list<80, element>;
+    using b = make_list<50, element>;
+    using c = make_list<20, inverse>;
+    using ab = merge<a, b>;
+    using bc = merge<b, c>;
+    using bcb = merge_all<b, c, b>;
+    using cbcb = merge_all<c, b, c, b>;
+    using d = make_list<20, element>;
+    using cc = merge_all<c, d, c, d>;
+    TEST_SAME_TYPE(ab(), (pairwise<a, b>()));
+    TEST_SAME_TYPE(bc(), (pairwise<b, c>()));
+    TEST_SAME_TYPE(bcb(), (pairwise<pairwise<b, c>, b>()));
+    TEST_SAME_TYPE(cbcb(), (pairwise<pairwise<pairwise<c, b>, c>, b>()));
+    TEST_SAME_TYPE(cc(), detail::scale_list<>());
+}
@@ -0,0 +1,194 @@
+// Copyright (c) 2018 Steven Watanabe
+//
+// Distributed under the Boost Software License Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/units2/wire.hpp>
+#include <boost/units2/conversion_table.hpp>
+#include <boost/units2/quantity_vector.hpp>
+#include <boost/units2/si.hpp>
+#include <boost/units2/temperature.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ratio>
+#include <span>
+#include <vector>
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::units2;
+
+constexpr auto kilometer = std::kilo() * si::meter;
+constexpr auto millimeter = std::milli() * si::meter;
+constexpr auto hour = std::ratio<3600>() * si::second;
+
+using length_table = conversion_table<si::meter, kilometer, millimeter, si::second, hour>;
+
+BOOST_AUTO_TEST_CASE(test_tag)
+{
+    static_assert(wire_tag_v<si::meter> == fingerprint(si::meter));
+    static_assert(wire_tag_v<si::meter * si::second / si::second> == wire_tag_v<si::meter>);
+    static_assert(wire_tag_v<si::meter, float> != wire_tag_v<si::meter>);
+    static_assert(wire_tag_v<si::meter, std::int32_t> != wire_tag_v<si::meter, std::uint32_t>);
+    static_assert(wire_tag_v<kilometer> != wire_tag_v<si::meter>);
+    static_assert(wire_size<double> == 16);
+    static_assert(wire_array_size<float>(3) == 28);
+}
+
+BOOST_AUTO_TEST_CASE(test_quantity)
+{
+    std::byte buf[wire_size<double>];
+    BOOST_TEST(write_wire(buf, 2.5 * si::meter) == sizeof(buf));
+    // The tag, then the value, both little endian.
+    BOOST_TEST(static_cast<unsigned>(buf[0]) == (fingerprint(si::meter) & 0xff));
+    BOOST_TEST(static_cast<unsigned>(buf[15]) == 0x40u);
+    BOOST_TEST(read_wire<si::meter>(buf).value() == 2.5);
+    BOOST_CHECK_THROW(read_wire<kilometer>(buf), wire_error);
+    BOOST_CHECK_THROW((read_wire<si::meter, float>(buf)), wire_error);
+    BOOST_CHECK_THROW(read_wire<si::meter>(std::span<const std::byte>(buf, 15)), wire_error);
+    BOOST_CHECK_THROW(write_wire(std::span<std::byte>(buf, 15), 1.0 * si::meter), wire_error);
+
+    std::byte ibuf[wire_size<std::int32_t>];
+    write_wire(ibuf, quantity<si::second, std::int32_t>::from_value(-7));
+    BOOST_TEST((read_wire<si::second, std::int32_t>(ibuf).value() == -7));
+}
+
+BOOST_AUTO_TEST_CASE(test_quantity_conversion)
+{
+    std::byte buf[wire_size<double>];
+    write_wire(buf, 1.5 * kilometer);
+    BOOST_TEST(read_wire<si::meter>(buf, length_table()).value() == 1500.0);
+    BOOST_TEST(read_wire<millimeter>(buf, length_table()).value() == 1.5e6);
+    BOOST_TEST(read_wire<kilometer>(buf, length_table()).value() == 1.5);
+    BOOST_CHECK_THROW(read_wire<si::second>(buf, length_table()), wire_error);
+    // The value type is part of the tag.
+    BOOST_CHECK_THROW((read_wire<si::meter, float>(buf, length_table())), wire_error);
+    std::byte fbuf[wire_size<float>];
+    write_wire(fbuf, quantity<hour, float>::from_value(0.5f));
+    BOOST_TEST((read_wire<si::second, float>(fbuf, length_table()).value() == 1800.0f));
+
+    unit_registry registry;
+    registry.add(si_conversion_table());
+    registry.add(length_table());
+    BOOST_TEST(read_wire<si::meter>(buf, registry).value() == 1500.0);
+    write_wire(buf, 2.0 * si::kilogram);
+    BOOST_TEST(read_wire<si::gram>(buf, registry).value() == 2000.0);
+    BOOST_CHECK_THROW(read_wire<si::meter>(buf, registry), wire_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_integer_conversion)
+{
+    // Integers are converted by the exact factor, not through double.
+    std::byte buf[wire_size<std::int64_t>];
+    write_wire(buf, quantity<si::meter, std::int64_t>::from_value(9007199254740993));
+    BOOST_TEST((read_wire<millimeter, std::int64_t>(buf, length_table()).value() == 9007199254740993000));
+    write_wire(buf, quantity<millimeter, std::int64_t>::from_value(-2999));
+    BOOST_TEST((read_wire<si::meter, std::int64_t>(buf, length_table()).value() == -2));
+    write_wire(buf, quantity<kilometer, std::int64_t>::from_value(10000000000000000));
+    BOOST_CHECK_THROW((read_wire<millimeter, std::int64_t>(buf, length_table())), wire_error);
+
+    unit_registry registry;
+    registry.add(conversion_table<si::meter, kilometer>());
+    registry.add(conversion_table<millimeter>());
+    write_wire(buf, quantity<kilometer, std::int64_t>::from_value(9007199254740993));
+    BOOST_TEST((read_wire<si::meter, std::int64_t>(buf, registry).value() == 9007199254740993000));
+    write_wire(buf, quantity<millimeter, std::int64_t>::from_value(1999999));
+    BOOST_TEST((read_wire<kilometer, std::int64_t>(buf, registry).value() == 1));
+
+    alignas(8) std::byte abuf[wire_array_size<std::int32_t>(3)];
+    quantity<millimeter, std::int32_t> in[] = {
+        quantity<millimeter, std::int32_t>::from_value(999),
+        quantity<millimeter, std::int32_t>::from_value(-1000),
+        quantity<millimeter, std::int32_t>::from_value(123456789) };
+    write_wire(abuf, std::span(in));
+    converted_column<si::meter, std::int32_t> meters = read_wire_array<si::meter, std::int32_t>(abuf, length_table());
+    BOOST_TEST(meters.numerator() == 1);
+    BOOST_TEST(meters.denominator() == 1000);
+    BOOST_TEST(meters[0].value() == 0);
+    BOOST_TEST(meters[1].value() == -1);
+    quantity<si::meter, std::int32_t> out[3];
+    meters.read(0, out);
+    BOOST_TEST(out[2].value() == 123456);
+}
+
+BOOST_AUTO_TEST_CASE(test_array)
+{
+    quantity_vector<kilometer> in;
+    for(int i = 0; i < 5; ++i)
+        in.push_back(i * 0.5 * kilometer);
+    alignas(8) std::byte buf[wire_array_size<double>(5)];
+    BOOST_TEST(write_wire(buf, in) == sizeof(buf));
+
+    // In the same unit, the result views the buffer.
+    converted_column<kilometer, double> same = read_wire_array<kilometer>(buf);
+    BOOST_TEST(same.size() == 5u);
+    BOOST_TEST(same.is_identity());
+    BOOST_TEST(static_cast<const void*>(same.stored_values().data()) == static_cast<const void*>(buf + 16));
+    BOOST_TEST(same[3].value() == 1.5);
+
+    converted_column<si::meter, double> meters = read_wire_array<si::meter>(buf, length_table());
+    BOOST_TEST(meters.factor() == 1000.0);
+    BOOST_TEST(static_cast<const void*>(meters.stored_values().data()) == static_cast<const void*>(buf + 16));
+    BOOST_TEST(meters[4].value() == 2000.0);
+    quantity<si::meter> out[5];
+    meters.read(0, out);
+    BOOST_TEST(out[1].value() == 500.0);
+
+    BOOST_CHECK_THROW(read_wire_array<si::meter>(buf), wire_error);
+    BOOST_CHECK_THROW(read_wire_array<kilometer>(std::span<const std::byte>(buf, sizeof(buf) - 1)), wire_error);
+    // A huge element count must not overflow the size check.
+    std::byte bad[wire_array_size<double>(0)];
+    std::memcpy(bad, buf, 8);
+    std::uint64_t count = ~std::uint64_t(0);
+    std::memcpy(bad + 8, &count, 8);
+    BOOST_CHECK_THROW(read_wire_array<kilometer>(bad), wire_error);
+
+    alignas(8) std::byte empty[wire_array_size<double>(0)];
+    write_wire(empty, std::span<const quantity<si::meter>>());
+    BOOST_TEST(read_wire_array<si::meter>(empty).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_misaligned_array)
+{
+    std::vector<quantity<si::meter>> in(3, 1.0 * si::meter);
+    alignas(8) std::byte buf[wire_array_size<double>(3) + 4];
+    write_wire(std::span<std::byte>(buf + 4, sizeof(buf) - 4), std::span(in));
+    BOOST_CHECK_THROW(read_wire_array<si::meter>(std::span<const std::byte>(buf + 4, sizeof(buf) - 4)), wire_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_absolute)
+{
+    using temperatures::celsius;
+    using temperatures::kelvin;
+    using temperature_table = conversion_table<kelvin, celsius>;
+    std::byte buf[wire_size<double>];
+    write_wire(buf, 300.0 * kelvin);
+    BOOST_TEST(read_wire<kelvin>(buf).value() == 300.0);
+    BOOST_TEST(read_wire<celsius>(buf, temperature_table()).value() == 26.85, boost::test_tools::tolerance(1e-12));
+
+    unit_registry registry;
+    registry.add(temperature_table());
+    BOOST_TEST(read_wire<celsius>(buf, registry).value() == 26.85, boost::test_tools::tolerance(1e-12));
+
+    quantity_vector<celsius> in;
+    in.push_back(0.0 * celsius);
+    in.push_back(100.0 * celsius);
+    alignas(8) std::byte abuf[wire_array_size<double>(2)];
+    write_wire(abuf, in);
+    // Integers cannot be converted with an offset.
+    std::byte ibuf[wire_size<std::int32_t>];
+    write_wire(ibuf, quantity<kelvin, std::int32_t>::from_value(300));
+    BOOST_CHECK_THROW((read_wire<celsius, std::int32_t>(ibuf, temperature_table())), wire_error);
+    BOOST_CHECK_THROW((read_wire<celsius, std::int32_t>(ibuf, registry)), wire_error);
+
+    converted_column<kelvin, double> out = read_wire_array<kelvin>(abuf, temperature_table());
+    BOOST_TEST(!out.is_identity());
+    BOOST_TEST(out.offset() == 273.15, boost::test_tools::tolerance(1e-12));
+    BOOST_TEST(out[1].value() == 373.15, boost::test_tools::tolerance(1e-12));
+    quantity<kelvin> values[2];
+    out.read(0, values);
+    BOOST_TEST(values[0].value() == 273.15, boost::test_tools::tolerance(1e-12));
+}